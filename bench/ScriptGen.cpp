@@ -0,0 +1,160 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "ScriptGen.hpp"
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+namespace {
+    /*
+     * splitmix64. The standard distributions aren't specified exactly, so they
+     * could give a different corpus on another standard library.
+     */
+    class Rng {
+        std::uint64_t state;
+
+    public:
+        explicit Rng(const std::uint64_t seed) : state(seed) {}
+
+        auto next() -> std::uint64_t {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * @brief a number in [lo, hi]
+         */
+        auto between(const unsigned lo, const unsigned hi) -> unsigned {
+            return lo + static_cast<unsigned>(next() % (hi - lo + 1));
+        }
+    };
+
+    constexpr std::array<std::string_view, 32> words = {
+        "the", "a", "you", "I", "we", "it", "was", "is", "never", "always",
+        "quiet", "library", "train", "station", "letter", "morning", "evening", "rain",
+        "remember", "forgot", "wanted", "said", "walked", "waited", "for", "with",
+        "before", "after", "again", "really", "maybe", "home",
+    };
+
+    constexpr std::array<std::string_view, 4> speakers = {"e", "m", "s", "n"};
+    constexpr std::array<std::string_view, 4> sprites = {"eileen happy", "eileen sad", "mary", "sylvie smile"};
+    constexpr std::array<std::string_view, 3> positions = {"left", "right", "center"};
+
+    class Writer {
+        std::string &out;
+        Rng &rng;
+        const GenConfig &config;
+
+        template<typename... Args>
+        void line(const unsigned indent, std::format_string<Args...> fmt, Args&&... args) {
+            out.append(indent * 4, ' ');
+            std::format_to(std::back_inserter(out), fmt, std::forward<Args>(args)...);
+            out.push_back('\n');
+        }
+
+        auto sentence() -> std::string {
+            std::string text;
+            const auto n_words = rng.between(4, 16);
+            for (unsigned i = 0; i < n_words; ++i) {
+                if (i != 0) {
+                    text.push_back(' ');
+                }
+                text += words[rng.next() % words.size()];
+            }
+            text.push_back('.');
+            return text;
+        }
+
+        void dialogue(const unsigned indent) {
+            line(indent, "{} \"{}\"", speakers[rng.next() % speakers.size()], sentence());
+        }
+
+        void menu(const unsigned indent, const unsigned depth_left) {
+            line(indent, "menu:");
+            for (unsigned c = 0; c < config.menu_choices; ++c) {
+                line(indent + 1, "\"{}\":", sentence());
+                dialogue(indent + 2);
+                if (depth_left > 1) {
+                    menu(indent + 2, depth_left - 1);
+                } else {
+                    line(indent + 2, "$ points += {}", c + 1);
+                }
+            }
+        }
+
+        void atl_block(const unsigned indent) {
+            line(indent, "show {} at {}:", sprites[rng.next() % sprites.size()], positions[rng.next() % positions.size()]);
+            line(indent + 1, "xalign 0.{}", rng.between(1, 9));
+            line(indent + 1, "linear {}.0 xalign 0.{}", rng.between(1, 3), rng.between(1, 9));
+            line(indent + 1, "pause 0.{}", rng.between(1, 9));
+        }
+
+    public:
+        Writer(std::string &out, Rng &rng, const GenConfig &config) : out(out), rng(rng), config(config) {}
+
+        void header() {
+            for (unsigned d = 0; d < config.defines; ++d) {
+                line(0, "define gen_const_{} = {}", d, rng.between(0, 1000));
+                line(0, "default gen_var_{} = {} + {} * 2", d, rng.between(0, 100), rng.between(0, 100));
+            }
+            line(0, "");
+        }
+
+        void label(const unsigned idx) {
+            line(0, "label gen_{}:", idx);
+            line(1, "scene bg room");
+            for (unsigned a = 0; a < config.atl_blocks; ++a) {
+                atl_block(1);
+            }
+            for (unsigned d = 0; d < config.dialogue_lines; ++d) {
+                dialogue(1);
+            }
+            if (config.menu_depth > 0) {
+                menu(1, config.menu_depth);
+            }
+            line(1, "if points > {}:", rng.between(0, 10));
+            dialogue(2);
+            line(1, "elif points == 0:");
+            dialogue(2);
+            line(1, "else:");
+            dialogue(2);
+            if (idx % 5 == 4) {
+                line(1, "call gen_{}", rng.between(0, config.labels - 1));
+            }
+            line(1, "jump gen_{}", (idx + 1) % config.labels);
+            line(0, "");
+        }
+    };
+}
+
+auto generate_script(const GenConfig &config) -> std::string {
+    std::string out;
+    Rng rng(config.seed);
+    Writer writer(out, rng, config);
+
+    writer.header();
+    for (unsigned l = 0; l < config.labels; ++l) {
+        writer.label(l);
+    }
+
+    return out;
+}
+
+auto config_for_size(GenConfig config, const std::size_t target_bytes) -> GenConfig {
+    // measure a sample, labels are all about the same size
+    GenConfig sample = config;
+    sample.labels = 16;
+    sample.defines = 0;
+    const auto per_label = std::max<std::size_t>(1, generate_script(sample).size() / sample.labels);
+
+    config.labels = static_cast<unsigned>(std::max<std::size_t>(1, target_bytes / per_label));
+    return config;
+}
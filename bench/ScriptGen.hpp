@@ -0,0 +1,35 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_SCRIPTGEN_HPP
+#define RPY_PROJ_ANALYZER_SCRIPTGEN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Shape of a synthetic script. The same config and seed always give the same script.
+ */
+struct GenConfig {
+    std::uint64_t seed = 1;
+    unsigned labels = 40;
+    unsigned dialogue_lines = 16; // per label
+    unsigned menu_depth = 2;      // nested menus per label, 0 for none
+    unsigned menu_choices = 3;
+    unsigned atl_blocks = 1;      // `show ... at left:` blocks per label
+    unsigned defines = 20;        // `define` and `default` statements each, at the top
+};
+
+/**
+ * @brief writes a script every statement of which the parser understands.
+ */
+auto generate_script(const GenConfig &config) -> std::string;
+
+/**
+ * @brief `config` with the number of labels scaled so the script comes out at roughly `target_bytes`.
+ */
+auto config_for_size(GenConfig config, std::size_t target_bytes) -> GenConfig;
+
+#endif //RPY_PROJ_ANALYZER_SCRIPTGEN_HPP
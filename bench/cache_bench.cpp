@@ -0,0 +1,119 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+/*
+ * Cold vs. warm startup with the on-disk parse cache.
+ *
+ * Generates a synthetic project (300 scripts by default), then times
+ *   cold:   lex + parse + lay out every script and write its cache entry,
+ *   warm:   map every cache entry instead,
+ *   edited: warm again after touching one script and editing another.
+ *
+ * usage: ./rpy_cache_bench [n_files]
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <print>
+#include <vector>
+
+#include "ParseCache.hpp"
+#include "ScriptGen.hpp"
+#include "ScriptLoader.hpp"
+
+namespace {
+    void write_script(const std::filesystem::path &path, const int file_idx) {
+        std::ofstream out(path);
+        out << generate_script({.seed=static_cast<std::uint64_t>(file_idx) + 1, .labels=4, .dialogue_lines=12, .defines=4});
+    }
+
+    auto time_ms(const std::function<void()> &fn) -> double {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
+auto main(const int argc, char **argv) -> int {
+    const int n_files = argc > 1 ? std::atoi(argv[1]) : 300;
+    if (n_files <= 0) {
+        std::println(std::cerr, "usage: {} [n_files]", argv[0]);
+        return 1;
+    }
+
+    const auto root = std::filesystem::temp_directory_path() / "rpy_cache_bench";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "game");
+    ParseCache::set_cache_dir(root / "cache");
+
+    std::vector<std::filesystem::path> scripts;
+    for (int i = 0; i < n_files; ++i) {
+        scripts.push_back(root / "game" / std::format("script_{:03}.rpy", i));
+        write_script(scripts.back(), i);
+    }
+
+    // the parser logs every script to stdout, keep that out of the timings
+    std::fflush(stdout);
+    if (std::freopen("/dev/null", "w", stdout) == nullptr) {
+        std::println(std::cerr, "warning: could not silence stdout, timings include logging");
+    }
+
+    const double cold = time_ms([&] {
+        for (const auto &path : scripts) {
+            const auto stamp = FileStamp::of(path);
+            const RenpyFile file(Graph{path});
+            if (auto stored = ParseCache::store(path, stamp, file); !stored) {
+                std::println(std::cerr, "{}", stored.error());
+            }
+        }
+    });
+
+    auto warm_run = [&](int &misses) -> double {
+        misses = 0;
+        return time_ms([&] {
+            for (const auto &path : scripts) {
+                if (auto loaded = ParseCache::load(path); !loaded) {
+                    misses++;
+                    const auto stamp = FileStamp::of(path);
+                    const RenpyFile file(Graph{path});
+                    (void)ParseCache::store(path, stamp, file);
+                }
+            }
+        });
+    };
+
+    int warm_misses = 0;
+    const double warm = warm_run(warm_misses);
+
+    // same contents with a new mtime should still hit, an edit must miss
+    std::filesystem::last_write_time(scripts.front(), std::filesystem::file_time_type::clock::now());
+    {
+        std::ofstream out(scripts.back(), std::ios::app);
+        std::println(out, "label appended:");
+        std::println(out, "    e \"One more line.\"");
+    }
+    int edited_misses = 0;
+    const double edited = warm_run(edited_misses);
+
+    std::uintmax_t cache_bytes = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(root / "cache")) {
+        cache_bytes += entry.file_size();
+    }
+
+    std::println(std::cerr, "{} scripts, {:.1f} KiB of cache", n_files, static_cast<double>(cache_bytes) / 1024.0);
+    std::println(std::cerr, "cold:   {:9.2f} ms", cold);
+    std::println(std::cerr, "warm:   {:9.2f} ms ({} misses), {:.1f}x faster", warm, warm_misses, cold / warm);
+    std::println(std::cerr, "edited: {:9.2f} ms ({} misses, expected 1)", edited, edited_misses);
+
+    std::filesystem::remove_all(root);
+    return edited_misses == 1 && warm_misses == 0 ? 0 : 1;
+}
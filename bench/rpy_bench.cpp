@@ -0,0 +1,448 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+/*
+ * Micro and macro benchmarks for the parsing and layout pipeline.
+ *
+ * Runs each stage on a small generated script and on a large one (4 MB by
+ * default):
+ *   tokenize       Lexer::from_source
+ *   generate_nodes Graph from tokens, without links
+ *   link           Graph::link (connect_ancestors + connect_nexts)
+ *   layout         GraphLayout
+ *   displayables   GraphLayout::make_displayables, the boxes and edges
+ *   display_nodes  a DisplayNode for every node, as if all were scrolled into view (needs a window for fonts)
+ *   frame          a steady-state ViewScreen::update and draw on the script, 1280x720
+ *   pipeline       all of the above but the displayables, for the large script
+ *
+ * Every benchmark repeats until it has run for --min-ms and at least 5 times.
+ * Heap allocations per run are counted too, to catch new ones in hot loops.
+ * --out writes the results as CSV. --baseline compares against such a file
+ * and exits with 1 if any median got slower by more than --tolerance.
+ * --check-allocs exits with 1 if a frame allocated at all, which the viewer's
+ * NoAllocGuards promise, or with 77 (skipped) when no window could be opened.
+ *
+ * usage: ./rpy_bench [--size-mb N] [--seed N] [--min-ms N] [--no-display]
+ *                    [--out results.csv] [--baseline results.csv] [--tolerance 0.15]
+ *                    [--check-allocs] [--dump file.rpy]
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <print>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "raylib-cpp.hpp"
+
+#include "AllocCounter.hpp"
+#include "App.hpp"
+#include "DisplayCache.hpp"
+#include "DisplayNode.hpp"
+#include "Graph.hpp"
+#include "GraphLayout.hpp"
+#include "Lexer.hpp"
+#include "Log.hpp"
+#include "ParseCache.hpp"
+#include "Screen.hpp"
+#include "ScriptGen.hpp"
+#include "TextHelper.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // results are added here so the compiler can't drop the work that produced them
+    volatile std::size_t sink = 0;
+
+    // what ctest takes as a skipped test
+    constexpr int exit_skipped = 77;
+
+    constexpr float frame_width = 1280.0f;
+    constexpr float frame_height = 720.0f;
+
+    struct Options {
+        double size_mb = 4.0;
+        std::uint64_t seed = 1;
+        double min_ms = 500.0;
+        bool display = true;
+        std::optional<std::filesystem::path> out;
+        std::optional<std::filesystem::path> baseline;
+        double tolerance = 0.15;
+        std::optional<std::filesystem::path> dump;
+        bool check_allocs = false;
+    };
+
+    struct Result {
+        std::string name;
+        std::size_t bytes = 0;
+        std::size_t iters = 0;
+        double min_ms = 0.0;
+        double median_ms = 0.0;
+        double mean_ms = 0.0;
+        std::size_t allocs = 0; // per iteration
+        std::size_t total_allocs = 0;
+    };
+
+    template<typename T>
+    auto parse_num(const std::string_view str, T &value) -> bool {
+        const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+        return ec == std::errc{} && ptr == str.data() + str.size();
+    }
+
+    auto parse_args(const int argc, char **argv) -> std::optional<Options> {
+        Options opts;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const bool has_value = i + 1 < argc;
+            const std::string_view value = has_value ? argv[i + 1] : "";
+
+            bool ok = true;
+            if (arg == "--no-display") {
+                opts.display = false;
+                continue;
+            }
+            if (arg == "--check-allocs") {
+                opts.check_allocs = true;
+                continue;
+            }
+            if (!has_value) {
+                ok = false;
+            } else if (arg == "--size-mb") {
+                ok = parse_num(value, opts.size_mb) && opts.size_mb > 0.0;
+            } else if (arg == "--seed") {
+                ok = parse_num(value, opts.seed);
+            } else if (arg == "--min-ms") {
+                ok = parse_num(value, opts.min_ms);
+            } else if (arg == "--tolerance") {
+                ok = parse_num(value, opts.tolerance) && opts.tolerance >= 0.0;
+            } else if (arg == "--out") {
+                opts.out = value;
+            } else if (arg == "--baseline") {
+                opts.baseline = value;
+            } else if (arg == "--dump") {
+                opts.dump = value;
+            } else {
+                ok = false;
+            }
+
+            if (!ok) {
+                std::println(std::cerr, "bad argument: {} {}", arg, value);
+                return std::nullopt;
+            }
+            ++i;
+        }
+        return opts;
+    }
+
+    /**
+     * @brief times `body(setup())` until it has run for `min_ms`. Only `body` is timed.
+     */
+    template<typename Setup, typename Body>
+    auto measure(std::string name, const std::size_t bytes, const double min_ms, Setup &&setup, Body &&body) -> Result {
+        constexpr std::size_t min_iters = 5;
+        constexpr std::size_t max_iters = 10'000;
+
+        std::vector<double> times;
+        double total = 0.0;
+        std::size_t allocs = 0;
+        while ((times.size() < min_iters || total < min_ms) && times.size() < max_iters) {
+            auto state = setup();
+            const auto allocs_before = thread_alloc_stats();
+            const auto start = Clock::now();
+            body(state);
+            const auto end = Clock::now();
+            allocs += (thread_alloc_stats() - allocs_before).count;
+            times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            total += times.back();
+        }
+
+        std::ranges::sort(times);
+        Result result{
+            .name=std::move(name),
+            .bytes=bytes,
+            .iters=times.size(),
+            .min_ms=times.front(),
+            .median_ms=times[times.size() / 2],
+            .mean_ms=total / static_cast<double>(times.size()),
+            .allocs=allocs / times.size(),
+            .total_allocs=allocs,
+        };
+
+        const double mb_per_s = static_cast<double>(bytes) / (1024.0 * 1024.0) / (result.median_ms / 1000.0);
+        std::println("{:<28} {:>6} {:>11.3f} {:>11.3f} {:>11.3f} {:>10.1f} {:>10}",
+            result.name, result.iters, result.min_ms, result.median_ms, result.mean_ms, mb_per_s, result.allocs);
+        return result;
+    }
+
+    auto no_setup() -> int {
+        return 0;
+    }
+
+    /**
+     * @brief times ViewScreen's own update and draw on `source`, once it is loaded, indexed and on screen.
+     *
+     * The script goes through a temporary folder and parse cache, like a script opened in the viewer.
+     * Its NoAllocGuards apply, so a build with RPY_ALLOC_GUARD stops right at an allocation.
+     */
+    auto measure_frame(std::string name, const std::string &source, const double min_ms, const raylib::Window &win)
+        -> std::optional<Result> {
+        const auto dir = std::filesystem::temp_directory_path() / "rpy_bench_frame";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir / "game");
+        ParseCache::set_cache_dir(dir / "cache");
+        const auto script = dir / "game" / "frame.rpy";
+        std::ofstream(script) << source;
+
+        const RenderTexture2D target = LoadRenderTexture(win.GetWidth(), win.GetHeight());
+        std::optional<Result> result;
+        {
+            ViewScreen screen(script, win, false);
+            State state;
+            auto frame = [&] -> void {
+                screen.update(win, state);
+                BeginTextureMode(target);
+                ClearBackground(raylib::Color::RayWhite());
+                screen.draw(win);
+                TextHelper::flush_text();
+                EndTextureMode();
+            };
+
+            // loading and indexing happen on other threads, the frames only pick them up
+            const auto deadline = Clock::now() + std::chrono::seconds(60);
+            while (!screen.settled() && Clock::now() < deadline) {
+                frame();
+            }
+            if (screen.settled()) {
+                frame(); // builds the nodes in view, their text and glyphs
+                result = measure(std::move(name), source.size(), min_ms, no_setup, [&](int) {
+                    frame();
+                });
+            } else {
+                std::println(std::cerr, "warning: {} never finished loading, not timing its frames", script.string());
+            }
+        }
+
+        UnloadRenderTexture(target);
+        std::filesystem::remove_all(dir);
+        return result;
+    }
+
+    void run_stages(std::vector<Result> &results, const std::string_view tag, const std::string &source,
+                    const Options &opts, const raylib::Window *win) {
+        const auto bytes = source.size();
+        const auto name = [&](const std::string_view stage) -> std::string {
+            return std::format("{}/{}", stage, tag);
+        };
+
+        results.push_back(measure(name("tokenize"), bytes, opts.min_ms, no_setup, [&](int) {
+            sink = sink + Lexer::from_source(source).get_tokens().size();
+        }));
+
+        const auto tokens = Lexer::from_source(source).get_tokens();
+        results.push_back(measure(name("generate_nodes"), bytes, opts.min_ms,
+            [&] -> std::vector<Token> { return tokens; },
+            [&](std::vector<Token> &toks) {
+                const Graph graph(std::move(toks), false);
+                sink = sink + graph.get_nodes().size();
+            }));
+
+        results.push_back(measure(name("link"), bytes, opts.min_ms,
+            [&] -> Graph { return Graph(tokens, false); },
+            [&](const Graph &graph) {
+                graph.link();
+            }));
+
+        Graph graph(tokens);
+        if (const auto &errors = graph.get_errors(); !errors.empty()) {
+            std::println(std::cerr, "warning: generated script has {} parse errors, first: {}", errors.size(), errors.front());
+        }
+
+        results.push_back(measure(name("layout"), bytes, opts.min_ms, no_setup, [&](int) {
+            const GraphLayout layout(graph);
+            sink = sink + layout.snapshot().size();
+        }));
+
+        if (win != nullptr) {
+            GraphLayout layout(graph);
+            results.push_back(measure(name("displayables"), bytes, opts.min_ms, no_setup, [&](int) {
+                const auto data = layout.make_displayables(graph);
+                sink = sink + data.geoms.size();
+            }));
+
+            const auto data = layout.make_displayables(graph);
+            results.push_back(measure(name("display_nodes"), bytes, opts.min_ms, no_setup, [&](int) {
+                DisplayCache displays(data.geoms.size());
+                displays.next_frame();
+                for (unsigned i = 0; i < data.geoms.size(); ++i) {
+                    sink = sink + displays.get(data.geoms, i).resident_bytes();
+                }
+            }));
+
+            if (auto frame = measure_frame(name("frame"), source, opts.min_ms, *win)) {
+                results.push_back(std::move(*frame));
+            }
+        }
+    }
+
+    void write_results(const std::filesystem::path &path, const std::vector<Result> &results) {
+        std::ofstream out(path);
+        std::println(out, "name,bytes,iters,min_ms,median_ms,mean_ms,allocs");
+        for (const auto &r : results) {
+            std::println(out, "{},{},{},{:.4f},{:.4f},{:.4f},{}",
+                r.name, r.bytes, r.iters, r.min_ms, r.median_ms, r.mean_ms, r.allocs);
+        }
+    }
+
+    /**
+     * @brief median times by benchmark name, from a file written by `write_results`.
+     */
+    auto read_baseline(const std::filesystem::path &path) -> std::unordered_map<std::string, double> {
+        std::unordered_map<std::string, double> medians;
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line); // header
+        while (std::getline(in, line)) {
+            std::vector<std::string> fields;
+            std::stringstream ss(line);
+            for (std::string field; std::getline(ss, field, ',');) {
+                fields.push_back(field);
+            }
+            double median = 0.0;
+            // older files have no allocs column
+            if (fields.size() >= 6 && parse_num(std::string_view(fields[4]), median)) {
+                medians[fields[0]] = median;
+            }
+        }
+        return medians;
+    }
+
+    /**
+     * @brief hidden window the size of a frame, so fonts can be loaded for the displayable benchmarks.
+     */
+    auto open_window(raylib::Window &win) -> bool {
+        SetTraceLogLevel(LOG_WARNING);
+        try {
+            win.Init(static_cast<int>(frame_width), static_cast<int>(frame_height), "rpy_bench", FLAG_WINDOW_HIDDEN);
+        } catch (const raylib::RaylibException&) {
+            return false;
+        }
+
+        DisplayNode::default_color = raylib::Color(0xE2, 0xE2, 0xE2);
+        DisplayNode::line_color = raylib::Color::Black();
+        TextHelper::default_color = std::make_unique<raylib::Color>(raylib::Color::Black());
+        TextHelper::load_fonts();
+        return true;
+    }
+}
+
+auto main(const int argc, char **argv) -> int {
+    const auto opts = parse_args(argc, argv);
+    if (!opts) {
+        std::println(std::cerr, "usage: {} [--size-mb N] [--seed N] [--min-ms N] [--no-display] "
+            "[--out results.csv] [--baseline results.csv] [--tolerance 0.15] [--check-allocs] [--dump file.rpy]", argv[0]);
+        return 1;
+    }
+
+    // the parser reports every script it parses, keep that out of the timings
+    Log::set_quiet(true);
+
+#ifndef NDEBUG
+    std::println(std::cerr, "warning: built without NDEBUG, make_displayables runs its overlap check");
+#endif //NDEBUG
+
+    GenConfig config;
+    config.seed = opts->seed;
+    const auto small = generate_script(config);
+    const auto large = generate_script(config_for_size(config, static_cast<std::size_t>(opts->size_mb * 1024 * 1024)));
+
+    if (opts->dump) {
+        std::ofstream(*opts->dump) << large;
+    }
+
+    raylib::Window win;
+    const bool display = opts->display && open_window(win);
+
+    const auto tag_for = [](const std::string &source) -> std::string {
+        return source.size() >= 1024 * 1024
+            ? std::format("{:.1f}MB", static_cast<double>(source.size()) / (1024.0 * 1024.0))
+            : std::format("{}KB", source.size() / 1024);
+    };
+
+    std::println("{:<28} {:>6} {:>11} {:>11} {:>11} {:>10} {:>10}",
+        "benchmark", "iters", "min ms", "median ms", "mean ms", "MB/s", "allocs");
+
+    std::vector<Result> results;
+    run_stages(results, tag_for(small), small, *opts, display ? &win : nullptr);
+    run_stages(results, tag_for(large), large, *opts, display ? &win : nullptr);
+
+    results.push_back(measure(std::format("pipeline/{}", tag_for(large)), large.size(), opts->min_ms, no_setup, [&](int) {
+        auto lexer = Lexer::from_source(large);
+        Graph graph(std::move(lexer.get_tokens()));
+        const GraphLayout layout(graph);
+        sink = sink + graph.get_nodes().size();
+    }));
+
+    if (display) {
+        TextHelper::unload_fonts();
+        win.Close();
+    }
+
+    if (opts->out) {
+        write_results(*opts->out, results);
+    }
+
+    bool regressed = false;
+    if (opts->check_allocs) {
+        if (!display) {
+            std::println(std::cerr, "--check-allocs needs a window for fonts, skipping the check");
+            return exit_skipped;
+        }
+        std::size_t frames = 0;
+        for (const auto &r : results) {
+            if (!r.name.starts_with("frame/")) {
+                continue;
+            }
+            frames++;
+            if (r.total_allocs > 0) {
+                std::println(std::cerr, "ALLOCATION {}: {} allocations in {} steady-state frames",
+                    r.name, r.total_allocs, r.iters);
+                regressed = true;
+            }
+        }
+        if (frames == 0) {
+            std::println(std::cerr, "--check-allocs: no frame was timed");
+            regressed = true;
+        }
+    }
+
+    if (!opts->baseline) {
+        return regressed ? 1 : 0;
+    }
+
+    const auto baseline = read_baseline(*opts->baseline);
+    for (const auto &r : results) {
+        const auto base = baseline.find(r.name);
+        if (base == baseline.end()) {
+            continue;
+        }
+        if (const double change = (r.median_ms / base->second) - 1.0; change > opts->tolerance) {
+            std::println(std::cerr, "REGRESSION {}: median {:.3f} ms vs {:.3f} ms (+{:.0f}%)",
+                r.name, r.median_ms, base->second, change * 100.0);
+            regressed = true;
+        }
+    }
+    return regressed ? 1 : 0;
+}
@@ -9,6 +9,7 @@
 #include <utility>
 
 #include "Lexer.hpp"
+#include "Log.hpp"
 
 auto ATL::make_inline_interp(Lexer& lexer, std::optional<Warper> warper)
     -> std::expected<std::pair<std::vector<ATLProperty>, std::vector<std::unique_ptr<Expr>>>, std::string> {
@@ -102,7 +103,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 if (auto expr = try_get_expr(lexer)) {
                     statements.emplace_back(ATLProperty{.prop=t.type, .value=std::move(*expr)});
                 } else {
-                    std::println(std::cerr, "{}", expr.error());
+                    Log::error("{}", expr.error());
                 }
             },
             [&](const TokFloatLit& t) {
@@ -118,7 +119,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 if (auto expr = try_get_expr(lexer)) {
                     statements.emplace_back(ATLNumber{std::move(*expr)});
                 } else {
-                    std::println(std::cerr, "{}", expr.error());
+                    Log::error("{}", expr.error());
                     return;
                 }
             },
@@ -128,7 +129,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 if (auto e = try_get_expr(lexer)) {
                     expr = std::move(*e);
                 } else {
-                    std::println(std::cerr, "{}", e.error());
+                    Log::error("{}", e.error());
                     return;
                 }
 
@@ -141,7 +142,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                             .knots = std::move(props_knots->second),
                         });
                     } else {
-                        std::println(std::cerr, "{}", props_knots.error());
+                        Log::error("{}", props_knots.error());
                     }
                 } else if (lexer.curr_is<TokATLProperty>()) {
                     if (auto prop_block = make_interp_block(lexer, t.warper)) {
@@ -152,10 +153,10 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                             .knots = {}
                         });
                     } else {
-                        std::println(std::cerr, "{}", prop_block.error());
+                        Log::error("{}", prop_block.error());
                     }
                 } else {
-                    std::println(std::cerr, "invalid ATL Interpolation statement on line {}", t.line);
+                    Log::error("invalid ATL Interpolation statement on line {}", t.line);
                 }
             },
             [&](const TokATLWarp& t) {
@@ -164,7 +165,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 if (auto expr = try_get_expr(lexer)) {
                     warper_func = std::move(*expr);
                 } else {
-                    std::println(std::cerr, "{}", expr.error());
+                    Log::error("{}", expr.error());
                     return;
                 }
 
@@ -172,7 +173,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 if (auto e = try_get_expr(lexer)) {
                     expr = std::move(*e);
                 } else {
-                    std::println(std::cerr, "{}", e.error());
+                    Log::error("{}", e.error());
                     return;
                 }
 
@@ -184,7 +185,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                         .knots = std::move(props_knots->second),
                     });
                 } else {
-                    std::println(std::cerr, "{}", props_knots.error());
+                    Log::error("{}", props_knots.error());
                 }
             },
             [&](const TokPass& t) {
@@ -196,7 +197,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 if (auto expr = try_get_expr(lexer)) {
                     statements.emplace_back(ATLRepeat{std::move(*expr)});
                 } else {
-                    std::println(std::cerr, "{}", expr.error());
+                    Log::error("{}", expr.error());
                 }
             },
             [&](const TokATLBlock& t) {
@@ -217,7 +218,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                     if (lexer.curr_is<TokColon>()) {
                         ++lexer;
                     } else {
-                        std::println(std::cerr, "missing colon in choice statement at {}", tok_pos(t));
+                        Log::error("missing colon in choice statement at {}", tok_pos(t));
                         return;
                     }
                 }
@@ -229,7 +230,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 if (statements.empty()) {
                     statements.emplace_back(ATLAnimation{});
                 } else {
-                    std::println(std::cerr, "animation statement not first in ATL block at {}", tok_pos(t));
+                    Log::error("animation statement not first in ATL block at {}", tok_pos(t));
                 }
             },
             [&](const TokATLOn &t) {
@@ -243,7 +244,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                     } else if (auto event = lexer.expect<TokATLEvent>()) {
                         events.emplace_back(event->event);
                     } else if (lexer.expect<TokNewline>()) {
-                        std::println(std::cerr, "on statement missing colon in ATL block at {}", tok_pos(t));
+                        Log::error("on statement missing colon in ATL block at {}", tok_pos(t));
                     }
 
                     if (lexer.curr_is<TokComma>()) {
@@ -266,7 +267,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 } else if (auto expr = try_get_expr(lexer)) {
                     statements.emplace_back(ATLContainsInline{std::move(*expr)});
                 } else {
-                    std::println(std::cerr, "{}", lexer.multi_tok_error<TokColon>({"valid Expression"}));
+                    Log::error("{}", lexer.multi_tok_error<TokColon>({"valid Expression"}));
                 }
             },
             [&](const TokATLFunction) {
@@ -274,7 +275,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 if (auto expr = try_get_expr(lexer)) {
                     statements.emplace_back(ATLFunction{std::move(*expr)});
                 } else {
-                    std::println(std::cerr, "{}", expr.error());
+                    Log::error("{}", expr.error());
                 }
             },
             [&]<typename U>(U&& other) {
@@ -285,7 +286,7 @@ auto ATL::make_atl_block(Lexer& lexer, unsigned indent) -> std::vector<ATLStmt>
                 using To = std::decay_t<U>;
                 static_assert(std::is_base_of_v<Tok, To>, "expected derived from base Tok");
                 std::string msg = std::format("unexpected token {} at {}", tok_name<To>(), tok_pos(other));
-                std::println(std::cerr, "{}", msg);
+                Log::error("{}", msg);
             },
         }, token);
     }
@@ -432,7 +433,7 @@ auto ATL::get_trans(const std::string_view& str) -> Transition {
     if (str == "irisout") {
         return Transition::IrisOut;
     }
-    std::println(std::cerr, "invalid transition type");
+    Log::error("invalid transition type");
     std::unreachable();
 }
 
@@ -581,7 +582,7 @@ auto ATL::get_prop(const std::string_view& str) -> TFProp {
     if (str == "show_cancels_hide") {
         return TFProp::Show_Cancels_Hide;
     }
-    std::println(std::cerr, "unknown property type");
+    Log::error("unknown property type");
     std::unreachable();
 }
 
@@ -602,7 +603,7 @@ auto ATL::get_warper(const std::string_view& str) -> Warper {
         return Warper::EaseOut;
     }
 
-    std::println(std::cerr, "invalid warper type");
+    Log::error("invalid warper type");
     std::unreachable();
 }
 
@@ -758,7 +759,7 @@ auto ATL::trans_str(const Transition& trans) -> std::string {
         case IrisOut:
             return "irisout";
     }
-    std::println(std::cerr, "invalid transition type");
+    Log::error("invalid transition type");
     std::unreachable();
 }
 
@@ -776,7 +777,7 @@ auto ATL::warper_str(const Warper& warper) -> std::string {
         case EaseOut:
             return "easeout";
     }
-    std::println(std::cerr, "invalid warper type");
+    Log::error("invalid warper type");
     std::unreachable();
 }
 
@@ -880,7 +881,7 @@ auto ATL::prop_str(const TFProp& type) -> std::string {
         case Show_Cancels_Hide:
             return "show_cancels_hide";
     }
-    std::println(std::cerr, "invalid transformation property");
+    Log::error("invalid transformation property");
     std::unreachable();
 }
 
@@ -910,6 +911,6 @@ auto ATL::event_str(const Event &event) -> std::string {
         case SelectedInsensitive:
             return "selected_insensitive";
     }
-    std::println(std::cerr, "invalid event name");
+    Log::error("invalid event name");
     std::unreachable();
 }
@@ -0,0 +1,54 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "AllocCounter.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    // plain integers, so these work even while a thread is starting up or exiting
+    thread_local std::size_t alloc_bytes = 0;
+    thread_local std::size_t alloc_count = 0;
+    thread_local const char *no_alloc_where = nullptr;
+
+    void check_allowed([[maybe_unused]] const std::size_t size) {
+#ifdef RPY_ALLOC_GUARD
+        if (no_alloc_where == nullptr) {
+            return;
+        }
+        // no std::print here, it could allocate and end up back in here
+        std::fprintf(stderr, "allocation of %zu bytes inside NoAllocGuard \"%s\"\n", size, no_alloc_where);
+        std::abort();
+#endif //RPY_ALLOC_GUARD
+    }
+}
+
+void record_alloc(const std::size_t size) {
+    check_allowed(size);
+    alloc_bytes += size;
+    ++alloc_count;
+}
+
+auto thread_alloc_stats() -> AllocStats {
+    return {.bytes=alloc_bytes, .count=alloc_count};
+}
+
+NoAllocGuard::NoAllocGuard(const char *where, const bool active) : prev(no_alloc_where) {
+    if (active) {
+        no_alloc_where = where;
+    }
+}
+
+NoAllocGuard::~NoAllocGuard() {
+    no_alloc_where = prev;
+}
+
+NoAllocGuard::Allow::Allow() : prev(no_alloc_where) {
+    no_alloc_where = nullptr;
+}
+
+NoAllocGuard::Allow::~Allow() {
+    no_alloc_where = prev;
+}
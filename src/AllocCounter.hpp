@@ -0,0 +1,65 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_ALLOCCOUNTER_HPP
+#define RPY_PROJ_ANALYZER_ALLOCCOUNTER_HPP
+
+#include <cstddef>
+
+/**
+ * @brief Heap allocations made through operator new on the calling thread so far.
+ *
+ * Counted by the replacement operator new in AllocHooks.cpp, which is only
+ * linked into rpy_bench and builds configured with -DRPY_COUNT_ALLOCS=ON or
+ * -DRPY_ALLOC_GUARD=ON. Everywhere else these stay at zero.
+ * Only allocations are counted, not frees, so the difference between two
+ * readings is what the code in between allocated.
+ */
+struct AllocStats {
+    std::size_t bytes = 0;
+    std::size_t count = 0;
+
+    auto operator-(const AllocStats &other) const -> AllocStats {
+        return {.bytes=bytes - other.bytes, .count=count - other.count};
+    }
+};
+
+[[nodiscard]] auto thread_alloc_stats() -> AllocStats;
+
+/**
+ * @brief counts an allocation of `size` bytes on the calling thread, and checks it against the NoAllocGuard in effect.
+ */
+void record_alloc(std::size_t size);
+
+/**
+ * @brief Asserts that the calling thread makes no heap allocations while it is alive.
+ *
+ * Only checked in builds configured with -DRPY_ALLOC_GUARD=ON, where an
+ * allocation inside the scope prints `where` and aborts, so a debugger stops
+ * right at the allocating call. Otherwise it does nothing.
+ */
+class NoAllocGuard {
+    const char *prev;
+
+public:
+    explicit NoAllocGuard(const char *where, bool active = true);
+    NoAllocGuard(const NoAllocGuard&) = delete;
+    auto operator=(const NoAllocGuard&) -> NoAllocGuard& = delete;
+    ~NoAllocGuard();
+
+    /**
+     * @brief lifts an enclosing NoAllocGuard, for code that is allowed to allocate.
+     */
+    class Allow {
+        const char *prev;
+
+    public:
+        Allow();
+        Allow(const Allow&) = delete;
+        auto operator=(const Allow&) -> Allow& = delete;
+        ~Allow();
+    };
+};
+
+#endif //RPY_PROJ_ANALYZER_ALLOCCOUNTER_HPP
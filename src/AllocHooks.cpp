@@ -0,0 +1,119 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+/*
+ * Replaces the global operator new / delete to count every allocation for
+ * AllocCounter.hpp. Only linked into rpy_bench, and into the other binaries
+ * when configured with -DRPY_COUNT_ALLOCS=ON or -DRPY_ALLOC_GUARD=ON.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "AllocCounter.hpp"
+
+namespace {
+    auto counted_alloc(std::size_t size) -> void* {
+        if (size == 0) {
+            size = 1;
+        }
+        record_alloc(size);
+        return std::malloc(size);
+    }
+
+    auto counted_aligned_alloc(std::size_t size, const std::align_val_t align) -> void* {
+        const auto alignment = static_cast<std::size_t>(align);
+        // aligned_alloc wants the size to be a multiple of the alignment
+        size = ((size == 0 ? 1 : size) + alignment - 1) / alignment * alignment;
+        record_alloc(size);
+        return std::aligned_alloc(alignment, size);
+    }
+
+    auto or_throw(void *ptr) -> void* {
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+}
+
+auto operator new(const std::size_t size) -> void* {
+    return or_throw(counted_alloc(size));
+}
+
+auto operator new[](const std::size_t size) -> void* {
+    return or_throw(counted_alloc(size));
+}
+
+auto operator new(const std::size_t size, const std::nothrow_t&) noexcept -> void* {
+    return counted_alloc(size);
+}
+
+auto operator new[](const std::size_t size, const std::nothrow_t&) noexcept -> void* {
+    return counted_alloc(size);
+}
+
+auto operator new(const std::size_t size, const std::align_val_t align) -> void* {
+    return or_throw(counted_aligned_alloc(size, align));
+}
+
+auto operator new[](const std::size_t size, const std::align_val_t align) -> void* {
+    return or_throw(counted_aligned_alloc(size, align));
+}
+
+auto operator new(const std::size_t size, const std::align_val_t align, const std::nothrow_t&) noexcept -> void* {
+    return counted_aligned_alloc(size, align);
+}
+
+auto operator new[](const std::size_t size, const std::align_val_t align, const std::nothrow_t&) noexcept -> void* {
+    return counted_aligned_alloc(size, align);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
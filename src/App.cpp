@@ -5,16 +5,41 @@
 #include "App.hpp"
 
 #include <format>
+#include <fstream>
+#include <iostream>
 #include <print>
 #include <raylib.h>
 
 #include "raylib-cpp.hpp"
 
 #include "ArgVParser.hpp"
+#include "Cli.hpp"
+#include "Export.hpp"
+#include "GraphExport.hpp"
+#include "Log.hpp"
 #include "Panel.hpp"
+#include "ParseCache.hpp"
+#include "Profiler.hpp"
 #include "Screen.hpp"
 
+namespace {
+    /**
+     * @brief sets the node and text colours for light or dark mode.
+     * @return the background colour to go with them.
+     */
+    auto set_colors() -> raylib::Color {
+        DisplayNode::default_color = ArgVParser::dark_mode() ? raylib::Color(0x14, 0x18, 0x1F) : raylib::Color(0xE2, 0xE2, 0xE2);
+        DisplayNode::line_color = ArgVParser::dark_mode() ? raylib::Color::White() : raylib::Color::Black();
+        TextHelper::default_color = std::make_unique<raylib::Color>(
+            ArgVParser::dark_mode() ? raylib::Color::White() : raylib::Color::Black());
+        return ArgVParser::dark_mode() ? raylib::Color(0x26, 0x2C, 0x36) : raylib::Color::RayWhite();
+    }
+}
+
 auto App::run() -> int {
+    // cheap enough to always keep totals for the debug overlay
+    Cli::start_profiler(true);
+
     const int screen_width = ArgVParser::width ? *ArgVParser::width : 1280;
     const int screen_height = ArgVParser::height ? *ArgVParser::height : 720;
     const auto f_width = static_cast<float>(screen_width);
@@ -27,16 +52,12 @@ auto App::run() -> int {
 
     BeginTextureMode(bg_tex);
     {
-        const auto col = ArgVParser::dark_mode() ? raylib::Color(0x26, 0x2C, 0x36) : raylib::Color::RayWhite();
+        const auto col = set_colors();
         ClearBackground(col);
         raylib::Rectangle(0, 0, f_width, f_height).Draw(col);
     }
     EndTextureMode();
 
-    DisplayNode::default_color = ArgVParser::dark_mode() ? raylib::Color(0x14, 0x18, 0x1F) : raylib::Color(0xE2, 0xE2, 0xE2);
-    DisplayNode::line_color = ArgVParser::dark_mode() ? raylib::Color::White() : raylib::Color::Black();
-    TextHelper::default_color = std::make_unique<raylib::Color>(
-        ArgVParser::dark_mode() ? raylib::Color::White() : raylib::Color::Black());
     TextHelper::load_fonts();
     raylib::Image dir_img("./img/icons/directory.png");
     const auto new_color = ArgVParser::dark_mode() ? raylib::Color::White() : raylib::Color::Black();
@@ -59,8 +80,6 @@ auto App::run() -> int {
         bool bad_path = false;
         state.path_type = [&] -> State::PathType {
             if (std::filesystem::is_directory(*ArgVParser::path)) {
-                const auto proj = build_dir_tree(*ArgVParser::path);
-                const auto f = flat_files(proj);
                 return State::PathType::Directory;
             }
             if (std::filesystem::is_regular_file(*ArgVParser::path) && ArgVParser::path->extension() == ".rpy") {
@@ -103,6 +122,7 @@ auto App::run() -> int {
             window.ClearBackground(raylib::Color::RayWhite());
             DrawTexture(bg_tex.texture, 0, 0, raylib::Color::White());
             screen->draw(window);
+            TextHelper::flush_text(); // whatever the screen left queued
         }
         EndDrawing();
 
@@ -125,18 +145,86 @@ auto App::run() -> int {
     TextHelper::unload_fonts();
     FileTreePanel::unload_textures();
 
+    Cli::write_profile();
+
     return 0;
 }
 
-auto App::run_no_gui() -> int {
-    if (ArgVParser::path) {
-        Lexer lexer(*ArgVParser::path);
-        const auto tokens = lexer.tokenize();
-        lexer.print_tokens();
-        Graph graph(*ArgVParser::path);
-        return 0;
+auto App::run_export() -> int {
+    if (!ArgVParser::path || !std::filesystem::is_regular_file(*ArgVParser::path)) {
+        std::println(std::cerr, "--export needs a script to draw. Run with --help for options.");
+        return -1;
+    }
+    const auto &out_path = *ArgVParser::export_out;
+    const auto format = Export::format_of(out_path);
+    if (!format) {
+        std::println(std::cerr, "can't export to {}, it must end in .svg or .png", out_path.string());
+        return -1;
     }
 
-    std::println(std::cerr, "No file name given. Run with --help for options.");
-    return -1;
+    Log::set_quiet(!ArgVParser::verbose());
+    Cli::start_profiler(false);
+
+    const auto loaded = ParseCache::load_or_parse(*ArgVParser::path);
+    const auto data = loaded.file->layout.make_displayables(loaded.file->graph);
+
+    std::ofstream out(out_path, std::ios::binary);
+    if (!out) {
+        std::println(std::cerr, "could not open {} for writing", out_path.string());
+        return -1;
+    }
+
+    bool ok = false;
+    if (*format == Export::Format::SVG) {
+        set_colors();
+        ok = Export::write_svg(data, out);
+    } else {
+        // rendering needs a GL context, but nothing has to be shown
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        SetTraceLogLevel(ArgVParser::verbose() ? LOG_INFO : LOG_WARNING);
+        raylib::Window window(1, 1, "rpy_proj_analyzer");
+        const auto background = set_colors();
+        TextHelper::load_fonts();
+        ok = Export::write_png(data, out, background);
+        TextHelper::unload_fonts();
+    }
+
+    Cli::write_profile();
+
+    if (!ok) {
+        std::println(std::cerr, "could not write all of {}", out_path.string());
+        return 1;
+    }
+    return 0;
+}
+
+auto App::run_graph_export() -> int {
+    const auto &out_path = *ArgVParser::graph_out;
+    if (!ArgVParser::path || GraphExport::format_of(out_path) != GraphExport::Format::Binary) {
+        return Cli::run_graph_export();
+    }
+
+    // a GraphFile has the layout in it, which only this side can make
+    const auto &script = *ArgVParser::path;
+    if (!std::filesystem::is_regular_file(script)) {
+        std::println(std::cerr, "a .rpyg file holds one script, {} isn't one", script.string());
+        return -1;
+    }
+    std::ofstream out(out_path, std::ios::binary);
+    if (!out) {
+        std::println(std::cerr, "could not open {} for writing", out_path.string());
+        return -1;
+    }
+
+    Log::set_quiet(!ArgVParser::verbose());
+    Cli::start_profiler(false);
+    const auto loaded = ParseCache::load_or_parse(script);
+    const auto written = ParseCache::write(out, script, loaded.stamp, *loaded.file, true);
+    Cli::write_profile();
+
+    if (!written) {
+        std::println(std::cerr, "could not write all of {}: {}", out_path.string(), written.error());
+        return 1;
+    }
+    return 0;
 }
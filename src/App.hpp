@@ -53,7 +53,18 @@ public:
     }
 
     static auto run() -> int;
-    static auto run_no_gui() -> int;
+
+    /**
+     * @brief writes the graph of the given script to `--export`'s file, see Export.
+     */
+    static auto run_export() -> int;
+
+    /**
+     * @brief writes the flow graph of the script or project to `--graph`'s file.
+     *
+     * DOT and JSON go through Cli, .rpyg files are written here since they include the layout.
+     */
+    static auto run_graph_export() -> int;
 };
 
 #endif //RPY_PROJ_ANALYZER_APP_HPP
@@ -57,6 +57,28 @@ auto ArgVParser::parse(const int argc, char** argv) -> bool {
             bit_flags |= FLAG_DARK_MODE;
         } else if (arg == "--no-gui") {
             bit_flags |= FLAG_NO_GUI;
+        } else if (arg == "--lsp") {
+            bit_flags |= FLAG_LSP;
+        } else if (arg == "-v" || arg == "--verbose") {
+            bit_flags |= FLAG_VERBOSE;
+        } else if (arg == "--format") {
+            if (i + 1 < args.size() && (args.at(i + 1) == "ndjson" || args.at(i + 1) == "csv")) {
+                format = args.at(++i) == "csv" ? OutputFormat::CSV : OutputFormat::NDJSON;
+            } else {
+                std::println(std::cerr, "--format must be ndjson or csv");
+                parse_ok = false;
+            }
+        } else if (arg == "--profile" || arg == "--trace" || arg == "--export" || arg == "--graph") {
+            auto &out = arg == "--profile" ? profile_out
+                : arg == "--trace" ? trace_out
+                : arg == "--export" ? export_out
+                : graph_out;
+            if (i + 1 < args.size()) {
+                out = std::filesystem::path(args.at(++i));
+            } else {
+                std::println(std::cerr, "no file given for {}", arg);
+                parse_ok = false;
+            }
         } else if (arg == "-t" || arg == "--threads") {
             threads = parse_int(args, arg, i);
             parse_ok = threads.has_value();
@@ -66,6 +88,9 @@ auto ArgVParser::parse(const int argc, char** argv) -> bool {
         } else if (arg == "-h" || arg == "--height") {
             height = parse_int(args, arg, i);
             parse_ok = height.has_value();
+        } else if (arg == "--cache-mb") {
+            cache_mb = parse_int(args, arg, i);
+            parse_ok = cache_mb.has_value() && *cache_mb > 0;
         }
 
         ++i;
@@ -93,8 +118,45 @@ auto ArgVParser::get_help_msg() -> std::string {
     -d, --dark-mode
         use dark colors instead of the light defaults.
 
+    --cache-mb [megabytes]
+        keep up to N MB of parsed scripts in memory (default 256).
+
     --no-gui
-        runs the tool on a single script with no GUI.
+        parse the script, or every script in the directory, without opening a
+        window and print statistics for each file and the whole project to
+        stdout. exits with 1 if any script has syntax errors.
+
+    --format [ndjson | csv]
+        output format for --no-gui (default ndjson).
+
+    -v, --verbose
+        with --no-gui, --export or --graph, also print the parser's own messages and
+        errors to stderr.
+
+    --export [file.svg | file.png]
+        draw the script's graph to the file and exit. SVG needs no display,
+        PNG is rendered in a hidden window.
+
+    --graph [file.dot | file.json | file.rpyg]
+        write the flow graph of the script, or of every script in the
+        directory as one graph, to the file and exit: each node's kind, line,
+        label and word count, and the next / child / branch / jump edges
+        between them. .rpyg is the binary format of the parse cache, for a
+        single script.
+
+    --lsp
+        run as a language server over stdin / stdout, for editors: go to a
+        label's or character's definition, find references, list labels and
+        menus, and show parse errors as you type. the directory given, if any,
+        is the workspace when the editor doesn't name one.
+
+    --profile [file.json]
+        write the time and heap allocations spent in each loading phase, in
+        total and per script, to the file on exit.
+
+    --trace [file.json]
+        write every timed phase as a Chrome trace (chrome://tracing, Perfetto)
+        to the file on exit.
     )";
 }
 
@@ -109,3 +171,11 @@ auto ArgVParser::help() -> bool {
 auto ArgVParser::no_gui() -> bool {
     return (bit_flags & FLAG_NO_GUI) > 0;
 }
+
+auto ArgVParser::verbose() -> bool {
+    return (bit_flags & FLAG_VERBOSE) != 0;
+}
+
+auto ArgVParser::lsp() -> bool {
+    return (bit_flags & FLAG_LSP) != 0;
+}
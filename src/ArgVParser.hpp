@@ -5,6 +5,7 @@
 #ifndef RPY_PROJ_ANALYZER_ARGVPARSER_HPP
 #define RPY_PROJ_ANALYZER_ARGVPARSER_HPP
 
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
@@ -20,15 +21,28 @@ class ArgVParser {
     static constexpr unsigned FLAG_HELP      = 0b1;
     static constexpr unsigned FLAG_DARK_MODE = 0b10;
     static constexpr unsigned FLAG_NO_GUI    = 0b100;
+    static constexpr unsigned FLAG_VERBOSE   = 0b1000;
+    static constexpr unsigned FLAG_LSP       = 0b10000;
     static inline unsigned bit_flags = 0;
 
     static auto parse_int(const std::vector<std::string_view> &args, std::string_view arg, int &idx) -> std::optional<int>;
 
 public:
+    enum class OutputFormat : std::uint8_t {
+        NDJSON,
+        CSV,
+    };
+
     static inline std::optional<std::filesystem::path> path;
     static inline std::optional<int> threads;
     static inline std::optional<int> width;
     static inline std::optional<int> height;
+    static inline std::optional<int> cache_mb;
+    static inline OutputFormat format = OutputFormat::NDJSON;
+    static inline std::optional<std::filesystem::path> profile_out;
+    static inline std::optional<std::filesystem::path> trace_out;
+    static inline std::optional<std::filesystem::path> export_out;
+    static inline std::optional<std::filesystem::path> graph_out;
 
     static auto parse(int argc, char** argv) -> bool;
     static auto get_help_msg() -> std::string;
@@ -36,6 +50,8 @@ public:
     static auto dark_mode() -> bool;
     static auto help() -> bool;
     static auto no_gui() -> bool;
+    static auto verbose() -> bool;
+    static auto lsp() -> bool;
 };
 
 
@@ -0,0 +1,221 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "Batch.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <format>
+#include <future>
+#include <iostream>
+#include <optional>
+#include <print>
+#include <typeinfo>
+
+#include "DirTree.hpp"
+#include "Json.hpp"
+#include "Node.hpp"
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+    template<typename... Ts>
+    struct NodeKinds {
+        static constexpr std::size_t size = sizeof...(Ts);
+
+        // every node class is final, so comparing type_info is an exact match
+        static auto index(const Node &node) -> std::optional<std::size_t> {
+            std::size_t i = 0;
+            std::optional<std::size_t> found;
+            static_cast<void>(((typeid(node) == typeid(Ts) ? (found = i, true) : (++i, false)) || ...));
+            return found;
+        }
+    };
+
+    // same order as Batch::kind_names
+    using Kinds = NodeKinds<
+        NodeLabel, NodeMenu, NodeChoice, NodeDialogue, NodeIf, NodeElif, NodeElse, NodeWhile,
+        NodeCall, NodeJump, NodeReturn, NodePass, NodeShow, NodeScene, NodeHide, NodeWith,
+        NodePlay, NodeImage, NodeExpr>;
+    static_assert(Kinds::size == Batch::kind_names.size());
+
+    constexpr auto kind_idx(const std::string_view name) -> std::size_t {
+        return static_cast<std::size_t>(std::ranges::find(Batch::kind_names, name) - Batch::kind_names.begin());
+    }
+
+    void write_json_stats(std::ostream &out, const Batch::Stats &stats) {
+        std::print(out, R"("tokens":{},"nodes":{},"words":{},"branches":{},"errors":{},"kinds":{{)",
+            stats.tokens, stats.nodes, stats.words, stats.branches, stats.errors);
+        for (std::size_t i = 0; i < Batch::kind_names.size(); ++i) {
+            std::print(out, R"({}"{}":{})", i == 0 ? "" : ",", Batch::kind_names[i], stats.kinds[i]);
+        }
+        out << '}';
+    }
+
+    void write_csv_field(std::ostream &out, const std::string_view str) {
+        if (str.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out << str;
+            return;
+        }
+        out << '"';
+        for (const char c : str) {
+            if (c == '"') {
+                out << '"';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+
+    void write_csv_stats(std::ostream &out, const Batch::Stats &stats) {
+        std::print(out, ",{},{},{},{},{}", stats.tokens, stats.nodes, stats.words, stats.branches, stats.errors);
+        for (const auto n : stats.kinds) {
+            std::print(out, ",{}", n);
+        }
+        out << '\n';
+    }
+
+    void write_header(std::ostream &out, const ArgVParser::OutputFormat format) {
+        if (format != ArgVParser::OutputFormat::CSV) {
+            return;
+        }
+        out << "path,tokens,nodes,words,branches,errors";
+        for (const auto name : Batch::kind_names) {
+            out << ',' << name;
+        }
+        out << '\n';
+    }
+
+    void write_file(std::ostream &out, const ArgVParser::OutputFormat format, const Batch::FileStats &file) {
+        if (format == ArgVParser::OutputFormat::CSV) {
+            write_csv_field(out, file.path.string());
+            write_csv_stats(out, file.stats);
+        } else {
+            out << R"({"type":"file","path":)";
+            Json::write_string(out, file.path.string());
+            out << ',';
+            write_json_stats(out, file.stats);
+            out << R"(,"messages":[)";
+            for (std::size_t i = 0; i < file.errors.size(); ++i) {
+                if (i != 0) {
+                    out << ',';
+                }
+                Json::write_string(out, file.errors[i]);
+            }
+            out << "]}\n";
+        }
+        out.flush();
+    }
+
+    void write_project(std::ostream &out, const ArgVParser::OutputFormat format, const std::filesystem::path &root,
+                       const Batch::Stats &total, const std::size_t n_files, const std::size_t n_failed) {
+        if (format == ArgVParser::OutputFormat::CSV) {
+            out << "(total)";
+            write_csv_stats(out, total);
+        } else {
+            out << R"({"type":"project","path":)";
+            Json::write_string(out, root.string());
+            std::print(out, R"(,"files":{},"files_with_errors":{},)", n_files, n_failed);
+            write_json_stats(out, total);
+            out << "}\n";
+        }
+        out.flush();
+    }
+}
+
+auto Batch::Stats::operator+=(const Stats &other) -> Stats& {
+    tokens += other.tokens;
+    nodes += other.nodes;
+    for (std::size_t i = 0; i < kinds.size(); ++i) {
+        kinds[i] += other.kinds[i];
+    }
+    words += other.words;
+    branches += other.branches;
+    errors += other.errors;
+    return *this;
+}
+
+auto Batch::kind_of(const Node &node) -> std::optional<std::size_t> {
+    return Kinds::index(node);
+}
+
+auto Batch::collect(const std::filesystem::path &script, const Graph &graph) -> FileStats {
+    FileStats file{.path=script, .stats={}, .errors=graph.get_errors()};
+    auto &stats = file.stats;
+
+    stats.tokens = graph.get_tokens().size();
+    for (const auto &node : graph.get_nodes()) {
+        if (node == nullptr) {
+            continue;
+        }
+        ++stats.nodes;
+        if (const auto kind = Kinds::index(*node)) {
+            ++stats.kinds[*kind];
+        }
+        if (const auto *dialogue = dynamic_cast<const NodeDialogue*>(node.get())) {
+            stats.words += static_cast<std::size_t>(dialogue->word_count);
+        }
+    }
+
+    stats.branches = stats.kinds[kind_idx("choice")] + stats.kinds[kind_idx("if")]
+        + stats.kinds[kind_idx("elif")] + stats.kinds[kind_idx("else")];
+    stats.errors = file.errors.size();
+
+    return file;
+}
+
+auto Batch::analyze(const std::filesystem::path &script) -> FileStats {
+    const Profiler::FileScope file_scope(script);
+    try {
+        const Graph graph(script);
+        return collect(script, graph);
+    } catch (const std::exception &e) {
+        // one broken script shouldn't take the rest of the run down with it
+        FileStats file{.path=script, .stats={}, .errors={std::format("parser failed: {}", e.what())}};
+        file.stats.errors = 1;
+        return file;
+    }
+}
+
+auto Batch::run(const std::filesystem::path &path, const ArgVParser::OutputFormat format, std::ostream &out) -> int {
+    const auto scripts = list_scripts(path);
+    if (scripts.empty()) {
+        std::println(std::cerr, "no .rpy scripts found in {}", path.string());
+        return -1;
+    }
+
+    write_header(out, format);
+
+    Stats total;
+    std::size_t n_failed = 0;
+    const auto finish = [&](const FileStats &file) -> void {
+        total += file.stats;
+        if (file.stats.errors > 0) {
+            ++n_failed;
+        }
+        write_file(out, format, file);
+    };
+
+    ThreadPool pool;
+    const auto max_in_flight = pool.size() * 2;
+    std::deque<std::future<FileStats>> in_flight;
+
+    for (const auto &script : scripts) {
+        if (in_flight.size() >= max_in_flight) {
+            finish(in_flight.front().get());
+            in_flight.pop_front();
+        }
+        in_flight.push_back(pool.submit([script] -> FileStats {
+            return analyze(script);
+        }));
+    }
+    for (auto &f : in_flight) {
+        finish(f.get());
+    }
+
+    write_project(out, format, path, total, scripts.size(), n_failed);
+
+    return n_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_BATCH_HPP
+#define RPY_PROJ_ANALYZER_BATCH_HPP
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ArgVParser.hpp"
+#include "Graph.hpp"
+#include "GraphFile.hpp"
+
+/**
+ * @brief Headless analysis of a script or a whole project, for CI.
+ *
+ * Scripts are parsed on a thread pool and each one's statistics are written
+ * out as soon as it (and every script before it) is done. Only the statistics
+ * are kept, and only a few scripts are in flight at once, so memory doesn't
+ * grow with the size of the project. Output is in a stable order: folders
+ * first, then by name, like the file tree.
+ */
+class Batch {
+public:
+    static constexpr auto kind_names = GraphFile::kind_names;
+
+    struct Stats {
+        std::size_t tokens = 0;
+        std::size_t nodes = 0;
+        std::array<std::size_t, kind_names.size()> kinds{};
+        std::size_t words = 0;
+        std::size_t branches = 0; // menu choices plus if / elif / else arms
+        std::size_t errors = 0;
+
+        auto operator+=(const Stats &other) -> Stats&;
+    };
+
+    struct FileStats {
+        std::filesystem::path path;
+        Stats stats;
+        std::vector<std::string> errors;
+    };
+
+    /**
+     * @brief the index of the node's kind in `kind_names`.
+     */
+    [[nodiscard]] static auto kind_of(const Node &node) -> std::optional<std::size_t>;
+
+    [[nodiscard]] static auto analyze(const std::filesystem::path &script) -> FileStats;
+    [[nodiscard]] static auto collect(const std::filesystem::path &script, const Graph &graph) -> FileStats;
+
+    /**
+     * @brief analyzes `path` (a script or a directory) and writes one record per script, then the totals.
+     * @return 0 if every script parsed cleanly, 1 if any had errors, -1 if there was nothing to analyze.
+     */
+    static auto run(const std::filesystem::path &path, ArgVParser::OutputFormat format, std::ostream &out) -> int;
+};
+
+#endif //RPY_PROJ_ANALYZER_BATCH_HPP
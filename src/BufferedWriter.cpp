@@ -0,0 +1,32 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "BufferedWriter.hpp"
+
+#include <algorithm>
+
+BufferedWriter::BufferedWriter(std::ostream &out) : out(out), buf(buffer_size) {}
+
+void BufferedWriter::flush() {
+    out.write(buf.data(), static_cast<std::streamsize>(used));
+    used = 0;
+}
+
+void BufferedWriter::write(std::string_view str) {
+    while (!str.empty()) {
+        if (used == buf.size()) {
+            flush();
+        }
+        const auto n = std::min(str.size(), buf.size() - used);
+        std::copy_n(str.data(), n, buf.data() + used);
+        used += n;
+        str.remove_prefix(n);
+    }
+}
+
+auto BufferedWriter::finish() -> bool {
+    flush();
+    out.flush();
+    return out.good();
+}
@@ -0,0 +1,78 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_BUFFEREDWRITER_HPP
+#define RPY_PROJ_ANALYZER_BUFFEREDWRITER_HPP
+
+#include <cstddef>
+#include <format>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Formats text into a fixed size buffer and hands it to a stream whenever the buffer fills.
+ *
+ * Exports are written as they are produced, a character at a time from
+ * std::format, and going through the stream for each one adds up. This keeps
+ * them in a plain array and writes them out in big blocks instead.
+ */
+class BufferedWriter {
+public:
+    static constexpr std::size_t buffer_size = 64 * 1024;
+
+    /**
+     * @brief output iterator for std::format_to.
+     */
+    struct Iterator {
+        using difference_type = std::ptrdiff_t;
+
+        BufferedWriter *writer;
+
+        auto operator*() -> Iterator& { return *this; }
+        auto operator++() -> Iterator& { return *this; }
+        auto operator++(int) -> Iterator { return *this; }
+        auto operator=(const char c) -> Iterator& {
+            writer->put(c);
+            return *this;
+        }
+    };
+
+private:
+    std::ostream &out;
+    std::vector<char> buf;
+    std::size_t used = 0;
+
+    void flush();
+
+public:
+    explicit BufferedWriter(std::ostream &out);
+    BufferedWriter(const BufferedWriter&) = delete;
+    auto operator=(const BufferedWriter&) -> BufferedWriter& = delete;
+
+    void put(const char c) {
+        if (used == buf.size()) {
+            flush();
+        }
+        buf[used++] = c;
+    }
+
+    void write(std::string_view str);
+
+    template<typename... Args>
+    void print(std::format_string<Args...> fmt, Args&&... args) {
+        std::format_to(iter(), fmt, std::forward<Args>(args)...);
+    }
+
+    [[nodiscard]] auto iter() -> Iterator { return {this}; }
+
+    /**
+     * @brief writes out whatever is left in the buffer.
+     * @return whether everything made it to the stream.
+     */
+    auto finish() -> bool;
+};
+
+#endif //RPY_PROJ_ANALYZER_BUFFEREDWRITER_HPP
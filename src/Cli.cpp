@@ -0,0 +1,93 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "Cli.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <print>
+
+#include "ArgVParser.hpp"
+#include "Batch.hpp"
+#include "GraphExport.hpp"
+#include "Log.hpp"
+#include "Lsp.hpp"
+#include "Profiler.hpp"
+
+void Cli::start_profiler(const bool always) {
+    Profiler::set_enabled(always || ArgVParser::profile_out || ArgVParser::trace_out);
+    Profiler::set_tracing(ArgVParser::trace_out.has_value());
+}
+
+void Cli::write_profile() {
+    if (ArgVParser::profile_out) {
+        std::ofstream out(*ArgVParser::profile_out);
+        Profiler::write_json(out);
+    }
+    if (ArgVParser::trace_out) {
+        std::ofstream out(*ArgVParser::trace_out);
+        Profiler::write_trace(out);
+    }
+}
+
+auto Cli::run_batch() -> int {
+    if (ArgVParser::path) {
+        // stdout is for the results, and parse errors are part of them
+        Log::set_quiet(!ArgVParser::verbose());
+        start_profiler(false);
+        const auto status = Batch::run(*ArgVParser::path, ArgVParser::format, std::cout);
+        write_profile();
+        return status;
+    }
+
+    std::println(std::cerr, "No file name or directory given. Run with --help for options.");
+    return -1;
+}
+
+auto Cli::run_graph_export() -> int {
+    if (!ArgVParser::path) {
+        std::println(std::cerr, "--graph needs a script or a directory. Run with --help for options.");
+        return -1;
+    }
+    const auto &out_path = *ArgVParser::graph_out;
+    const auto format = GraphExport::format_of(out_path);
+    if (!format) {
+        std::println(std::cerr, "can't write a graph to {}, it must end in .dot, .gv, .json or .rpyg", out_path.string());
+        return -1;
+    }
+    if (*format == GraphExport::Format::Binary) {
+        std::println(std::cerr, ".rpyg files hold the layout too, so only rpy_proj_analyzer writes them");
+        return -1;
+    }
+
+    Log::set_quiet(!ArgVParser::verbose());
+    start_profiler(false);
+    const auto status = GraphExport::run(*ArgVParser::path, out_path, *format);
+    write_profile();
+    return status;
+}
+
+auto Cli::run_lsp() -> int {
+    // stdout carries the protocol, so nothing else can print there
+    Log::set_quiet(true);
+    std::ios::sync_with_stdio(false);
+    start_profiler(false);
+    const auto status = Lsp::run(std::cin, std::cout, ArgVParser::path);
+    write_profile();
+    return status;
+}
+
+auto Cli::run() -> int {
+    if (ArgVParser::lsp()) {
+        return run_lsp();
+    }
+    if (ArgVParser::export_out) {
+        std::println(std::cerr, "--export draws the graph, which needs rpy_proj_analyzer");
+        return -1;
+    }
+    if (ArgVParser::graph_out) {
+        return run_graph_export();
+    }
+    return run_batch();
+}
@@ -0,0 +1,44 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_CLI_HPP
+#define RPY_PROJ_ANALYZER_CLI_HPP
+
+/**
+ * @brief The modes that don't open a window, shared by rpy_proj_analyzer and the headless rpy_analyze.
+ */
+class Cli {
+public:
+    /**
+     * @brief turns the profiler on if `--profile` or `--trace` was given, or always if `always` is set.
+     */
+    static void start_profiler(bool always);
+
+    /**
+     * @brief writes what the profiler collected to `--profile`'s and `--trace`'s files.
+     */
+    static void write_profile();
+
+    /**
+     * @brief `--no-gui`, see Batch.
+     */
+    static auto run_batch() -> int;
+
+    /**
+     * @brief `--graph` to DOT or JSON, see GraphExport.
+     */
+    static auto run_graph_export() -> int;
+
+    /**
+     * @brief `--lsp`, see Lsp.
+     */
+    static auto run_lsp() -> int;
+
+    /**
+     * @brief whichever of the above the arguments ask for, for rpy_analyze.
+     */
+    static auto run() -> int;
+};
+
+#endif //RPY_PROJ_ANALYZER_CLI_HPP
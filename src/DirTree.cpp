@@ -0,0 +1,229 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "DirTree.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <ranges>
+#include <string_view>
+#include <utility>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ThreadPool.hpp"
+
+namespace {
+    struct ScanNode {
+        std::string name;
+        bool is_dir = false;
+        std::vector<ScanNode> children;
+    };
+
+    auto is_script(const std::string_view name) -> bool {
+        return name.size() > 4 && name.ends_with(".rpy");
+    }
+
+    /*
+     * Calls `fn(name, is_dir)` for every script and folder in `dir`.
+     * d_type saves a stat per entry; it's only needed when the filesystem
+     * doesn't report types, or to see what a symlink points at. Symlinked
+     * folders are skipped so a link loop can't hang the scan.
+     */
+    template<typename F>
+    void for_each_entry(DIR *dir, F &&fn) {
+        while (const dirent *ent = ::readdir(dir)) {
+            const std::string_view name = ent->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+
+            auto type = ent->d_type;
+            if (type == DT_UNKNOWN || type == DT_LNK) {
+                struct stat st{};
+                if (::fstatat(::dirfd(dir), ent->d_name, &st, 0) != 0) {
+                    continue;
+                }
+                if (S_ISREG(st.st_mode)) {
+                    type = DT_REG;
+                } else if (S_ISDIR(st.st_mode) && type == DT_UNKNOWN) {
+                    type = DT_DIR;
+                } else {
+                    continue;
+                }
+            }
+
+            if (type == DT_DIR) {
+                fn(name, true);
+            } else if (type == DT_REG && is_script(name)) {
+                fn(name, false);
+            }
+        }
+    }
+
+    void sort_children(std::vector<ScanNode> &children) {
+        std::ranges::sort(children, [](const ScanNode &a, const ScanNode &b) -> bool {
+            if (a.is_dir != b.is_dir) {
+                return a.is_dir;
+            }
+            return a.name < b.name;
+        });
+    }
+
+    auto open_dir(const int parent_fd, const char *name) -> DIR* {
+        const int fd = ::openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        DIR *dir = ::fdopendir(fd);
+        if (dir == nullptr) {
+            ::close(fd);
+        }
+        return dir;
+    }
+
+    /**
+     * @brief Scans a folder tree with every folder as its own task, so nested folders fan out too.
+     */
+    class ParallelScan {
+        std::mutex mtx;
+        std::condition_variable done;
+        unsigned pending = 0;
+        ThreadPool pool; // last, so the workers are joined before the rest goes away
+
+        void finish() {
+            std::lock_guard lock(mtx);
+            if (--pending == 0) {
+                done.notify_all();
+            }
+        }
+
+        void submit(std::string path, ScanNode &node) {
+            {
+                std::lock_guard lock(mtx);
+                pending++;
+            }
+            pool.submit([this, path = std::move(path), &node] -> void {
+                struct Finish {
+                    ParallelScan *scan;
+                    ~Finish() { scan->finish(); }
+                } finish{this};
+                scan(path, node);
+            });
+        }
+
+        void scan(const std::string &path, ScanNode &node) {
+            DIR *dir = open_dir(AT_FDCWD, path.c_str());
+            if (dir == nullptr) {
+                return;
+            }
+            for_each_entry(dir, [&](const std::string_view name, const bool is_dir) -> void {
+                node.children.push_back({.name=std::string(name), .is_dir=is_dir, .children={}});
+            });
+            ::closedir(dir);
+
+            // `node.children` doesn't change from here on, so the tasks can hold on to its elements
+            for (auto &child : node.children) {
+                if (child.is_dir) {
+                    submit(path + '/' + child.name, child);
+                }
+            }
+        }
+
+    public:
+        explicit ParallelScan(const unsigned n_threads) : pool(n_threads) {}
+
+        void run(std::string path, ScanNode &root) {
+            submit(std::move(path), root);
+            std::unique_lock lock(mtx);
+            done.wait(lock, [&] -> bool { return pending == 0; });
+        }
+    };
+
+    /**
+     * @brief drops the folders without any scripts in them and sorts the rest, returns whether any are left.
+     */
+    auto prune(ScanNode &node) -> bool {
+        std::erase_if(node.children, [](ScanNode &child) -> bool {
+            return child.is_dir && !prune(child);
+        });
+        sort_children(node.children);
+        return !node.children.empty();
+    }
+
+    auto flatten(const std::filesystem::path &path, const ScanNode &root) -> DirTree {
+        DirTree tree;
+        tree.root = path;
+        tree.entries.push_back({.name=root.name, .parent=DirTree::NONE, .first_child=0, .n_children=0, .is_dir=true});
+
+        // breadth first, so every entry's children end up next to each other
+        std::vector<const ScanNode*> sources = {&root};
+        for (unsigned i = 0; i < sources.size(); ++i) {
+            const auto &children = sources[i]->children;
+            tree.entries[i].first_child = static_cast<unsigned>(tree.entries.size());
+            tree.entries[i].n_children = static_cast<unsigned>(children.size());
+            for (const auto &child : children) {
+                tree.entries.push_back({.name=child.name, .parent=i, .first_child=0, .n_children=0, .is_dir=child.is_dir});
+                sources.push_back(&child);
+            }
+        }
+
+        return tree;
+    }
+}
+
+auto DirTree::children(const unsigned idx) const -> std::span<const Entry> {
+    const auto &entry = entries.at(idx);
+    return std::span(entries).subspan(entry.first_child, entry.n_children);
+}
+
+auto DirTree::path_of(const unsigned idx) const -> std::filesystem::path {
+    std::vector<const std::string*> names;
+    for (unsigned curr = idx; curr != 0 && curr != NONE; curr = entries.at(curr).parent) {
+        names.push_back(&entries.at(curr).name);
+    }
+
+    auto path = root;
+    for (const auto *name : names | std::views::reverse) {
+        path /= *name;
+    }
+    return path;
+}
+
+auto DirTree::size() const -> std::size_t {
+    return entries.size();
+}
+
+auto build_dir_tree(const std::filesystem::path &path) -> DirTree {
+    ScanNode root{.name=path.filename().string(), .is_dir=true, .children={}};
+    ParallelScan(ThreadPool::default_threads()).run(path.string(), root);
+    prune(root);
+    return flatten(path, root);
+}
+
+auto list_scripts(const std::filesystem::path &path) -> std::vector<std::filesystem::path> {
+    if (!std::filesystem::is_directory(path)) {
+        return {path};
+    }
+
+    const auto tree = build_dir_tree(path);
+    std::vector<std::filesystem::path> scripts;
+    const auto visit = [&](this auto self, const unsigned idx) -> void {
+        const auto &entry = tree.entries[idx];
+        for (unsigned child = entry.first_child; child < entry.first_child + entry.n_children; ++child) {
+            if (tree.entries[child].is_dir) {
+                self(child);
+            } else {
+                scripts.push_back(tree.path_of(child));
+            }
+        }
+    };
+    visit(0);
+
+    return scripts;
+}
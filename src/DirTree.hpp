@@ -0,0 +1,49 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_DIRTREE_HPP
+#define RPY_PROJ_ANALYZER_DIRTREE_HPP
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The scripts of a project and the folders leading to them, as one flat array.
+ *
+ * Entry 0 is the root. The children of an entry are stored next to each other
+ * (folders first, then by name), so an entry only needs the index of its first
+ * child and how many there are. Folders without any scripts in them are left out.
+ */
+struct DirTree {
+    static constexpr unsigned NONE = ~0u;
+
+    struct Entry {
+        std::string name;
+        unsigned parent = NONE;
+        unsigned first_child = 0;
+        unsigned n_children = 0;
+        bool is_dir = false;
+    };
+
+    std::filesystem::path root;
+    std::vector<Entry> entries;
+
+    [[nodiscard]] auto children(unsigned idx) const -> std::span<const Entry>;
+    [[nodiscard]] auto path_of(unsigned idx) const -> std::filesystem::path;
+    [[nodiscard]] auto size() const -> std::size_t;
+};
+
+/**
+ * @brief scans `path` for .rpy files. Every folder is scanned as its own task on a thread pool.
+ */
+auto build_dir_tree(const std::filesystem::path &path) -> DirTree;
+
+/**
+ * @brief the scripts under `path` in file tree order, or just `path` if it is a script.
+ */
+auto list_scripts(const std::filesystem::path &path) -> std::vector<std::filesystem::path>;
+
+#endif //RPY_PROJ_ANALYZER_DIRTREE_HPP
@@ -0,0 +1,48 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "DisplayCache.hpp"
+
+#include "AllocCounter.hpp"
+#include "Node.hpp"
+
+DisplayCache::DisplayCache(const std::size_t capacity)
+    : capacity(capacity) {
+}
+
+void DisplayCache::next_frame() {
+    ++frame;
+}
+
+auto DisplayCache::get(const std::span<const NodeGeom> geoms, const unsigned idx) -> DisplayNode& {
+    if (const auto it = index.find(idx); it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        it->second->frame = frame;
+        return it->second->node;
+    }
+
+    const NoAllocGuard::Allow allow; // once per node, until it gets dropped again
+    const auto &geom = geoms[idx];
+    lru.push_front(Slot{.geom=idx, .frame=frame, .bytes=0, .node=DisplayNode::of(*geom.node, geom.margin_box)});
+    index.emplace(idx, lru.begin());
+    lru.front().bytes = sizeof(Slot) + lru.front().node.resident_bytes();
+    bytes += lru.front().bytes;
+
+    // nodes shown this frame stay, so every reference handed out is good until next_frame
+    while (lru.size() > capacity && lru.back().frame != frame) {
+        index.erase(lru.back().geom);
+        bytes -= lru.back().bytes;
+        lru.pop_back();
+    }
+
+    return lru.front().node;
+}
+
+auto DisplayCache::size() const -> std::size_t {
+    return lru.size();
+}
+
+auto DisplayCache::resident_bytes() const -> std::size_t {
+    return bytes + (index.size() * (sizeof(unsigned) + sizeof(std::list<Slot>::iterator) + sizeof(void*)));
+}
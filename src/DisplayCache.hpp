@@ -0,0 +1,61 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_DISPLAYCACHE_HPP
+#define RPY_PROJ_ANALYZER_DISPLAYCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <span>
+#include <unordered_map>
+
+#include "DisplayNode.hpp"
+
+/**
+ * @brief LRU cache of the DisplayNodes of one script, built the first time a node comes into view.
+ *
+ * Building a DisplayNode formats and shapes all of its text, which is most of
+ * the work of showing a script, so it is only done for nodes that are looked
+ * at. Once over `capacity`, the nodes shown least recently are dropped, but
+ * never ones shown in the current frame.
+ */
+class DisplayCache {
+    struct Slot {
+        unsigned geom;       // index into LayoutData::geoms
+        std::uint64_t frame; // last frame it was shown in
+        std::size_t bytes;   // what it was counted as in `bytes` when it was built
+        DisplayNode node;
+    };
+
+    std::list<Slot> lru; // most recently shown at the front
+    std::unordered_map<unsigned, std::list<Slot>::iterator> index;
+    std::size_t capacity;
+    std::uint64_t frame = 0;
+    std::size_t bytes = 0; // of every slot, kept as they are built and dropped
+
+public:
+    static constexpr std::size_t default_capacity = 1024;
+
+    explicit DisplayCache(std::size_t capacity = default_capacity);
+
+    /**
+     * @brief starts a new frame. References from `get` are good until the next call.
+     */
+    void next_frame();
+
+    /**
+     * @brief the DisplayNode for `geoms[idx]`, built now if it isn't cached.
+     */
+    auto get(std::span<const NodeGeom> geoms, unsigned idx) -> DisplayNode&;
+
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    /**
+     * @brief rough estimate of the heap memory held by the cached nodes. Constant time.
+     */
+    [[nodiscard]] auto resident_bytes() const -> std::size_t;
+};
+
+#endif //RPY_PROJ_ANALYZER_DISPLAYCACHE_HPP
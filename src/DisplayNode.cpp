@@ -9,6 +9,7 @@
 
 #include "raylib-cpp.hpp"
 
+#include "AllocCounter.hpp"
 #include "ArgVParser.hpp"
 #include "Node.hpp"
 #include "TextHelper.hpp"
@@ -18,7 +19,7 @@ void DisplayNode::setup_texture() const {
     {
         ClearBackground(raylib::Color::Blank());
         const raylib::Rectangle tex_box{0, 0, width, height};
-        const auto text_width = TextHelper::text_width(this->title);
+        const auto text_width = TextHelper::text_width(this->title_text);
         const float title_x = (padding_box.width / 2 - text_width / 2);
 
         tex_box.Draw(raylib::Color(0xE2, 0xE2, 0xE2));
@@ -35,13 +36,18 @@ void DisplayNode::setup_texture() const {
                 }
             }
         }
+        TextHelper::flush_text();
     }
 
     EndTextureMode();
     SetTextureFilter(texture.texture, TEXTURE_FILTER_BILINEAR);
 }
 
-void DisplayNode::setup_dimensions() {
+NodeGeom::NodeGeom(const Node *node, const raylib::Rectangle rect)
+    : node(node), margin_box(rect) {
+    const auto &margin = DisplayNode::margin;
+    const auto &padding = DisplayNode::padding;
+
     // TODO: this isn't quite right. needs tweaking
     main_box = margin_box;
     main_box.x += margin.l;
@@ -53,6 +59,12 @@ void DisplayNode::setup_dimensions() {
     padding_box.y += padding.t;
     padding_box.width -= (padding.t + padding.b);
     padding_box.height -= (padding.l + padding.r);
+}
+
+void DisplayNode::setup_dimensions() {
+    const NodeGeom geom(underlying, margin_box);
+    main_box = geom.main_box;
+    padding_box = geom.padding_box;
 
     const auto text_width = TextHelper::text_width(this->title_text);
     const float title_x = padding_box.x + (padding_box.width / 2 - text_width / 2);
@@ -74,6 +86,11 @@ DisplayNode::DisplayNode(const Node* node, const raylib::Rectangle rect, std::st
     setup_dimensions();
 }
 
+auto DisplayNode::of(const Node &node, const raylib::Rectangle rect) -> DisplayNode {
+    auto [title, fields] = node.display_fields();
+    return {&node, rect, std::move(title), std::move(fields)};
+}
+
 auto DisplayNode::is_mouse_hovering(const raylib::Camera2D &cam) -> bool {
     Vector2 curr_mouse_pos = GetScreenToWorld2D(GetMousePosition(), cam);
     hovered = padding_box.CheckCollision(curr_mouse_pos);
@@ -89,7 +106,7 @@ auto DisplayNode::is_mouse_hovering(const raylib::Camera2D &cam) -> bool {
     return hovered;
 }
 
-auto DisplayNode::draw() const -> std::optional<std::string> {
+auto DisplayNode::draw() const -> const TextHelper::DispText* {
     main_box.Draw(default_color);
 
     if (hovered) {
@@ -111,13 +128,16 @@ auto DisplayNode::draw() const -> std::optional<std::string> {
 
     if (hover_start && mouse_pos) {
         if (std::chrono::steady_clock::now() - *hover_start > std::chrono::seconds(1)) {
-            auto [line, col] = underlying->line_and_col();
-            auto text = std::format("Line:     {:>4}\nColumn:   {:>4}", line, col);
-            return text;
+            if (!hover_text) {
+                const NoAllocGuard::Allow allow; // once per node
+                auto [line, col] = underlying->line_and_col();
+                hover_text = TextHelper::into_disp_text(std::format("Line:     {:>4}\nColumn:   {:>4}", line, col));
+            }
+            return &*hover_text;
         }
     }
 
-    return std::nullopt;
+    return nullptr;
 }
 
 auto DisplayNode::to_string() const -> std::string {
@@ -135,3 +155,19 @@ auto DisplayNode::get_height() -> float {
 auto DisplayNode::get_underlying() const -> const Node* {
     return underlying;
 }
+
+auto DisplayNode::resident_bytes() const -> std::size_t {
+    std::size_t bytes = title.capacity() + TextHelper::resident_bytes(title_text);
+    bytes += fields.capacity() * sizeof(std::string);
+    for (const auto &field : fields) {
+        bytes += field.capacity();
+    }
+    bytes += fields_text.capacity() * sizeof(TextHelper::DispText);
+    for (const auto &text : fields_text) {
+        bytes += TextHelper::resident_bytes(text);
+    }
+    if (hover_text) {
+        bytes += TextHelper::resident_bytes(*hover_text);
+    }
+    return bytes;
+}
@@ -21,6 +21,19 @@ struct HoverBox {
     raylib::RenderTexture2D texture;
 };
 
+/**
+ * @brief Where a node's box goes: all that culling, edges and highlights need,
+ * without the text that DisplayNode shapes for drawing it.
+ */
+struct NodeGeom {
+    const Node *node = nullptr;
+    raylib::Rectangle margin_box{};
+    raylib::Rectangle main_box{};
+    raylib::Rectangle padding_box{};
+
+    NodeGeom(const Node *node, raylib::Rectangle rect);
+};
+
 class DisplayNode {
     struct Spacing {
         float t{};
@@ -74,6 +87,7 @@ class DisplayNode {
     bool hovered = false;
     std::optional<std::chrono::steady_clock::time_point> hover_start;
     std::optional<Vector2> mouse_pos;
+    mutable std::optional<TextHelper::DispText> hover_text; // made the first time it is shown
 
     const Node* underlying = nullptr;
 
@@ -106,9 +120,17 @@ public:
 
     DisplayNode(const Node* node, raylib::Rectangle rect, std::string title, std::vector<std::string> fields);
 
+    /**
+     * @brief the DisplayNode for `node`, with the title and fields it gives.
+     */
+    [[nodiscard]] static auto of(const Node &node, raylib::Rectangle rect) -> DisplayNode;
+
     auto is_mouse_hovering(const raylib::Camera2D& cam) -> bool;
 
-    [[nodiscard]] auto draw() const -> std::optional<std::string>;
+    /**
+     * @return the text to show next to the mouse, once the node has been hovered long enough.
+     */
+    [[nodiscard]] auto draw() const -> const TextHelper::DispText*;
 
     [[nodiscard]] auto to_string() const -> std::string;
 
@@ -117,6 +139,11 @@ public:
     static auto get_height() -> float;
 
     [[nodiscard]] auto get_underlying() const -> const Node*;
+
+    /**
+     * @brief heap memory owned by this node's strings and shaped text (excluding sizeof itself).
+     */
+    [[nodiscard]] auto resident_bytes() const -> std::size_t;
 };
 
 template<>
@@ -0,0 +1,133 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "EdgeRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <rlgl.h>
+
+void EdgeRenderer::add_segment(const raylib::Vector2 from, const raylib::Vector2 to, const float thickness) {
+    const float dx = to.x - from.x;
+    const float dy = to.y - from.y;
+    const float len = std::sqrt(dx * dx + dy * dy);
+    if (len <= 0.0f) {
+        return;
+    }
+
+    const float nx = -dy / len * (thickness / 2);
+    const float ny = dx / len * (thickness / 2);
+
+    const raylib::Vector2 a{from.x + nx, from.y + ny};
+    const raylib::Vector2 b{from.x - nx, from.y - ny};
+    const raylib::Vector2 c{to.x - nx, to.y - ny};
+    const raylib::Vector2 d{to.x + nx, to.y + ny};
+
+    // rlgl culls back faces, so keep the same winding that DrawTriangle() expects
+    if (((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x)) > 0) {
+        verts.insert(verts.end(), {a, c, b, a, d, c});
+    } else {
+        verts.insert(verts.end(), {a, b, c, a, c, d});
+    }
+}
+
+EdgeRenderer::EdgeRenderer(const std::span<const std::array<raylib::Vector2, N_POINTS>> line_points, const float thickness) {
+    edges.reserve(line_points.size());
+    verts.reserve(line_points.size() * (N_POINTS - 3) * SEGMENT_DIVISIONS * 6);
+
+    for (const auto &points : line_points) {
+        Edge edge{.bounds={}, .first_vert=static_cast<unsigned>(verts.size()), .n_verts=0};
+
+        float min_x = std::numeric_limits<float>::max();
+        float min_y = std::numeric_limits<float>::max();
+        float max_x = -std::numeric_limits<float>::max();
+        float max_y = -std::numeric_limits<float>::max();
+
+        /*
+         * Same uniform cubic B-spline that DrawSplineBasis() uses, just
+         * evaluated once up front instead of every frame.
+         */
+        for (int i = 0; i + 3 < N_POINTS; ++i) {
+            const auto &p0 = points.at(i);
+            const auto &p1 = points.at(i + 1);
+            const auto &p2 = points.at(i + 2);
+            const auto &p3 = points.at(i + 3);
+
+            const std::array<float, 4> ax = {
+                (-p0.x + 3 * p1.x - 3 * p2.x + p3.x) / 6,
+                (3 * p0.x - 6 * p1.x + 3 * p2.x) / 6,
+                (-3 * p0.x + 3 * p2.x) / 6,
+                (p0.x + 4 * p1.x + p2.x) / 6,
+            };
+            const std::array<float, 4> ay = {
+                (-p0.y + 3 * p1.y - 3 * p2.y + p3.y) / 6,
+                (3 * p0.y - 6 * p1.y + 3 * p2.y) / 6,
+                (-3 * p0.y + 3 * p2.y) / 6,
+                (p0.y + 4 * p1.y + p2.y) / 6,
+            };
+
+            auto eval = [&](const float t) -> raylib::Vector2 {
+                return {
+                    ax[3] + t * (ax[2] + t * (ax[1] + t * ax[0])),
+                    ay[3] + t * (ay[2] + t * (ay[1] + t * ay[0])),
+                };
+            };
+
+            raylib::Vector2 prev = eval(0.0f);
+            for (int j = 1; j <= SEGMENT_DIVISIONS; ++j) {
+                const auto curr = eval(static_cast<float>(j) / SEGMENT_DIVISIONS);
+                add_segment(prev, curr, thickness);
+                min_x = std::min({min_x, prev.x, curr.x});
+                min_y = std::min({min_y, prev.y, curr.y});
+                max_x = std::max({max_x, prev.x, curr.x});
+                max_y = std::max({max_y, prev.y, curr.y});
+                prev = curr;
+            }
+        }
+
+        edge.n_verts = static_cast<unsigned>(verts.size()) - edge.first_vert;
+        if (edge.n_verts == 0) {
+            continue;
+        }
+
+        edge.bounds = raylib::Rectangle{
+            min_x - thickness,
+            min_y - thickness,
+            (max_x - min_x) + (thickness * 2),
+            (max_y - min_y) + (thickness * 2),
+        };
+        edges.push_back(edge);
+    }
+}
+
+auto EdgeRenderer::draw(const raylib::Rectangle view, const raylib::Color color) const -> unsigned {
+    unsigned drawn = 0;
+
+    rlBegin(RL_TRIANGLES);
+    {
+        rlColor4ub(color.r, color.g, color.b, color.a);
+        for (const auto &edge : edges) {
+            if (!edge.bounds.CheckCollision(view)) {
+                continue;
+            }
+
+            for (unsigned i = edge.first_vert; i < edge.first_vert + edge.n_verts; ++i) {
+                rlVertex2f(verts[i].x, verts[i].y);
+            }
+            drawn++;
+        }
+    }
+    rlEnd();
+
+    return drawn;
+}
+
+auto EdgeRenderer::size() const -> std::size_t {
+    return edges.size();
+}
+
+auto EdgeRenderer::resident_bytes() const -> std::size_t {
+    return (edges.capacity() * sizeof(Edge)) + (verts.capacity() * sizeof(raylib::Vector2));
+}
@@ -0,0 +1,51 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_EDGERENDERER_HPP
+#define RPY_PROJ_ANALYZER_EDGERENDERER_HPP
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "raylib-cpp.hpp"
+
+#include "GraphLayout.hpp"
+
+/**
+ * @brief Draws every child -> parent connector of a layout in a single batch.
+ *
+ * The splines are tessellated into thick triangle strips once (when the layout
+ * changes), so drawing a frame is just culling the edges against the view and
+ * pushing the already-built vertices into one rlgl batch.
+ */
+class EdgeRenderer {
+    static constexpr int SEGMENT_DIVISIONS = 12;
+
+    struct Edge {
+        raylib::Rectangle bounds;
+        unsigned first_vert = 0;
+        unsigned n_verts = 0;
+    };
+
+    std::vector<Edge> edges;
+    std::vector<raylib::Vector2> verts; // triangle list, 6 vertices per line segment
+
+    void add_segment(raylib::Vector2 from, raylib::Vector2 to, float thickness);
+
+public:
+    EdgeRenderer() = default;
+    explicit EdgeRenderer(std::span<const std::array<raylib::Vector2, N_POINTS>> line_points, float thickness = 2.0f);
+
+    /**
+     * @brief draws all edges overlapping `view` (in world coordinates).
+     * @return the number of edges that were submitted.
+     */
+    auto draw(raylib::Rectangle view, raylib::Color color) const -> unsigned;
+
+    [[nodiscard]] auto size() const -> std::size_t;
+    [[nodiscard]] auto resident_bytes() const -> std::size_t;
+};
+
+#endif //RPY_PROJ_ANALYZER_EDGERENDERER_HPP
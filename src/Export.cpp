@@ -0,0 +1,229 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "Export.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <rlgl.h>
+
+#include "DisplayCache.hpp"
+#include "EdgeRenderer.hpp"
+#include "Node.hpp"
+#include "PngWriter.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    constexpr int tile_size = 2048; // every GPU this runs on can do at least this
+    constexpr std::size_t strip_budget = 64ull * 1024 * 1024; // pixels held before they are written out
+
+    /**
+     * @brief the area every node box covers, in world coordinates.
+     */
+    auto bounds_of(const LayoutData &data) -> raylib::Rectangle {
+        if (data.geoms.empty()) {
+            return {0, 0, 1, 1};
+        }
+
+        float min_x = std::numeric_limits<float>::max();
+        float min_y = std::numeric_limits<float>::max();
+        float max_x = -std::numeric_limits<float>::max();
+        float max_y = -std::numeric_limits<float>::max();
+        for (const auto &geom : data.geoms) {
+            const auto &box = geom.margin_box;
+            min_x = std::min(min_x, box.x);
+            min_y = std::min(min_y, box.y);
+            max_x = std::max(max_x, box.x + box.width);
+            max_y = std::max(max_y, box.y + box.height);
+        }
+        return {std::floor(min_x), std::floor(min_y), std::ceil(max_x - min_x), std::ceil(max_y - min_y)};
+    }
+
+    auto hex(const raylib::Color color) -> std::string {
+        return std::format("#{:02x}{:02x}{:02x}", color.r, color.g, color.b);
+    }
+
+    /**
+     * @brief writes `text` with the characters XML reserves escaped, cut to `max_chars` codepoints.
+     */
+    template<typename Out>
+    void write_xml(Out out, const std::string_view text, std::size_t max_chars = std::numeric_limits<std::size_t>::max()) {
+        std::size_t chars = 0;
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            const auto c = text[i];
+            // only count the first byte of each UTF-8 sequence
+            if ((static_cast<unsigned char>(c) & 0xC0) != 0x80 && chars++ == max_chars) {
+                std::format_to(out, "…");
+                return;
+            }
+            switch (c) {
+                case '&': std::format_to(out, "&amp;"); break;
+                case '<': std::format_to(out, "&lt;"); break;
+                case '>': std::format_to(out, "&gt;"); break;
+                case '"': std::format_to(out, "&quot;"); break;
+                default: *out++ = c; break;
+            }
+        }
+    }
+}
+
+auto Export::format_of(const std::filesystem::path &path) -> std::optional<Format> {
+    const auto ext = path.extension();
+    if (ext == ".svg") {
+        return Format::SVG;
+    }
+    if (ext == ".png") {
+        return Format::PNG;
+    }
+    return std::nullopt;
+}
+
+auto Export::write_svg(const LayoutData &data, std::ostream &stream) -> bool {
+    const Profiler::Scope scope("export_svg");
+    const auto [x, y, w, h] = bounds_of(data);
+    const auto out = std::ostreambuf_iterator<char>(stream);
+    const auto fill = hex(DisplayNode::default_color);
+    const auto line = hex(DisplayNode::line_color);
+
+    std::format_to(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"{}\" height=\"{}\" viewBox=\"{} {} {} {}\" "
+        "font-family=\"Liberation Mono, monospace\" font-size=\"{}\">\n",
+        w, h, x, y, w, h, TextHelper::font_size);
+
+    // same order as the view draws them: edges, highlights, then the nodes on top
+    std::format_to(out, "<g fill=\"none\" stroke=\"{}\" stroke-width=\"2\">\n", line);
+    for (const auto &p : data.line_points) {
+        // the view draws these as uniform cubic B-splines, which are exactly these Béziers
+        std::format_to(out, "<path d=\"M{:.1f},{:.1f}",
+            (p[0].x + 4 * p[1].x + p[2].x) / 6, (p[0].y + 4 * p[1].y + p[2].y) / 6);
+        for (std::size_t i = 0; i + 3 < p.size(); ++i) {
+            const auto &p0 = p[i];
+            const auto &p1 = p[i + 1];
+            const auto &p2 = p[i + 2];
+            const auto &p3 = p[i + 3];
+            std::format_to(out, " C{:.1f},{:.1f} {:.1f},{:.1f} {:.1f},{:.1f}",
+                (2 * p1.x + p2.x) / 3, (2 * p1.y + p2.y) / 3,
+                (p1.x + 2 * p2.x) / 3, (p1.y + 2 * p2.y) / 3,
+                (p1.x + 4 * p2.x + p3.x) / 6, (p1.y + 4 * p2.y + p3.y) / 6);
+        }
+        std::format_to(out, "\"/>\n");
+    }
+    std::format_to(out, "</g>\n<g fill=\"#00e430\">\n");
+    for (const auto &r : data.highlights) {
+        std::format_to(out, "<rect x=\"{}\" y=\"{}\" width=\"{}\" height=\"{}\"/>\n", r.x, r.y, r.width, r.height);
+    }
+    std::format_to(out, "</g>\n");
+
+    // monospace, so about this many characters fit across a node
+    const auto max_chars = static_cast<std::size_t>(DisplayNode::get_width() / (TextHelper::font_size * 0.6f)) - 4;
+
+    for (const auto &geom : data.geoms) {
+        const auto &box = geom.main_box;
+        const auto &pad = geom.padding_box;
+        const auto text = geom.node->to_string();
+        const auto colon = text.find(": ");
+        const auto kind = std::string_view(text).substr(0, colon);
+        const auto detail = colon == std::string::npos ? std::string_view{} : std::string_view(text).substr(colon + 2);
+
+        std::format_to(out, "<g><title>line {}: ", geom.node->line_and_col().first);
+        write_xml(out, text);
+        std::format_to(out, "</title><rect x=\"{}\" y=\"{}\" width=\"{}\" height=\"{}\" fill=\"{}\" stroke=\"{}\"/>",
+            box.x, box.y, box.width, box.height, fill, line);
+        std::format_to(out, "<text x=\"{}\" y=\"{}\" text-anchor=\"middle\" font-weight=\"bold\" fill=\"{}\">",
+            pad.x + (pad.width / 2), pad.y + TextHelper::font_size, line);
+        write_xml(out, kind, max_chars);
+        std::format_to(out, "</text>");
+        if (!detail.empty()) {
+            std::format_to(out, "<text x=\"{}\" y=\"{}\" fill=\"{}\">", pad.x, pad.y + (TextHelper::font_size * 2.5f), line);
+            write_xml(out, detail, max_chars);
+            std::format_to(out, "</text>");
+        }
+        std::format_to(out, "</g>\n");
+    }
+
+    std::format_to(out, "</svg>\n");
+    stream.flush();
+    return stream.good();
+}
+
+auto Export::write_png(const LayoutData &data, std::ostream &out, const raylib::Color background) -> bool {
+    const Profiler::Scope scope("export_png");
+    const auto bounds = bounds_of(data);
+    const auto width = static_cast<std::size_t>(bounds.width);
+    const auto height = static_cast<std::size_t>(bounds.height);
+
+    // as many rows as fit in the budget, but never more than a texture can hold
+    const auto strip_h = static_cast<int>(std::clamp<std::size_t>(strip_budget / (width * 3), 1, tile_size));
+    const raylib::RenderTexture target(tile_size, strip_h);
+    const EdgeRenderer edges(data.line_points);
+    DisplayCache displays; // DisplayNodes are only made for the tile being drawn
+    std::vector<std::uint8_t> strip(width * 3 * static_cast<std::size_t>(strip_h));
+    std::vector<unsigned> in_strip;
+
+    PngWriter png(out, static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height));
+    for (std::size_t y0 = 0; y0 < height; y0 += strip_h) {
+        const auto rows = std::min<std::size_t>(strip_h, height - y0);
+        const raylib::Rectangle strip_rect{bounds.x, bounds.y + static_cast<float>(y0), bounds.width, static_cast<float>(strip_h)};
+
+        in_strip.clear();
+        for (unsigned i = 0; i < data.geoms.size(); ++i) {
+            if (data.geoms[i].margin_box.CheckCollision(strip_rect)) {
+                in_strip.push_back(i);
+            }
+        }
+
+        for (std::size_t x0 = 0; x0 < width; x0 += tile_size) {
+            const auto cols = std::min<std::size_t>(tile_size, width - x0);
+            const raylib::Rectangle view{strip_rect.x + static_cast<float>(x0), strip_rect.y, tile_size, static_cast<float>(strip_h)};
+            Camera2D camera{.offset={0, 0}, .target={view.x, view.y}, .rotation=0, .zoom=1};
+
+            displays.next_frame();
+            BeginTextureMode(target);
+            ClearBackground(background);
+            BeginMode2D(camera);
+            {
+                edges.draw(view, DisplayNode::line_color);
+                for (const auto &h : data.highlights) {
+                    if (h.CheckCollision(view)) {
+                        h.Draw(raylib::Color::Green());
+                    }
+                }
+                for (const auto i : in_strip) {
+                    if (data.geoms[i].margin_box.CheckCollision(view)) {
+                        (void)displays.get(data.geoms, i).draw();
+                    }
+                }
+                TextHelper::flush_text();
+            }
+            EndMode2D();
+            EndTextureMode();
+
+            // render textures come back bottom row first, and as RGBA
+            auto *pixels = static_cast<std::uint8_t*>(
+                rlReadTexturePixels(target.texture.id, tile_size, strip_h, target.texture.format));
+            for (std::size_t r = 0; r < rows; ++r) {
+                const auto *src = pixels + ((static_cast<std::size_t>(strip_h) - 1 - r) * tile_size * 4);
+                auto *dst = strip.data() + (r * width * 3) + (x0 * 3);
+                for (std::size_t c = 0; c < cols; ++c) {
+                    dst[(c * 3) + 0] = src[(c * 4) + 0];
+                    dst[(c * 3) + 1] = src[(c * 4) + 1];
+                    dst[(c * 3) + 2] = src[(c * 4) + 2];
+                }
+            }
+            RL_FREE(pixels);
+        }
+
+        for (std::size_t r = 0; r < rows; ++r) {
+            png.write_row(std::span(strip).subspan(r * width * 3, width * 3));
+        }
+    }
+
+    return png.finish();
+}
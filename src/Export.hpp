@@ -0,0 +1,54 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_EXPORT_HPP
+#define RPY_PROJ_ANALYZER_EXPORT_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+
+#include "raylib-cpp.hpp"
+
+#include "GraphLayout.hpp"
+
+/**
+ * @brief Writes a laid out script to an image file, for printing or sharing.
+ *
+ * Both formats are written as they are produced, so neither has to fit in
+ * memory: SVG node by node, PNG a strip of rows at a time.
+ */
+class Export {
+public:
+    enum class Format : std::uint8_t {
+        SVG,
+        PNG,
+    };
+
+    /**
+     * @brief the format to write, going by the file's extension.
+     */
+    [[nodiscard]] static auto format_of(const std::filesystem::path &path) -> std::optional<Format>;
+
+    /**
+     * @brief writes every node, edge and highlight as SVG. Doesn't need a window or fonts.
+     * @return whether everything made it to the stream.
+     */
+    static auto write_svg(const LayoutData &data, std::ostream &out) -> bool;
+
+    /**
+     * @brief renders the layout at 1:1 and writes it as PNG.
+     *
+     * The image is rendered in tiles no bigger than a texture can be, a strip
+     * of tiles at a time, and each strip is written out before the next one
+     * is rendered, so memory stays bounded however big the layout is. Needs a
+     * (hidden) window and the fonts to be loaded.
+     *
+     * @return whether everything made it to the stream.
+     */
+    static auto write_png(const LayoutData &data, std::ostream &out, raylib::Color background) -> bool;
+};
+
+#endif //RPY_PROJ_ANALYZER_EXPORT_HPP
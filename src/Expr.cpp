@@ -304,7 +304,7 @@ auto fold_into_expr(std::span<const Token> toks, unsigned idx, const float min_p
                 if (std::holds_alternative<TokComma>(*peek())) {
                     auto elem_toks = split_inside_parens(toks, lparen_idx);
                     idx = lparen_idx;
-                    std::println("");
+                    Log::info("");
                 }
                 consume();
                 return expr;
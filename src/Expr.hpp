@@ -5,6 +5,7 @@
 #ifndef RPY_PROJ_ANALYZER_EXPR_HPP
 #define RPY_PROJ_ANALYZER_EXPR_HPP
 
+#include "Log.hpp"
 #include "Token.hpp"
 
 #include <cstdint>
@@ -96,7 +97,7 @@ inline auto precedence(const OpType &op) -> std::pair<float, float> {
             // right assoc (but only one arg)
             return {8.0f, 8.1f};
         default:
-            std::println(std::cerr, "unknown precedence in Expr");
+            Log::error("unknown precedence in Expr");
             std::unreachable();
     }
 }
@@ -109,7 +110,7 @@ inline auto unary_str(const UnaryOp &op) -> std::string {
         case Neg:
             return "-";
         default:
-            std::println(std::cerr, "unknown unary operator in Expr");
+            Log::error("unknown unary operator in Expr");
             std::unreachable();
     }
 }
@@ -154,7 +155,7 @@ inline auto binary_str(const BinaryOp &op) -> std::string {
         case Or:
             return "or";
         default:
-            std::println(std::cerr, "unknown binary operator in Expr");
+            Log::error("unknown binary operator in Expr");
             std::unreachable();
     }
 }
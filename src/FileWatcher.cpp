@@ -0,0 +1,268 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "FileWatcher.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <print>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif //__linux__
+
+auto FileWatcher::stat_of(const std::filesystem::path &path) -> std::optional<Stat> {
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    const auto size = ec ? 0 : std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return Stat{.mtime=mtime, .size=size};
+}
+
+auto FileWatcher::wanted(const std::filesystem::path &path) const -> bool {
+    if (only) {
+        return path == *only;
+    }
+    return path.extension() == ".rpy";
+}
+
+void FileWatcher::add_watch(const std::filesystem::path &dir, const bool recursive) {
+#ifdef __linux__
+    constexpr std::uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE
+        | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF;
+
+    const int wd = inotify_add_watch(fd, dir.c_str(), mask);
+    if (wd < 0) {
+        // usually out of watches (fs.inotify.max_user_watches) on big trees
+        fall_back();
+        return;
+    }
+    watch_dirs[wd] = dir;
+
+    if (!recursive) {
+        return;
+    }
+
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, std::filesystem::directory_options::skip_permission_denied, ec)) {
+        if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+            add_watch(entry.path(), true);
+            if (fd < 0) {
+                return;
+            }
+        }
+    }
+#endif //__linux__
+}
+
+void FileWatcher::read_events() {
+#ifdef __linux__
+    alignas(inotify_event) std::array<char, 4096> buff{};
+    const auto now = Clock::now();
+
+    while (true) {
+        const auto len = ::read(fd, buff.data(), buff.size());
+        if (len <= 0) {
+            return; // EAGAIN, nothing left to read
+        }
+
+        for (std::size_t off = 0; off < static_cast<std::size_t>(len);) {
+            const auto *event = reinterpret_cast<const inotify_event*>(buff.data() + off);
+            off += sizeof(inotify_event) + event->len;
+
+            if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                resync();
+                if (fd < 0) {
+                    return;
+                }
+                continue;
+            }
+
+            const auto dir = watch_dirs.find(event->wd);
+            if (dir == watch_dirs.end()) {
+                continue;
+            }
+            if ((event->mask & IN_IGNORED) != 0) {
+                watch_dirs.erase(dir);
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+
+            const auto path = dir->second / event->name;
+
+            if ((event->mask & IN_ISDIR) != 0) {
+                if (only) {
+                    continue;
+                }
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+                    add_watch(path, true);
+                    std::error_code ec;
+                    for (const auto &entry : std::filesystem::recursive_directory_iterator(path, ec)) {
+                        if (wanted(entry.path())) {
+                            pending[entry.path()] = now;
+                        }
+                    }
+                } else if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0) {
+                    const auto prefix = path.native() + std::filesystem::path::preferred_separator;
+                    for (const auto &script : known) {
+                        if (script.native().starts_with(prefix)) {
+                            pending[script] = now;
+                        }
+                    }
+                }
+                if (fd < 0) {
+                    return;
+                }
+                continue;
+            }
+
+            if (wanted(path)) {
+                pending[path] = now;
+            }
+        }
+    }
+#endif //__linux__
+}
+
+void FileWatcher::scan(const bool report) {
+    std::unordered_map<std::filesystem::path, Stat> new_stats;
+
+    auto visit = [&](const std::filesystem::path &path) -> void {
+        if (const auto stat = stat_of(path)) {
+            new_stats.emplace(path, *stat);
+        }
+    };
+
+    std::error_code ec;
+    if (only) {
+        if (std::filesystem::is_regular_file(*only, ec)) {
+            visit(*only);
+        }
+    } else {
+        for (const auto &entry : std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, ec)) {
+            if (entry.is_regular_file(ec) && wanted(entry.path())) {
+                visit(entry.path());
+            }
+        }
+    }
+
+    if (report) {
+        const auto now = Clock::now();
+        for (const auto &[path, stat] : new_stats) {
+            const auto old = stats.find(path);
+            if (old == stats.end() || old->second.mtime != stat.mtime || old->second.size != stat.size) {
+                pending[path] = now;
+            }
+        }
+        for (const auto &[path, _] : stats) {
+            if (!new_stats.contains(path)) {
+                pending[path] = now;
+            }
+        }
+    }
+
+    stats = std::move(new_stats);
+}
+
+void FileWatcher::resync() {
+    scan(true);
+    // directories made while events were dropped aren't watched yet, the ones that are just keep their watch
+    add_watch(root, !only);
+}
+
+void FileWatcher::fall_back() {
+#ifdef __linux__
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif //__linux__
+    fd = -1;
+    watch_dirs.clear();
+    std::println(std::cerr, "could not watch {} for changes, polling every {} instead",
+        root.string(), poll_interval);
+    scan(false);
+    last_scan = Clock::now();
+}
+
+FileWatcher::FileWatcher(const std::filesystem::path &root, const std::chrono::milliseconds debounce)
+    : root(std::filesystem::absolute(root)), debounce(debounce) {
+    if (std::filesystem::is_regular_file(this->root)) {
+        only = this->root;
+        this->root = this->root.parent_path();
+    }
+
+    scan(false);
+    for (const auto &[path, _] : stats) {
+        known.insert(path);
+    }
+    last_scan = Clock::now();
+
+#ifdef __linux__
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd >= 0) {
+        add_watch(this->root, !only);
+    }
+#endif //__linux__
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif //__linux__
+}
+
+auto FileWatcher::poll() -> std::vector<Change> {
+    const auto now = Clock::now();
+    if (fd >= 0) {
+        read_events();
+    } else if (now - last_scan >= poll_interval) {
+        scan(true);
+        last_scan = now;
+    }
+
+    std::vector<Change> changes;
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (now - it->second < debounce) {
+            ++it;
+            continue;
+        }
+
+        std::error_code ec;
+        const auto &path = it->first;
+        const bool exists = std::filesystem::is_regular_file(path, ec);
+        const bool was_known = known.contains(path);
+
+        if (exists || was_known) { // otherwise it came and went within the debounce window
+            changes.push_back({.path=path, .added=exists && !was_known, .removed=!exists && was_known});
+            if (exists) {
+                known.insert(path);
+            } else {
+                known.erase(path);
+            }
+            if (fd >= 0) { // the polling scan keeps its stamps itself
+                if (const auto stat = stat_of(path)) {
+                    stats.insert_or_assign(path, *stat);
+                } else {
+                    stats.erase(path);
+                }
+            }
+        }
+
+        it = pending.erase(it);
+    }
+
+    return changes;
+}
+
+auto FileWatcher::using_inotify() const -> bool {
+    return fd >= 0;
+}
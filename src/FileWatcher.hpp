@@ -0,0 +1,82 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_FILEWATCHER_HPP
+#define RPY_PROJ_ANALYZER_FILEWATCHER_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Reports scripts that were edited, added or removed under a directory.
+ *
+ * Uses inotify where it's available and falls back to periodically stat-ing
+ * every script otherwise (or when inotify runs out of watches). Events for a
+ * path are held back until it has been quiet for `debounce`, so an editor
+ * saving in bursts produces one change.
+ */
+class FileWatcher {
+public:
+    struct Change {
+        std::filesystem::path path;
+        bool added = false;
+        bool removed = false;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stat {
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t size;
+    };
+
+    std::filesystem::path root;
+    std::optional<std::filesystem::path> only; // when watching a single script
+    std::chrono::milliseconds debounce;
+
+    std::unordered_set<std::filesystem::path> known;
+    std::unordered_map<std::filesystem::path, Clock::time_point> pending;
+
+    // inotify
+    int fd = -1;
+    std::unordered_map<int, std::filesystem::path> watch_dirs;
+
+    // polling fallback, and what an inotify queue overflow is checked against
+    static constexpr std::chrono::milliseconds poll_interval{1000};
+    Clock::time_point last_scan;
+    std::unordered_map<std::filesystem::path, Stat> stats;
+
+    static auto stat_of(const std::filesystem::path &path) -> std::optional<Stat>;
+    [[nodiscard]] auto wanted(const std::filesystem::path &path) const -> bool;
+    void add_watch(const std::filesystem::path &dir, bool recursive);
+    void read_events();
+    void scan(bool report);
+
+    /**
+     * @brief after inotify dropped events: reports what changed since the last stamps and watches any new directories.
+     */
+    void resync();
+    void fall_back();
+
+public:
+    explicit FileWatcher(const std::filesystem::path &root,
+                         std::chrono::milliseconds debounce = std::chrono::milliseconds(250));
+    FileWatcher(const FileWatcher&) = delete;
+    auto operator=(const FileWatcher&) -> FileWatcher& = delete;
+    ~FileWatcher();
+
+    /**
+     * @brief returns the changes that have settled since the last call. Meant to be called once per frame.
+     */
+    auto poll() -> std::vector<Change>;
+
+    [[nodiscard]] auto using_inotify() const -> bool;
+};
+
+#endif //RPY_PROJ_ANALYZER_FILEWATCHER_HPP
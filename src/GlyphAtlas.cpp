@@ -0,0 +1,323 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "GlyphAtlas.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <print>
+#include <rlgl.h>
+
+#include "AllocCounter.hpp"
+
+namespace {
+    // edges are where the distance crosses 0.5, smoothed over one pixel on screen whatever the scale
+    constexpr auto sdf_fs = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+out vec4 finalColor;
+
+void main() {
+    float dist = texture(texture0, fragTexCoord).a - 0.5;
+    float edge = length(vec2(dFdx(dist), dFdy(dist)));
+    float alpha = smoothstep(-edge, edge, dist);
+    finalColor = vec4(fragColor.rgb, fragColor.a * alpha);
+}
+)";
+
+    auto read_file(const std::filesystem::path &path) -> std::vector<unsigned char> {
+        std::ifstream in(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+
+    /**
+     * @brief one glyph rendered from a font file, freed with UnloadFontData.
+     */
+    auto rasterize(const std::vector<unsigned char> &file, int codepoint, const bool sdf) -> GlyphInfo* {
+        return LoadFontData(file.data(), static_cast<int>(file.size()), GlyphAtlas::base_size, &codepoint, 1,
+            sdf ? FONT_SDF : FONT_DEFAULT);
+    }
+}
+
+GlyphAtlas::GlyphAtlas(const std::array<std::filesystem::path, 4> &faces, const std::filesystem::path &fallback_dir) {
+    for (const auto &face : faces) {
+        files.push_back(read_file(face));
+        all_styles = all_styles && !files.back().empty();
+    }
+
+    std::error_code ec;
+    std::vector<std::filesystem::path> fallbacks;
+    for (const auto &entry : std::filesystem::directory_iterator(fallback_dir, ec)) {
+        const auto ext = entry.path().extension();
+        if (entry.is_regular_file(ec) && (ext == ".ttf" || ext == ".otf")) {
+            fallbacks.push_back(entry.path());
+        }
+    }
+    std::ranges::sort(fallbacks);
+    for (const auto &path : fallbacks) {
+        if (auto data = read_file(path); !data.empty()) {
+            files.push_back(std::move(data));
+        }
+    }
+
+    no_fonts = std::ranges::all_of(files, [](const auto &file) { return file.empty(); });
+
+    // raylib hands back its default shader if this one doesn't compile
+    sdf_shader = LoadShaderFromMemory(nullptr, sdf_fs);
+    sdf = sdf_shader.id != rlGetShaderIdDefault();
+    if (!sdf) {
+        std::println(std::cerr, "Could not compile the SDF text shader, text will blur when zoomed in.");
+    }
+}
+
+GlyphAtlas::~GlyphAtlas() {
+    for (const auto &page : pages) {
+        UnloadTexture(page.texture);
+    }
+    if (sdf) {
+        UnloadShader(sdf_shader);
+    }
+}
+
+auto GlyphAtlas::loaded() const -> bool {
+    return all_styles;
+}
+
+auto GlyphAtlas::key(const int codepoint, const std::uint8_t style) -> std::uint64_t {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(codepoint)) << 2) | (style & 0b11u);
+}
+
+auto GlyphAtlas::face_order(const std::uint8_t style) const -> std::vector<int> {
+    std::vector<int> order;
+    if (!files[style & 0b11u].empty()) {
+        order.push_back(style & 0b11);
+    }
+    // a style without its own font borrows the regular one
+    if ((style & 0b11u) != 0 && !files[0].empty()) {
+        order.push_back(0);
+    }
+    for (int i = 4; i < static_cast<int>(files.size()); ++i) {
+        order.push_back(i);
+    }
+    return order;
+}
+
+auto GlyphAtlas::find_metrics(const int codepoint, const std::uint8_t style) -> Metrics {
+    for (const int face : face_order(style)) {
+        auto *glyph = rasterize(files[face], codepoint, sdf);
+        if (glyph == nullptr) {
+            continue;
+        }
+        // raylib leaves glyphs the font doesn't have zeroed
+        const bool found = glyph->advanceX != 0 || glyph->image.data != nullptr;
+        const Metrics m{
+            .face=face,
+            .codepoint=codepoint,
+            .advance=static_cast<float>(glyph->advanceX),
+            .offset_x=glyph->offsetX,
+            .offset_y=glyph->offsetY,
+            .width=glyph->image.data != nullptr ? glyph->image.width : 0,
+            .height=glyph->image.data != nullptr ? glyph->image.height : 0,
+        };
+        UnloadFontData(glyph, 1);
+        if (found) {
+            return m;
+        }
+    }
+
+    if (codepoint != '?') {
+        return find_metrics('?', style);
+    }
+    return {};
+}
+
+auto GlyphAtlas::get_metrics(const int codepoint, const std::uint8_t style) -> Metrics {
+    const auto k = key(codepoint, style);
+    {
+        std::shared_lock lock(metrics_mtx);
+        if (const auto it = metrics.find(k); it != metrics.end()) {
+            return it->second;
+        }
+    }
+
+    const NoAllocGuard::Allow allow; // once per glyph
+    std::unique_lock lock(metrics_mtx);
+    if (const auto it = metrics.find(k); it != metrics.end()) {
+        return it->second; // another thread got there first
+    }
+    const auto m = find_metrics(codepoint, style);
+    metrics.emplace(k, m);
+    return m;
+}
+
+auto GlyphAtlas::advance(const int codepoint, const std::uint8_t style) -> float {
+    if (no_fonts) {
+        const Font font = GetFontDefault();
+        const auto idx = GetGlyphIndex(font, codepoint);
+        const float scale = static_cast<float>(base_size) / static_cast<float>(font.baseSize);
+        if (font.glyphs[idx].advanceX == 0) {
+            return font.recs[idx].width * scale;
+        }
+        return static_cast<float>(font.glyphs[idx].advanceX) * scale;
+    }
+    return get_metrics(codepoint, style).advance;
+}
+
+auto GlyphAtlas::place(const int width, const int height) -> std::pair<std::uint32_t, raylib::Vector2> {
+    auto fit = [&](Page &page) -> std::optional<raylib::Vector2> {
+        if (page.shelf_x + width > page_size) {
+            page.shelf_x = 0;
+            page.shelf_y += page.shelf_height;
+            page.shelf_height = 0;
+        }
+        if (page.shelf_y + height > page_size) {
+            return std::nullopt;
+        }
+        const raylib::Vector2 at{static_cast<float>(page.shelf_x), static_cast<float>(page.shelf_y)};
+        page.shelf_x += width;
+        page.shelf_height = std::max(page.shelf_height, height);
+        return at;
+    };
+
+    // only the page filled last can have room, the others were full when it was picked
+    if (!pages.empty()) {
+        if (const auto at = fit(pages[current])) {
+            return {current, *at};
+        }
+    }
+
+    if (pages.size() < max_pages) {
+        Image blank = GenImageColor(page_size, page_size, {0xFF, 0xFF, 0xFF, 0x00});
+        ImageFormat(&blank, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+        Page page{.texture=LoadTextureFromImage(blank)};
+        UnloadImage(blank);
+        SetTextureFilter(page.texture, TEXTURE_FILTER_BILINEAR);
+        pages.push_back(page);
+        current = static_cast<std::uint32_t>(pages.size() - 1);
+    } else {
+        current = static_cast<std::uint32_t>(std::ranges::min_element(pages, {}, &Page::last_used) - pages.begin());
+        // glyphs from this page may still be queued or waiting in raylib's batch, draw them before overwriting it
+        flush();
+        rlDrawRenderBatchActive();
+        std::erase_if(slots, [&](const auto &slot) { return slot.second.page == current; });
+        pages[current].shelf_x = 0;
+        pages[current].shelf_y = 0;
+        pages[current].shelf_height = 0;
+    }
+
+    // a glyph at base_size is always far smaller than an empty page
+    return {current, *fit(pages[current])};
+}
+
+auto GlyphAtlas::upload(const Metrics &m) -> Slot {
+    const int width = m.width + (2 * padding);
+    const int height = m.height + (2 * padding);
+    const auto [page, at] = place(width, height);
+
+    // white everywhere, the distance (or coverage) goes in alpha so the tint colours it
+    upload_buf.resize(static_cast<std::size_t>(width * height * 2));
+    for (std::size_t i = 0; i < upload_buf.size(); i += 2) {
+        upload_buf[i] = 0xFF;
+        upload_buf[i + 1] = 0x00;
+    }
+
+    if (auto *glyph = rasterize(files[m.face], m.codepoint, sdf)) {
+        if (glyph->image.data != nullptr) {
+            const auto *coverage = static_cast<const unsigned char*>(glyph->image.data);
+            for (int y = 0; y < m.height; ++y) {
+                for (int x = 0; x < m.width; ++x) {
+                    upload_buf[(((y + padding) * width) + x + padding) * 2 + 1] = coverage[(y * m.width) + x];
+                }
+            }
+        }
+        UnloadFontData(glyph, 1);
+    }
+
+    UpdateTextureRec(pages[page].texture,
+        {at.x, at.y, static_cast<float>(width), static_cast<float>(height)}, upload_buf.data());
+
+    return {.page=page, .src={at.x + padding, at.y + padding, static_cast<float>(m.width), static_cast<float>(m.height)}};
+}
+
+void GlyphAtlas::queue(const int codepoint, const std::uint8_t style, const raylib::Vector2 pos, const float size,
+                      const raylib::Color tint) {
+    if (no_fonts) {
+        DrawTextCodepoint(GetFontDefault(), codepoint, pos, size, tint);
+        return;
+    }
+
+    const auto m = get_metrics(codepoint, style);
+    if (m.face < 0 || m.width == 0 || m.height == 0) {
+        return;
+    }
+
+    const auto k = key(m.codepoint, style);
+    auto it = slots.find(k);
+    if (it == slots.end()) {
+        const NoAllocGuard::Allow allow; // once per glyph, until its page gets reused
+        it = slots.emplace(k, upload(m)).first;
+    }
+
+    const auto &[page, src] = it->second;
+    pages[page].last_used = ++uses;
+
+    if (queued.size() == queued.capacity()) {
+        const NoAllocGuard::Allow allow; // only until the queue is as big as the busiest frame
+        queued.reserve(std::max<std::size_t>(1024, queued.capacity() * 2));
+    }
+
+    const float scale = size / static_cast<float>(base_size);
+    queued.push_back({
+        .page=page,
+        .src=src,
+        .dst={
+            pos.x + (static_cast<float>(m.offset_x) * scale),
+            pos.y + (static_cast<float>(m.offset_y) * scale),
+            src.width * scale,
+            src.height * scale,
+        },
+        .tint=tint,
+    });
+}
+
+void GlyphAtlas::flush() {
+    if (queued.empty()) {
+        return;
+    }
+
+    if (sdf) {
+        BeginShaderMode(sdf_shader);
+    }
+    // a page at a time, so raylib only has to switch textures once per page
+    for (std::uint32_t page = 0; page < pages.size(); ++page) {
+        for (const auto &quad : queued) {
+            if (quad.page == page) {
+                DrawTexturePro(pages[page].texture, quad.src, quad.dst, {0.0f, 0.0f}, 0.0f, quad.tint);
+            }
+        }
+    }
+    if (sdf) {
+        EndShaderMode();
+    }
+
+    queued.clear();
+}
+
+auto GlyphAtlas::uses_sdf() const -> bool {
+    return sdf;
+}
+
+auto GlyphAtlas::n_pages() const -> std::size_t {
+    return pages.size();
+}
+
+auto GlyphAtlas::n_glyphs() const -> std::size_t {
+    std::shared_lock lock(metrics_mtx);
+    return metrics.size();
+}
@@ -0,0 +1,139 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_GLYPHATLAS_HPP
+#define RPY_PROJ_ANALYZER_GLYPHATLAS_HPP
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "raylib-cpp.hpp"
+
+/**
+ * @brief Rasterizes glyphs the first time they are needed, from any codepoint the fonts have.
+ *
+ * Each style (regular, bold, italic, bold italic) has its own font file, and
+ * every font in the fallback directory is tried in name order for
+ * codepoints the style's font doesn't have. Codepoints no font has are
+ * drawn as '?'.
+ *
+ * Metrics are kept for every glyph seen, and can be looked up from any
+ * thread. Bitmaps only live on the GPU, in atlas pages of `page_size`
+ * squared that are filled on the main thread as glyphs get drawn. Once
+ * `max_pages` are full, the least recently drawn page is cleared for reuse
+ * and its glyphs are rasterized again when they next show up.
+ *
+ * Glyphs are stored as signed distance fields and drawn with a shader that
+ * keeps their edges sharp at any scale, so one page serves every zoom level.
+ * Where the shader doesn't compile, plain coverage bitmaps are used instead.
+ * Glyphs are queued rather than drawn right away, and `flush` draws them a
+ * page at a time, which raylib batches into one draw call per page.
+ */
+class GlyphAtlas {
+public:
+    static constexpr int base_size = 64; // glyphs are rasterized at this size and scaled when drawn
+    static constexpr int page_size = 1024;
+    static constexpr std::size_t max_pages = 4;
+
+    /**
+     * @param faces font files for regular, bold, italic and bold italic, indexed like TextHelper's style bits
+     * @warning Must be constructed after raylib has been initialized.
+     */
+    GlyphAtlas(const std::array<std::filesystem::path, 4> &faces, const std::filesystem::path &fallback_dir);
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    auto operator=(const GlyphAtlas&) -> GlyphAtlas& = delete;
+    ~GlyphAtlas();
+
+    /**
+     * @brief whether every style's font could be read. Otherwise raylib's default font is used.
+     */
+    [[nodiscard]] auto loaded() const -> bool;
+
+    /**
+     * @brief horizontal advance at `base_size`. Safe to call from any thread.
+     */
+    [[nodiscard]] auto advance(int codepoint, std::uint8_t style) -> float;
+
+    /**
+     * @brief queues a glyph with its top left at `pos`, scaled to `size`. Main thread only.
+     */
+    void queue(int codepoint, std::uint8_t style, raylib::Vector2 pos, float size, raylib::Color tint);
+
+    /**
+     * @brief draws every queued glyph, with whatever camera, scissor and render target are active now.
+     */
+    void flush();
+
+    [[nodiscard]] auto uses_sdf() const -> bool;
+
+    [[nodiscard]] auto n_pages() const -> std::size_t;
+    [[nodiscard]] auto n_glyphs() const -> std::size_t;
+
+private:
+    static constexpr int padding = 1; // blank border, so bilinear filtering doesn't bleed in neighbours
+
+    struct Metrics {
+        int face = -1;     // index into `files`, -1 for a glyph with nothing to draw
+        int codepoint = 0; // what is drawn, which is '?' for codepoints no font has
+        float advance = 0.0f;
+        int offset_x = 0;
+        int offset_y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    struct Slot {
+        std::uint32_t page;
+        raylib::Rectangle src;
+    };
+
+    // simple shelf packing: glyphs go left to right on the current shelf, then a new shelf starts below
+    struct Page {
+        Texture2D texture{};
+        int shelf_x = 0;
+        int shelf_y = 0;
+        int shelf_height = 0;
+        std::uint64_t last_used = 0;
+    };
+
+    struct Quad {
+        std::uint32_t page;
+        raylib::Rectangle src;
+        raylib::Rectangle dst;
+        raylib::Color tint;
+    };
+
+    std::vector<std::vector<unsigned char>> files; // one per style, then the fallbacks
+    bool all_styles = true;
+    bool no_fonts = false; // not one font could be read, draw with raylib's default font
+    Shader sdf_shader{};
+    bool sdf = false;
+
+    mutable std::shared_mutex metrics_mtx;
+    std::unordered_map<std::uint64_t, Metrics> metrics;
+
+    // main thread only from here on
+    std::unordered_map<std::uint64_t, Slot> slots;
+    std::vector<Page> pages;
+    std::uint32_t current = 0; // the page new glyphs go on
+    std::uint64_t uses = 0;
+    std::vector<unsigned char> upload_buf;
+    std::vector<Quad> queued;
+
+    static auto key(int codepoint, std::uint8_t style) -> std::uint64_t;
+
+    auto find_metrics(int codepoint, std::uint8_t style) -> Metrics;
+    auto get_metrics(int codepoint, std::uint8_t style) -> Metrics;
+    auto face_order(std::uint8_t style) const -> std::vector<int>;
+
+    auto place(int width, int height) -> std::pair<std::uint32_t, raylib::Vector2>;
+    auto upload(const Metrics &m) -> Slot;
+};
+
+#endif //RPY_PROJ_ANALYZER_GLYPHATLAS_HPP
@@ -8,6 +8,7 @@
 #include <format>
 #include <unordered_map>
 
+#include "Profiler.hpp"
 #include "Typing.hpp"
 
 void Graph::connect_ancestors() const {
@@ -129,7 +130,7 @@ auto Graph::add_show_node(const Tok& tok, bool& has_atl, bool is_scene) -> std::
         name = char_name->name;
     } else {
         errors.push_back(std::move(char_name.error()));
-        std::println(std::cerr, "{}", errors.back());
+        Log::error("{}", errors.back());
         return nullptr;
     }
 
@@ -144,7 +145,7 @@ auto Graph::add_show_node(const Tok& tok, bool& has_atl, bool is_scene) -> std::
             props.as = as_ident->name;
         } else {
             errors.push_back(std::move(as_ident.error()));
-            std::println(std::cerr, "{}", errors.back());
+            Log::error("{}", errors.back());
             return nullptr;
         }
     }
@@ -157,13 +158,13 @@ auto Graph::add_show_node(const Tok& tok, bool& has_atl, bool is_scene) -> std::
                     props.transforms.push_back(next_tf->name);
                 } else {
                     errors.push_back(std::move(next_tf.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                     return nullptr;
                 }
             }
         } else {
             errors.push_back(std::move(tf_tok.error()));
-            std::println(std::cerr, "{}", errors.back());
+            Log::error("{}", errors.back());
             return nullptr;
         }
     }
@@ -173,7 +174,7 @@ auto Graph::add_show_node(const Tok& tok, bool& has_atl, bool is_scene) -> std::
             props.behind = behind_list->name;
         } else {
             errors.push_back(std::move(behind_list.error()));
-            std::println(std::cerr, "{}", errors.back());
+            Log::error("{}", errors.back());
             return nullptr;
         }
     }
@@ -183,7 +184,7 @@ auto Graph::add_show_node(const Tok& tok, bool& has_atl, bool is_scene) -> std::
             props.onlayer = layer->name;
         } else {
             errors.push_back(std::move(layer.error()));
-            std::println(std::cerr, "{}", errors.back());
+            Log::error("{}", errors.back());
             return nullptr;
         }
     }
@@ -193,7 +194,7 @@ auto Graph::add_show_node(const Tok& tok, bool& has_atl, bool is_scene) -> std::
             props.zorder = zorder->value;
         } else {
             errors.push_back(std::move(zorder.error()));
-            std::println(std::cerr, "{}", errors.back());
+            Log::error("{}", errors.back());
             return nullptr;
         }
     }
@@ -215,7 +216,8 @@ auto Graph::add_show_node(const Tok& tok, bool& has_atl, bool is_scene) -> std::
     return std::make_unique<NodeShow>(tok, name, attrs, props, is_scene);
 }
 
-void Graph::generate_nodes() {
+void Graph::generate_nodes(const bool link_nodes) {
+    const Profiler::Scope scope("generate_nodes");
     while (lexer.has_more()) {
         const auto& token = lexer.curr();
         std::visit(Overload {
@@ -226,7 +228,7 @@ void Graph::generate_nodes() {
                     nodes_w_expr.push_back(nodes.back().get());
                 } else {
                     errors.push_back(std::move(slice.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokShow& t) {
@@ -257,7 +259,7 @@ void Graph::generate_nodes() {
                     name = char_name->name;
                 } else {
                     errors.push_back(std::move(char_name.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                     return;
                 }
 
@@ -266,7 +268,7 @@ void Graph::generate_nodes() {
                         onlayer = layer->name;
                     } else {
                         errors.push_back(std::move(layer.error()));
-                        std::println(std::cerr, "{}", errors.back()) ;
+                        Log::error("{}", errors.back()) ;
                         return;
                     }
                 }
@@ -286,7 +288,7 @@ void Graph::generate_nodes() {
                     nodes.push_back(std::make_unique<NodeWith>(t, *slice));
                 } else {
                     errors.push_back(lexer.multi_tok_error<TokATLTransition>({"valid expression"}));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokMenu& t) {
@@ -295,7 +297,7 @@ void Graph::generate_nodes() {
                 std::optional<std::string> text;
                 if (auto colon = lexer.expect<TokColon>(); !colon) {
                     errors.push_back(std::move(colon.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                     return;
                 }
 
@@ -312,7 +314,7 @@ void Graph::generate_nodes() {
                         }
                     } else {
                         errors.push_back(std::move(ident.error()));
-                        std::println(std::cerr, "{}", errors.back());
+                        Log::error("{}", errors.back());
                         return;
                     }
                 }
@@ -333,12 +335,12 @@ void Graph::generate_nodes() {
                             choice = std::make_unique<NodeChoice>(*if_tok, str_tok->text, *slice);
                         } else {
                             errors.push_back(std::move(slice.error()));
-                            std::println(std::cerr, "{}", errors.back());
+                            Log::error("{}", errors.back());
                             return;
                         }
                     } else {
                         errors.push_back(lexer.multi_tok_error<TokColon, TokIf, TokNewline>());
-                        std::println(std::cerr, "{}", errors.back());
+                        Log::error("{}", errors.back());
                         return;
                     }
                 }
@@ -353,13 +355,13 @@ void Graph::generate_nodes() {
                 auto ident = lexer.expect<TokIdent>();
                 if (!ident) {
                     errors.push_back(std::move(ident.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                     return;
                 }
 
                 if (auto colon = lexer.expect<TokColon>(); !colon) {
                     errors.push_back(std::move(colon.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                     return;
                 }
                 nodes.push_back(std::make_unique<NodeLabel>(t, ident->name));
@@ -370,7 +372,7 @@ void Graph::generate_nodes() {
                     nodes.push_back(std::make_unique<NodeDialogue>(t, t.name, str_lit->text));
                 } else {
                     errors.push_back(std::move(str_lit.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokStrLit &t) {
@@ -389,13 +391,13 @@ void Graph::generate_nodes() {
                         nodes.push_back(std::make_unique<NodeChoice>(*if_tok, t.text, *slice));
                     } else {
                         errors.push_back(std::move(slice.error()));
-                        std::println(std::cerr, "{}", errors.back());
+                        Log::error("{}", errors.back());
                     }
                 } else if (lexer.curr_is<TokNewline>()) {
                     nodes.push_back(std::make_unique<NodeDialogue>(t, t.text));
                 } else {
                     errors.push_back(lexer.multi_tok_error<TokColon, TokIf, TokNewline>());
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokDefault &t) {
@@ -411,7 +413,7 @@ void Graph::generate_nodes() {
                     }
                 } else {
                     errors.push_back(std::move(slice.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokDefine &t) {
@@ -426,7 +428,7 @@ void Graph::generate_nodes() {
                     }
                 } else {
                     errors.push_back(std::move(slice.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokPlay& t) {
@@ -438,14 +440,14 @@ void Graph::generate_nodes() {
                     channel = AudioChannel::Sfx;
                 } else {
                     errors.push_back(lexer.multi_tok_error<TokMusic, TokSfx>());
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
 
                 if (auto path = lexer.expect<TokStrLit>()) {
                     nodes.push_back(std::make_unique<NodePlay>(t, channel, path->text));
                 } else {
                     errors.push_back(std::move(path.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokIf& t) {
@@ -466,7 +468,7 @@ void Graph::generate_nodes() {
                     nodes.push_back(std::make_unique<NodeElse>(t));
                 } else {
                     errors.push_back(std::move(colon.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokWhile& t) {
@@ -494,16 +496,16 @@ void Graph::generate_nodes() {
                     nodes.push_back(std::make_unique<NodeCall>(t, ident->name));
                 } else {
                     errors.push_back(std::move(ident.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokJump& t) {
                 ++lexer;
                 if (auto ident = lexer.expect<TokIdent>()) {
-                    nodes.push_back(std::make_unique<NodeCall>(t, ident->name));
+                    nodes.push_back(std::make_unique<NodeJump>(t, ident->name));
                 } else {
                     errors.push_back(std::move(ident.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                 }
             },
             [&](const TokImage &t) {
@@ -512,7 +514,7 @@ void Graph::generate_nodes() {
                 auto name = lexer.expect<TokIdent>();
                 if (!name) {
                     errors.push_back(std::move(name.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                     return;
                 }
 
@@ -520,7 +522,7 @@ void Graph::generate_nodes() {
                     auto attr = lexer.expect<TokIdent>();
                     if (!attr) {
                         errors.push_back(std::move(attr.error()));
-                        std::println(std::cerr, "{}", errors.back());
+                        Log::error("{}", errors.back());
                         return;
                     }
                     attrs.push_back(attr->name);
@@ -529,14 +531,14 @@ void Graph::generate_nodes() {
                 auto assign = lexer.expect<TokOp>();
                 if (!assign || assign->type != OpType::Assign) {
                     errors.push_back(std::move(assign.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                     return;
                 }
 
                 auto file_path = lexer.expect<TokStrLit>();
                 if (!file_path) {
                     errors.push_back(std::move(file_path.error()));
-                    std::println(std::cerr, "{}", errors.back());
+                    Log::error("{}", errors.back());
                     return;
                 }
                 nodes.push_back(std::make_unique<NodeImage>(t, name->name, std::move(attrs), file_path->text));
@@ -550,7 +552,7 @@ void Graph::generate_nodes() {
                 static_assert(std::is_base_of_v<Tok, To>, "expected derived from base Tok");
                 std::string msg = std::format("unexpected token {} at {}", tok_name<To>(), tok_pos(other));
                 errors.push_back(msg);
-                std::println(std::cerr, "{}", msg);
+                Log::error("{}", msg);
             },
         }, token);
         ++lexer;
@@ -562,29 +564,30 @@ void Graph::generate_nodes() {
         }
     }
 
-    std::println("--------------------");
+    Log::info("--------------------");
     if (errors.empty()) {
-        std::println("parsing script OK!");
-        connect_ancestors();
-        connect_nexts();
+        Log::info("parsing script OK!");
+        if (link_nodes) {
+            link();
+        }
         // auto wc = find_highest_wc_path();
         // std::println("max wc: {}", wc);
     } else {
-        std::println(std::cerr, "Parsing script encountered {} error(s):", errors.size());
+        Log::error("Parsing script encountered {} error(s):", errors.size());
         for (const auto& error : errors) {
-            std::println(std::cerr, "\t{}", error);
+            Log::error("\t{}", error);
         }
     }
-    std::println("--------------------");
+    Log::info("--------------------");
     if (nodes_w_atl.empty()) {
-        std::println("no nodes with ATL.");
+        Log::info("no nodes with ATL.");
     } else {
         for (const auto &n : nodes_w_atl) {
-            std::println("{:p}", *n);
+            Log::info("{:p}", *n);
         }
     }
     if (nodes_w_expr.empty()) {
-        std::println("no nodes with expr.");
+        Log::info("no nodes with expr.");
     } else {
         for (const auto &n : nodes) {
             if (dynamic_cast<NodeExpr*>(n.get())) {
@@ -592,13 +595,16 @@ void Graph::generate_nodes() {
             }
         }
     }
-    std::println("--------------------");
+    Log::info("--------------------");
     int total_wc = 0;
-    dfs<TrvOrd::Pre>([&](const Node &n) {
-        if (auto dialogue = dynamic_cast<const NodeDialogue*>(&n)) {
-            total_wc += dialogue->word_count;
-        }
-    });
+    {
+        const Profiler::Scope wc_scope("word_count");
+        dfs<TrvOrd::Pre>([&](const Node &n) {
+            if (auto dialogue = dynamic_cast<const NodeDialogue*>(&n)) {
+                total_wc += dialogue->word_count;
+            }
+        });
+    }
 
     // std::vector<std::set<const Node*>> groups;
     // std::set<const Node*> visits;
@@ -626,8 +632,8 @@ void Graph::generate_nodes() {
     //     }
     //     std::println("");
     // }
-    std::println("total word count: {}", total_wc);
-    std::println("--------------------");
+    Log::info("total word count: {}", total_wc);
+    Log::info("--------------------");
 }
 
 auto Graph::find_highest_wc_path() const -> int {
@@ -754,14 +760,49 @@ Graph::Graph(const std::filesystem::path& path)
     generate_nodes();
 }
 
+Graph::Graph(std::vector<Token> tokens, const bool link_nodes)
+    : lexer(std::move(tokens)) {
+    generate_nodes(link_nodes);
+}
+
 auto Graph::get_nodes() -> std::vector<std::unique_ptr<Node>>& {
     return nodes;
 }
 
+auto Graph::get_nodes() const -> const std::vector<std::unique_ptr<Node>>& {
+    return nodes;
+}
+
 auto Graph::get_roots() -> std::vector<unsigned>& {
     return roots;
 }
 
+auto Graph::get_tokens() const -> const std::vector<Token>& {
+    return lexer.get_tokens();
+}
+
+auto Graph::get_errors() const -> const std::vector<std::string>& {
+    return errors;
+}
+
+void Graph::link() const {
+    const Profiler::Scope scope("link");
+    connect_ancestors();
+    connect_nexts();
+}
+
+auto Graph::resident_bytes() const -> std::size_t {
+    // nodes differ wildly in size, so this just assumes an average one plus its strings
+    constexpr std::size_t avg_node_bytes = 160;
+    return sizeof(Graph)
+        + lexer.resident_bytes()
+        + (tokens.capacity() * sizeof(Token))
+        + (nodes.capacity() * sizeof(std::unique_ptr<Node>))
+        + (nodes.size() * avg_node_bytes)
+        + ((nodes_w_expr.capacity() + nodes_w_atl.capacity()) * sizeof(Node*))
+        + (roots.capacity() * sizeof(unsigned));
+}
+
 void Graph::print_all_nodes() const {
     for (const auto &n : nodes) {
         std::println("{}", *n);
@@ -6,6 +6,7 @@
 #define RPY_PROJ_ANALYZER_GRAPH_HPP
 
 #include "Lexer.hpp"
+#include "Log.hpp"
 #include "Node.hpp"
 #include "Token.hpp"
 
@@ -57,13 +58,14 @@ class Graph {
             return std::make_unique<T>(tok, *expr);
         }
 
-        std::println(std::cerr, "{}", expr.error());
+        errors.push_back(expr ? lexer.multi_tok_error<TokColon>() : expr.error());
+        Log::error("{}", errors.back());
         return nullptr;
     }
 
     [[nodiscard]] auto add_show_node(const Tok& tok, bool& has_atl, bool is_scene = false) -> std::unique_ptr<NodeShow>;
 
-    void generate_nodes();
+    void generate_nodes(bool link_nodes = true);
 
     enum class TrvOrd : std::uint8_t {
         Pre,
@@ -116,11 +118,37 @@ class Graph {
 public:
     explicit Graph(const std::filesystem::path &path);
 
+    /**
+     * @brief parses already lexed tokens.
+     *
+     * @param link_nodes whether to work out parent / next / child links. The
+     * parse cache passes false since it restores those from its node table.
+     */
+    explicit Graph(std::vector<Token> tokens, bool link_nodes = true);
+
     auto get_nodes() -> std::vector<std::unique_ptr<Node>>&;
+    [[nodiscard]] auto get_nodes() const -> const std::vector<std::unique_ptr<Node>>&;
 
     auto get_roots() -> std::vector<unsigned>&;
 
+    [[nodiscard]] auto get_tokens() const -> const std::vector<Token>&;
+
+    /**
+     * @brief every syntax error found while parsing, in the order they were hit.
+     */
+    [[nodiscard]] auto get_errors() const -> const std::vector<std::string>&;
+
+    /**
+     * @brief works out the parent / next / child links of a graph built with `link_nodes = false`.
+     */
+    void link() const;
+
     void print_all_nodes() const;
+
+    /**
+     * @brief rough estimate of the heap memory held by this graph, for cache budgeting.
+     */
+    [[nodiscard]] auto resident_bytes() const -> std::size_t;
 };
 
 
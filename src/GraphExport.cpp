@@ -0,0 +1,348 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "GraphExport.hpp"
+
+#include <cassert>
+#include <deque>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <print>
+#include <unordered_map>
+#include <utility>
+
+#include "Batch.hpp"
+#include "BufferedWriter.hpp"
+#include "DirTree.hpp"
+#include "Json.hpp"
+#include "Node.hpp"
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+    constexpr int json_version = 1;
+
+    using Jumps = std::vector<std::pair<unsigned, std::string>>; // node id and the label it goes to
+    using LabelIds = std::unordered_map<std::string, unsigned>;
+
+    template<typename... Ts>
+    auto is_any(const Node &node) -> bool {
+        return ((dynamic_cast<const Ts*>(&node) != nullptr) || ...);
+    }
+
+    auto kind_name(const std::uint8_t kind) -> std::string_view {
+        return kind < Batch::kind_names.size() ? Batch::kind_names[kind] : "unknown";
+    }
+
+    /**
+     * @brief writes `str` escaped for the inside of a quoted DOT string.
+     */
+    void write_dot_escaped(BufferedWriter &out, const std::string_view str) {
+        for (const char c : str) {
+            if (c == '"' || c == '\\') {
+                out.put('\\');
+            }
+            out.put(c == '\n' || c == '\r' ? ' ' : c);
+        }
+    }
+
+    void write_dot_string(BufferedWriter &out, const std::string_view str) {
+        out.put('"');
+        write_dot_escaped(out, str);
+        out.put('"');
+    }
+
+    auto dot_style(const GraphExport::EdgeType type) -> std::string_view {
+        switch (type) {
+            using enum GraphExport::EdgeType;
+            case Next: return "";
+            case Child: return " style=dashed";
+            case Branch: return " style=bold";
+            case Jump: return " style=dashed color=blue constraint=false";
+        }
+        return "";
+    }
+
+    void write_begin(BufferedWriter &out, const GraphExport::Format format, const std::filesystem::path &root) {
+        if (format == GraphExport::Format::DOT) {
+            out.write("digraph ");
+            write_dot_string(out, root.string());
+            out.write(" {\n  node [shape=box fontname=\"monospace\"];\n");
+            return;
+        }
+
+        out.print(R"({{"version":{},"root":)", json_version);
+        Json::write_string_to(out.iter(), root.string());
+        out.write(R"(,"kinds":[)");
+        for (std::size_t i = 0; i < Batch::kind_names.size(); ++i) {
+            out.print(R"({}"{}")", i == 0 ? "" : ",", Batch::kind_names[i]);
+        }
+        out.write(R"(],"edge_types":[)");
+        for (std::size_t i = 0; i < GraphExport::edge_names.size(); ++i) {
+            out.print(R"({}"{}")", i == 0 ? "" : ",", GraphExport::edge_names[i]);
+        }
+        out.write("],\"files\":[\n");
+    }
+
+    void write_dot_file(BufferedWriter &out, const GraphExport::FileGraph &file, const unsigned idx, const unsigned first) {
+        out.print("  subgraph \"cluster_{}\" {{\n    label=", idx);
+        write_dot_string(out, file.path.string());
+        out.write(";\n");
+        for (const auto &error : file.errors) {
+            out.write("    // error: ");
+            for (const char c : error) {
+                out.put(c == '\n' || c == '\r' ? ' ' : c);
+            }
+            out.put('\n');
+        }
+
+        for (unsigned i = 0; i < file.nodes.size(); ++i) {
+            const auto &node = file.nodes[i];
+            const auto *label = node.label == GraphExport::NONE ? nullptr : &file.labels[node.label];
+
+            out.print("    n{} [label=\"{}", first + i, kind_name(node.kind));
+            if (label != nullptr && label->node == i) {
+                out.put(' ');
+                write_dot_escaped(out, label->name);
+            }
+            out.print("\\nline {}", node.line);
+            if (node.words > 0) {
+                out.print(", {} words", node.words);
+            }
+            out.print("\" kind={} line={} words={}", kind_name(node.kind), node.line, node.words);
+            if (label != nullptr) {
+                out.write(" in_label=");
+                write_dot_string(out, label->name);
+            }
+            out.write("];\n");
+        }
+
+        for (const auto &[from, to, type] : file.edges) {
+            out.print("    n{} -> n{} [type={}{}];\n", first + from, first + to,
+                GraphExport::edge_names[static_cast<std::size_t>(type)], dot_style(type));
+        }
+        out.write("  }\n");
+    }
+
+    void write_json_file(BufferedWriter &out, const GraphExport::FileGraph &file, const unsigned idx, const unsigned first) {
+        out.write(idx == 0 ? R"({"path":)" : ",\n{\"path\":");
+        Json::write_string_to(out.iter(), file.path.string());
+        out.print(R"(,"first":{},"labels":[)", first);
+        for (std::size_t i = 0; i < file.labels.size(); ++i) {
+            out.write(i == 0 ? "[" : ",[");
+            Json::write_string_to(out.iter(), file.labels[i].name);
+            out.print(",{}]", first + file.labels[i].node);
+        }
+
+        // [kind, line, label, words], each node's id is `first` plus its place in the list
+        out.write(R"(],"nodes":[)");
+        for (std::size_t i = 0; i < file.nodes.size(); ++i) {
+            const auto &node = file.nodes[i];
+            out.print("{}[{},{},{},{}]", i == 0 ? "" : ",", node.kind, node.line,
+                node.label == GraphExport::NONE ? -1 : static_cast<long long>(node.label), node.words);
+        }
+
+        out.write(R"(],"edges":[)");
+        for (std::size_t i = 0; i < file.edges.size(); ++i) {
+            const auto &[from, to, type] = file.edges[i];
+            out.print("{}[{},{},{}]", i == 0 ? "" : ",", first + from, first + to, static_cast<int>(type));
+        }
+
+        out.write(R"(],"errors":[)");
+        for (std::size_t i = 0; i < file.errors.size(); ++i) {
+            if (i != 0) {
+                out.put(',');
+            }
+            Json::write_string_to(out.iter(), file.errors[i]);
+        }
+        out.write("]}");
+    }
+
+    void write_end(BufferedWriter &out, const GraphExport::Format format, const LabelIds &label_ids, const Jumps &jumps) {
+        if (format == GraphExport::Format::DOT) {
+            for (const auto &[from, target] : jumps) {
+                if (const auto it = label_ids.find(target); it != label_ids.end()) {
+                    out.print("  n{} -> n{} [type=jump{}];\n", from, it->second, dot_style(GraphExport::EdgeType::Jump));
+                } else {
+                    out.print("  // n{} goes to ", from);
+                    write_dot_escaped(out, target);
+                    out.write(", which no script defines\n");
+                }
+            }
+            out.write("}\n");
+            return;
+        }
+
+        out.write("\n],\"jumps\":[");
+        bool first = true;
+        for (const auto &[from, target] : jumps) {
+            if (const auto it = label_ids.find(target); it != label_ids.end()) {
+                out.print("{}[{},{}]", first ? "" : ",", from, it->second);
+                first = false;
+            }
+        }
+        out.write(R"(],"unresolved":[)");
+        first = true;
+        for (const auto &[from, target] : jumps) {
+            if (!label_ids.contains(target)) {
+                out.print("{}[{},", first ? "" : ",", from);
+                Json::write_string_to(out.iter(), target);
+                out.put(']');
+                first = false;
+            }
+        }
+        out.write("]}\n");
+    }
+}
+
+auto GraphExport::format_of(const std::filesystem::path &path) -> std::optional<Format> {
+    const auto ext = path.extension();
+    if (ext == ".dot" || ext == ".gv") {
+        return Format::DOT;
+    }
+    if (ext == ".json") {
+        return Format::JSON;
+    }
+    if (ext == ".rpyg") {
+        return Format::Binary;
+    }
+    return std::nullopt;
+}
+
+auto GraphExport::collect(const std::filesystem::path &script, const Graph &graph) -> FileGraph {
+    FileGraph file{.path=script, .nodes={}, .edges={}, .labels={}, .jumps={}, .errors=graph.get_errors()};
+    const auto &nodes = graph.get_nodes();
+    file.nodes.reserve(nodes.size());
+
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+        const Node &node = *nodes[i];
+        NodeInfo info{
+            .kind=static_cast<std::uint8_t>(Batch::kind_of(node).value_or(Batch::kind_names.size())),
+            .line=node.line_and_col().first,
+            .label=NONE,
+            .words=0,
+        };
+
+        // parents come before their children, so the parent's label is already known
+        if (const auto *label = dynamic_cast<const NodeLabel*>(&node)) {
+            info.label = static_cast<unsigned>(file.labels.size());
+            file.labels.push_back({.name=label->get_name(), .node=i});
+        } else if (node.parent) {
+            info.label = file.nodes[*node.parent].label;
+        }
+
+        if (const auto *dialogue = dynamic_cast<const NodeDialogue*>(&node)) {
+            info.words = static_cast<unsigned>(dialogue->word_count);
+        } else if (const auto *jump = dynamic_cast<const NodeJump*>(&node)) {
+            file.jumps.push_back({.node=i, .target=jump->get_label()});
+        } else if (const auto *call = dynamic_cast<const NodeCall*>(&node)) {
+            file.jumps.push_back({.node=i, .target=call->get_label()});
+        }
+        file.nodes.push_back(info);
+
+        // a choice, elif or else doesn't run after the one before it, it's a branch of the menu or if
+        if (node.next && !is_any<NodeChoice, NodeElif, NodeElse>(*nodes[*node.next])) {
+            file.edges.push_back({.from=i, .to=*node.next, .type=EdgeType::Next});
+        }
+
+        if (const auto *parent = dynamic_cast<const NodeParent*>(&node); parent != nullptr && parent->first_child) {
+            if (is_any<NodeMenu>(node)) {
+                for (auto child = parent->first_child; child; child = nodes[*child]->next) {
+                    if (is_any<NodeChoice>(*nodes[*child])) {
+                        file.edges.push_back({.from=i, .to=*child, .type=EdgeType::Branch});
+                    } else if (child == parent->first_child) {
+                        file.edges.push_back({.from=i, .to=*child, .type=EdgeType::Child}); // the caption
+                    }
+                }
+            } else {
+                file.edges.push_back({.from=i, .to=*parent->first_child, .type=EdgeType::Child});
+            }
+        }
+
+        if (is_any<NodeIf>(node)) {
+            for (auto arm = node.next; arm && is_any<NodeElif, NodeElse>(*nodes[*arm]); arm = nodes[*arm]->next) {
+                file.edges.push_back({.from=i, .to=*arm, .type=EdgeType::Branch});
+            }
+        }
+    }
+
+    return file;
+}
+
+auto GraphExport::extract(const std::filesystem::path &script) -> FileGraph {
+    const Profiler::FileScope file_scope(script);
+    try {
+        const Graph graph(script);
+        return collect(script, graph);
+    } catch (const std::exception &e) {
+        return {.path=script, .nodes={}, .edges={}, .labels={}, .jumps={},
+            .errors={std::format("parser failed: {}", e.what())}};
+    }
+}
+
+auto GraphExport::run(const std::filesystem::path &path, const std::filesystem::path &out_path, const Format format) -> int {
+    assert(format != Format::Binary); // those are written by ParseCache::write
+    const auto scripts = list_scripts(path);
+    if (scripts.empty()) {
+        std::println(std::cerr, "no .rpy scripts found in {}", path.string());
+        return -1;
+    }
+
+    std::ofstream stream(out_path, std::ios::binary);
+    if (!stream) {
+        std::println(std::cerr, "could not open {} for writing", out_path.string());
+        return 1;
+    }
+    BufferedWriter out(stream);
+    write_begin(out, format, path);
+
+    // only the labels and jumps are kept past writing a script, to join them up at the end
+    LabelIds label_ids;
+    Jumps jumps;
+    unsigned n_files = 0;
+    unsigned first = 0;
+    const auto finish = [&](FileGraph file) -> void {
+        if (format == Format::DOT) {
+            write_dot_file(out, file, n_files, first);
+        } else {
+            write_json_file(out, file, n_files, first);
+        }
+        for (auto &label : file.labels) {
+            label_ids.try_emplace(std::move(label.name), first + label.node); // Ren'Py wants them unique anyway
+        }
+        for (auto &jump : file.jumps) {
+            jumps.emplace_back(first + jump.node, std::move(jump.target));
+        }
+        ++n_files;
+        first += static_cast<unsigned>(file.nodes.size());
+    };
+
+    ThreadPool pool;
+    const auto max_in_flight = pool.size() * 2;
+    std::deque<std::future<FileGraph>> in_flight;
+
+    for (const auto &script : scripts) {
+        if (in_flight.size() >= max_in_flight) {
+            finish(in_flight.front().get());
+            in_flight.pop_front();
+        }
+        in_flight.push_back(pool.submit([script] -> FileGraph {
+            return extract(script);
+        }));
+    }
+    for (auto &f : in_flight) {
+        finish(f.get());
+    }
+
+    write_end(out, format, label_ids, jumps);
+
+    if (!out.finish()) {
+        std::println(std::cerr, "could not write all of {}", out_path.string());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_GRAPHEXPORT_HPP
+#define RPY_PROJ_ANALYZER_GRAPHEXPORT_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Graph.hpp"
+#include "GraphFile.hpp"
+
+/**
+ * @brief Writes the flow graph of a script, or of a whole project, as DOT or JSON for other tools.
+ *
+ * Scripts are parsed on a thread pool, like in Batch, and each one is cut down
+ * to a FileGraph before the next few are started, so only the nodes' kind,
+ * line, label and word count are kept around. The FileGraphs are written out
+ * in file tree order through a fixed size buffer as soon as they are ready, as
+ * one graph with a node id per node across the whole project. Jumps and calls
+ * are written last, once every label in the project has been seen.
+ */
+class GraphExport {
+public:
+    static constexpr unsigned NONE = ~0u;
+
+    enum class Format : std::uint8_t {
+        DOT,
+        JSON,
+        Binary, // a GraphFile of a single script
+    };
+
+    using EdgeType = GraphFile::EdgeType;
+    static constexpr auto edge_names = GraphFile::edge_names;
+
+    struct NodeInfo {
+        std::uint8_t kind = 0; // index into Batch::kind_names
+        unsigned line = 0;
+        unsigned label = NONE; // the label the node is in, index into FileGraph::labels
+        unsigned words = 0;
+    };
+
+    struct Edge {
+        unsigned from = 0;
+        unsigned to = 0;
+        EdgeType type{};
+    };
+
+    struct Label {
+        std::string name;
+        unsigned node = 0;
+    };
+
+    struct Jump {
+        unsigned node = 0;
+        std::string target;
+    };
+
+    /**
+     * @brief what's exported of one script. Node indices are the same as in its Graph.
+     */
+    struct FileGraph {
+        std::filesystem::path path;
+        std::vector<NodeInfo> nodes;
+        std::vector<Edge> edges; // only the ones within the script, jumps can go anywhere
+        std::vector<Label> labels;
+        std::vector<Jump> jumps;
+        std::vector<std::string> errors;
+    };
+
+    /**
+     * @brief the format to write, going by the file's extension.
+     */
+    [[nodiscard]] static auto format_of(const std::filesystem::path &path) -> std::optional<Format>;
+
+    [[nodiscard]] static auto collect(const std::filesystem::path &script, const Graph &graph) -> FileGraph;
+
+    /**
+     * @brief parses the script and collects it. A script the parser fails on comes back with just the error.
+     */
+    [[nodiscard]] static auto extract(const std::filesystem::path &script) -> FileGraph;
+
+    /**
+     * @brief exports `path` (a script or a directory) to the file `out`, as DOT or JSON.
+     *
+     * Binary files hold the layout too, so they are written by ParseCache::write instead.
+     * @return 0 if everything was written, 1 if not, -1 if there was nothing to export.
+     */
+    static auto run(const std::filesystem::path &path, const std::filesystem::path &out, Format format) -> int;
+};
+
+#endif //RPY_PROJ_ANALYZER_GRAPHEXPORT_HPP
@@ -0,0 +1,126 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "GraphFile.hpp"
+
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::filesystem::path &path) : data(MAP_FAILED) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        len = static_cast<std::size_t>(st.st_size);
+        data = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data != MAP_FAILED) {
+        ::munmap(data, len);
+    }
+}
+
+MappedFile::operator bool() const {
+    return data != MAP_FAILED;
+}
+
+auto MappedFile::bytes() const -> std::span<const std::byte> {
+    return {static_cast<const std::byte*>(data), len};
+}
+
+auto GraphFile::view(const std::span<const std::byte> bytes) -> std::expected<GraphFile, std::string> {
+    GraphFile file;
+    if (bytes.size() < sizeof(Header)) {
+        return std::unexpected("graph file is truncated");
+    }
+    std::memcpy(&file.hdr, bytes.data(), sizeof(Header));
+
+    const auto &hdr = file.hdr;
+    if (hdr.magic != MAGIC) {
+        return std::unexpected("not a graph file");
+    }
+    if (hdr.version != VERSION) {
+        return std::unexpected("graph file is version " + std::to_string(hdr.version)
+            + ", expected " + std::to_string(VERSION));
+    }
+
+    const auto tokens = table<TokenRec>(bytes, hdr.tokens_off, hdr.n_tokens);
+    const auto nodes = table<NodeRec>(bytes, hdr.nodes_off, hdr.n_nodes);
+    const auto edges = table<EdgeRec>(bytes, hdr.edges_off, hdr.n_edges);
+    const auto layout = table<std::byte>(bytes, hdr.layout_off, std::uint64_t{hdr.n_layout} * hdr.layout_rec_size);
+    const auto pool = table<char>(bytes, hdr.strings_off, hdr.strings_size);
+    if (!tokens || !nodes || !edges || !layout || !pool) {
+        return std::unexpected("graph file is truncated");
+    }
+
+    file.token_recs = *tokens;
+    file.node_recs = *nodes;
+    file.edge_recs = *edges;
+    file.layout_bytes = *layout;
+    file.pool = std::string_view(pool->data(), pool->size());
+    return file;
+}
+
+auto GraphFile::open(const std::filesystem::path &path) -> std::expected<GraphFile, std::string> {
+    auto map = std::make_unique<MappedFile>(path);
+    if (!*map) {
+        return std::unexpected("could not map " + path.string());
+    }
+    auto file = view(map->bytes());
+    if (file) {
+        file->map = std::move(map);
+    }
+    return file;
+}
+
+auto GraphFile::header() const -> const Header& {
+    return hdr;
+}
+
+auto GraphFile::tokens() const -> std::span<const TokenRec> {
+    return token_recs;
+}
+
+auto GraphFile::nodes() const -> std::span<const NodeRec> {
+    return node_recs;
+}
+
+auto GraphFile::edges() const -> std::span<const EdgeRec> {
+    return edge_recs;
+}
+
+auto GraphFile::layout() const -> std::span<const std::byte> {
+    return layout_bytes;
+}
+
+auto GraphFile::strings() const -> std::string_view {
+    return pool;
+}
+
+auto GraphFile::str(const StrRef ref) const -> std::optional<std::string_view> {
+    const auto off = ref >> 32;
+    const auto len = ref & 0xFFFFFFFF;
+    if (off > pool.size() || len > pool.size() - off) {
+        return std::nullopt;
+    }
+    return pool.substr(off, len);
+}
+
+auto GraphFile::kind_name(const std::uint32_t kind) -> std::string_view {
+    return kind < kind_names.size() ? kind_names[kind] : "unknown";
+}
+
+auto GraphFile::edge_name(const std::uint32_t type) -> std::string_view {
+    return type < edge_names.size() ? edge_names[type] : "unknown";
+}
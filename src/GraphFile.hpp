@@ -0,0 +1,194 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_GRAPHFILE_HPP
+#define RPY_PROJ_ANALYZER_GRAPHFILE_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+static_assert(std::endian::native == std::endian::little, "graph files are little-endian and read in place");
+
+/**
+ * @brief A read-only mapping of a whole file.
+ */
+class MappedFile {
+    void *data;
+    std::size_t len = 0;
+
+public:
+    explicit MappedFile(const std::filesystem::path &path);
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+    ~MappedFile();
+
+    explicit operator bool() const;
+
+    [[nodiscard]] auto bytes() const -> std::span<const std::byte>;
+};
+
+/**
+ * @brief The binary layout of a parsed script, and a reader for it that doesn't need the parser.
+ *
+ * This is what the parse cache stores, and what `--graph file.rpyg` writes. It's
+ * made of fixed size, little-endian records, each table 8 byte aligned, so a
+ * mapped file is read in place without any parsing:
+ *
+ *   header | token table | node table | edge table | layout table | string pool
+ *
+ * Strings are StrRefs into the pool: the offset in the high 32 bits, the length
+ * in the low ones. Indices that point nowhere are NO_IDX. A node's kind indexes
+ * `kind_names`, an edge's type `edge_names` and a token's kind the Token
+ * variant. The layout table is only meant for the parse cache, other readers
+ * can skip it. Node text is only written when the header's flags have
+ * `NODE_TEXT` (`--graph file.rpyg` does, the parse cache doesn't, since nodes
+ * build their text on demand). Bump `VERSION` whenever a record, the kinds
+ * or the Token variant change.
+ */
+class GraphFile {
+public:
+    static constexpr std::array<char, 8> MAGIC = {'R', 'P', 'Y', 'G', 'R', 'A', 'P', 'H'};
+    static constexpr std::uint32_t VERSION = 4;
+    static constexpr std::uint32_t NO_IDX = ~std::uint32_t{0};
+    static constexpr std::uint32_t NODE_TEXT = 1; // a header flag: NodeRec::text is filled in
+
+    static constexpr std::array<std::string_view, 19> kind_names = {
+        "label", "menu", "choice", "dialogue", "if", "elif", "else", "while",
+        "call", "jump", "return", "pass", "show", "scene", "hide", "with",
+        "play", "image", "expr",
+    };
+
+    enum class EdgeType : std::uint8_t {
+        Next,   // to the statement after this one
+        Child,  // to the first statement of this one's block
+        Branch, // from a menu to each of its choices, and from an if to each of its elif / else arms
+        Jump,   // from a jump or call to its label
+    };
+
+    static constexpr std::array<std::string_view, 4> edge_names = {"next", "child", "branch", "jump"};
+
+    using StrRef = std::uint64_t;
+
+    struct Header {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t n_token_kinds;
+        std::int64_t mtime; // of the script, in file_time_type ticks
+        std::uint64_t size;
+        std::uint64_t hash; // FNV-1a of the script's bytes
+        std::uint32_t n_tokens;
+        std::uint32_t n_nodes;
+        std::uint32_t n_edges;
+        std::uint32_t n_layout;
+        std::uint64_t tokens_off;
+        std::uint64_t nodes_off;
+        std::uint64_t edges_off;
+        std::uint64_t layout_off;
+        std::uint64_t strings_off;
+        std::uint64_t strings_size;
+        std::uint32_t layout_rec_size;
+        std::uint32_t flags;
+    };
+
+    struct TokenRec {
+        std::uint32_t kind; // index into the Token variant
+        std::uint32_t line;
+        std::uint32_t col;
+        std::uint32_t indent;
+        std::uint64_t payload; // StrRef, literal value or enum, depending on the kind
+    };
+
+    struct NodeRec {
+        std::uint32_t line;
+        std::uint32_t col;
+        std::uint32_t indent;
+        std::uint32_t parent;
+        std::uint32_t next;
+        std::uint32_t prev;
+        std::uint32_t first_child;
+        std::uint32_t after_block;
+        std::uint32_t path_flags;
+        std::uint32_t kind;
+        std::uint32_t label; // the label node this one is in
+        std::uint32_t words;
+        StrRef text;   // what the node shows, as Node::to_string(), if the file has NODE_TEXT
+        StrRef target; // the label a jump or call goes to
+    };
+
+    struct EdgeRec {
+        std::uint32_t from;
+        std::uint32_t to;
+        std::uint32_t type;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) == 112);
+    static_assert(std::is_trivially_copyable_v<TokenRec> && sizeof(TokenRec) == 24);
+    static_assert(std::is_trivially_copyable_v<NodeRec> && sizeof(NodeRec) == 64);
+    static_assert(std::is_trivially_copyable_v<EdgeRec> && sizeof(EdgeRec) == 12);
+
+private:
+    std::unique_ptr<MappedFile> map; // unset when viewing someone else's bytes
+    Header hdr{};
+    std::span<const TokenRec> token_recs;
+    std::span<const NodeRec> node_recs;
+    std::span<const EdgeRec> edge_recs;
+    std::span<const std::byte> layout_bytes;
+    std::string_view pool;
+
+public:
+    static constexpr auto align8(const std::uint64_t off) -> std::uint64_t {
+        return (off + 7) & ~std::uint64_t{7};
+    }
+
+    /**
+     * @brief `n` records of T at `off`, if they are in bounds and aligned for T.
+     */
+    template<typename T>
+    static auto table(const std::span<const std::byte> bytes, const std::uint64_t off, const std::uint64_t n)
+        -> std::optional<std::span<const T>> {
+        if (off % alignof(T) != 0 || off > bytes.size() || n > (bytes.size() - off) / sizeof(T)) {
+            return std::nullopt;
+        }
+        return std::span(reinterpret_cast<const T*>(bytes.data() + off), n);
+    }
+
+    /**
+     * @brief checks the header and that every table is in bounds, then views the tables in place.
+     *
+     * `bytes` has to be 8 byte aligned and outlive the view.
+     */
+    static auto view(std::span<const std::byte> bytes) -> std::expected<GraphFile, std::string>;
+
+    /**
+     * @brief maps `path` and views it.
+     */
+    static auto open(const std::filesystem::path &path) -> std::expected<GraphFile, std::string>;
+
+    [[nodiscard]] auto header() const -> const Header&;
+    [[nodiscard]] auto tokens() const -> std::span<const TokenRec>;
+    [[nodiscard]] auto nodes() const -> std::span<const NodeRec>;
+    [[nodiscard]] auto edges() const -> std::span<const EdgeRec>;
+    [[nodiscard]] auto layout() const -> std::span<const std::byte>;
+    [[nodiscard]] auto strings() const -> std::string_view;
+
+    /**
+     * @brief the string `ref` points to, or nothing if it points outside the pool.
+     */
+    [[nodiscard]] auto str(StrRef ref) const -> std::optional<std::string_view>;
+
+    [[nodiscard]] static auto kind_name(std::uint32_t kind) -> std::string_view;
+    [[nodiscard]] static auto edge_name(std::uint32_t type) -> std::string_view;
+};
+
+#endif //RPY_PROJ_ANALYZER_GRAPHFILE_HPP
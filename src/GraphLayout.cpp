@@ -7,8 +7,19 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <ranges>
 
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    auto mix(const std::uint64_t hash, const std::uint64_t value) -> std::uint64_t {
+        return hash ^ (value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2));
+    }
+}
+
 auto Layout::make_ifs(const std::vector<std::unique_ptr<Node>>& nodes, const unsigned prev_idx,
                       const unsigned idx) -> std::unique_ptr<LayoutGroup> {
     std::vector<LayoutColumn> branches;
@@ -154,11 +165,17 @@ auto LayoutBase::has_children() -> bool {
     return false;
 }
 
+auto LayoutBase::update_shape() -> std::uint64_t {
+    shape = 1;
+    return shape;
+}
+
 auto LayoutBase::update_width() -> float {
     return 1.0f;
 }
 
 auto LayoutBase::update_height() -> float {
+    dirty = false;
     return 1.0f;
 }
 
@@ -180,6 +197,10 @@ void LayoutBase::flatten(std::vector<LayoutBase*>& flat_disps) {
 void LayoutBase::collect_edges(std::unordered_map<Node*, Node*>& edges) {
 }
 
+void LayoutBase::collect_all(std::vector<LayoutBase*>& all) {
+    all.push_back(this);
+}
+
 auto LayoutBase::get_idx() const -> unsigned {
     return idx;
 }
@@ -246,7 +267,19 @@ auto LayoutColumn::has_children() -> bool {
     return true;
 }
 
+auto LayoutColumn::update_shape() -> std::uint64_t {
+    shape = mix(2, displays.size());
+    for (const auto& node : displays) {
+        shape = mix(shape, node->update_shape());
+    }
+    return shape;
+}
+
 auto LayoutColumn::update_width() -> float {
+    if (!dirty) {
+        return width;
+    }
+
     float left_extent  = 0;
     float right_extent = 0;
 
@@ -271,11 +304,16 @@ auto LayoutColumn::update_width() -> float {
 
 
 auto LayoutColumn::update_height() -> float {
+    if (!dirty) {
+        return height;
+    }
+
     float acc_height = 0;
     for (const auto& node : displays) {
         acc_height += node->update_height();
     }
     this->height = std::max(1.0f, acc_height);
+    dirty = false;
     return this->height;
 }
 
@@ -305,6 +343,13 @@ void LayoutColumn::collect_edges(std::unordered_map<Node*, Node*>& edges) {
     }
 }
 
+void LayoutColumn::collect_all(std::vector<LayoutBase*>& all) {
+    all.push_back(this);
+    for (const auto& node : displays) {
+        node->collect_all(all);
+    }
+}
+
 LayoutGroup::LayoutGroup(const unsigned idx, const GroupType type, std::vector<LayoutColumn> columns, std::unordered_map<Node*, Node*> c_to_p)
     : LayoutBase(idx), type(type), columns(std::move(columns)), children_to_parents(std::move(c_to_p)) {
 }
@@ -322,7 +367,19 @@ auto LayoutGroup::has_children() -> bool {
     return true;
 }
 
+auto LayoutGroup::update_shape() -> std::uint64_t {
+    shape = mix(mix(3, static_cast<std::uint64_t>(type)), columns.size());
+    for (auto& col : columns) {
+        shape = mix(shape, col.update_shape());
+    }
+    return shape;
+}
+
 auto LayoutGroup::update_width() -> float {
+    if (!dirty) {
+        return width;
+    }
+
     float acc_width = 0;
     anchor_offset = 0;
 
@@ -343,11 +400,16 @@ auto LayoutGroup::update_width() -> float {
 }
 
 auto LayoutGroup::update_height() -> float {
+    if (!dirty) {
+        return height;
+    }
+
     float max_col = 0;
     for (auto& col : columns) {
         max_col = std::max(max_col, col.update_height());
     }
     height = max_col;
+    dirty = false;
     return height;
 }
 
@@ -388,6 +450,13 @@ void LayoutGroup::collect_edges(std::unordered_map<Node*, Node*>& edges) {
     }
 }
 
+void LayoutGroup::collect_all(std::vector<LayoutBase*>& all) {
+    all.push_back(this);
+    for (auto& col : columns) {
+        col.collect_all(all);
+    }
+}
+
 auto LayoutGroup::anchor_x() const -> float {
     if (columns.empty()) {
         return 1;
@@ -406,20 +475,27 @@ auto LayoutGroup::anchor_x() const -> float {
 }
 
 void GraphLayout::assign_dimensions() const {
+    // groups restored from a snapshot are clean and return straight away
     for (const auto& group : top_levels) {
         group->update_width();
         group->update_height();
     }
 }
 
-void GraphLayout::assign_layouts() {
+void GraphLayout::assign_layouts(const std::size_t first) {
+    const float max_width = get_max_width();
     float y_pos = 0;
-    for (const auto& group : top_levels) {
-        Layout::layout_node(*group, 0, y_pos);
+    for (std::size_t i = 0; i < top_levels.size(); ++i) {
+        const auto& group = top_levels[i];
+        // groups above `first` are already in place, they only move down by the heights before them
+        if (i >= first) {
+            Layout::layout_node(*group, 0, y_pos);
+        }
         if (dynamic_cast<LayoutGroup*>(group.get()) != nullptr) {
             y_pos += group->height + 1;
         } else {
-            group->layout.left_x = get_max_width() / 2;
+            // the widest group may have changed, so these get centred again either way
+            group->layout.left_x = max_width / 2;
             y_pos += 1;
         }
     }
@@ -431,7 +507,7 @@ void GraphLayout::assign_wc(const std::vector<std::unique_ptr<Node>>& nodes) con
         acc_wc += group->update_highest_wc(nodes);
         group->mark_highest_wc(nodes);
     }
-    std::println("max word count: {}", acc_wc);
+    Log::info("max word count: {}", acc_wc);
 }
 
 void GraphLayout::flatten() {
@@ -449,7 +525,7 @@ auto GraphLayout::collect_edges() const -> std::unordered_map<Node*, Node*> {
     return edges;
 }
 
-GraphLayout::GraphLayout(Graph& graph) {
+void GraphLayout::build_groups(Graph& graph) {
     for (int i = 0; i < graph.get_nodes().size(); ++i) {
         const auto& node = graph.get_nodes().at(i);
         if (node->indent == 0) {
@@ -458,15 +534,95 @@ GraphLayout::GraphLayout(Graph& graph) {
             } else {
                 top_levels.emplace_back(std::make_unique<LayoutItem>(i));
             }
+            top_levels.back()->update_shape();
         }
     }
+}
 
-    assign_dimensions();
-    assign_layouts();
+GraphLayout::GraphLayout(Graph& graph) {
+    build_groups(graph);
+
+    {
+        const Profiler::Scope scope("layout_dimensions");
+        assign_dimensions();
+    }
+    {
+        const Profiler::Scope scope("layout_positions");
+        assign_layouts();
+    }
     assign_wc(graph.get_nodes());
     flatten();
 
-    std::println("{} display nodes, {} graph nodes.", flat_disps.size(), graph.get_nodes().size());
+    Log::info("{} display nodes, {} graph nodes.", flat_disps.size(), graph.get_nodes().size());
+
+    assert(flat_disps.size() == graph.get_nodes().size());
+}
+
+GraphLayout::GraphLayout(Graph& graph, const std::span<const LayoutSnapshot> snapshot, const bool fresh_nodes) {
+    build_groups(graph);
+
+    // where each top level group starts in the snapshot
+    std::vector<std::size_t> snap_tops;
+    for (std::size_t i = 0; i < snapshot.size(); i += std::max<std::size_t>(1, snapshot[i].n_elems)) {
+        snap_tops.push_back(i);
+    }
+
+    std::vector<std::vector<LayoutBase*>> tops_elems(top_levels.size());
+    for (std::size_t i = 0; i < top_levels.size(); ++i) {
+        top_levels[i]->collect_all(tops_elems[i]);
+    }
+
+    auto matches = [&](const std::size_t top, const std::size_t snap_top) -> bool {
+        const auto& snap = snapshot[snap_tops[snap_top]];
+        return top_levels[top]->shape == snap.shape
+            && tops_elems[top].size() == snap.n_elems
+            && snap_tops[snap_top] + snap.n_elems <= snapshot.size();
+    };
+    auto restore = [&](const std::size_t top, const std::size_t snap_top, const bool with_position) {
+        const auto* snap = &snapshot[snap_tops[snap_top]];
+        for (auto* elem : tops_elems[top]) {
+            elem->width = snap->width;
+            elem->height = snap->height;
+            if (with_position) {
+                elem->layout = snap->layout;
+            }
+            if (auto* col = dynamic_cast<LayoutColumn*>(elem)) {
+                col->center_offset = snap->center_offset;
+            }
+            elem->dirty = false;
+            ++snap;
+        }
+    };
+
+    const auto n_common = std::min(top_levels.size(), snap_tops.size());
+    std::size_t prefix = 0;
+    while (prefix < n_common && matches(prefix, prefix)) {
+        restore(prefix, prefix, true);
+        ++prefix;
+    }
+    std::size_t suffix = 0;
+    while (prefix + suffix < n_common
+        && matches(top_levels.size() - 1 - suffix, snap_tops.size() - 1 - suffix)) {
+        restore(top_levels.size() - 1 - suffix, snap_tops.size() - 1 - suffix, false);
+        ++suffix;
+    }
+
+    if (prefix < top_levels.size() || top_levels.size() != snap_tops.size()) {
+        Log::info("reusing the layout of {} of {} top level groups", prefix + suffix, top_levels.size());
+        {
+            const Profiler::Scope scope("layout_dimensions");
+            assign_dimensions();
+        }
+        {
+            const Profiler::Scope scope("layout_positions");
+            assign_layouts(prefix);
+        }
+    }
+    if (fresh_nodes) {
+        assign_wc(graph.get_nodes());
+    }
+
+    flatten();
 
     assert(flat_disps.size() == graph.get_nodes().size());
 }
@@ -475,53 +631,66 @@ auto GraphLayout::get_groups() -> std::vector<std::unique_ptr<LayoutBase>>& {
     return top_levels;
 }
 
+auto GraphLayout::snapshot() const -> std::vector<LayoutSnapshot> {
+    std::vector<LayoutSnapshot> snap;
+    std::vector<LayoutBase*> all;
+    for (const auto& group : top_levels) {
+        all.clear();
+        group->collect_all(all);
+
+        const auto first = snap.size();
+        for (const auto* elem : all) {
+            const auto* col = dynamic_cast<const LayoutColumn*>(elem);
+            snap.push_back({
+                .width=elem->width,
+                .height=elem->height,
+                .center_offset=col != nullptr ? col->center_offset : 0.0f,
+                .layout=elem->layout,
+                .shape=elem->shape,
+            });
+        }
+        snap[first].n_elems = static_cast<std::uint32_t>(all.size());
+    }
+
+    return snap;
+}
+
 auto GraphLayout::get_max_width() -> float {
+    if (top_levels.empty()) {
+        return 0.0f;
+    }
     return std::ranges::max(
         top_levels | std::views::transform(&LayoutGroup::width)
     );
 }
 
-auto GraphLayout::make_displayables(Graph& graph) -> LayoutData {
-    std::vector<unsigned> idxs;
-    auto displayables =
-            flat_disps
-            | std::views::transform([&](const auto& ptr) -> auto {
-                auto idx = ptr->get_idx();
-                idxs.push_back(idx);
-                const auto& node = graph.get_nodes().at(idx);
-                raylib::Rectangle disp_box{
-                    ptr->layout.left_x * DisplayNode::get_width(),
-                    ptr->layout.top_y * DisplayNode::get_height(),
+auto GraphLayout::make_data(const Graph& graph, const std::span<LayoutBase* const> flat,
+    const std::unordered_map<Node*, Node*>& edges, const raylib::Vector2 offset) -> LayoutData {
+    auto geoms =
+            flat
+            | std::views::transform([&](const auto& ptr) -> NodeGeom {
+                const auto& node = graph.get_nodes().at(ptr->get_idx());
+                const raylib::Rectangle disp_box{
+                    offset.x + (ptr->layout.left_x * DisplayNode::get_width()),
+                    offset.y + (ptr->layout.top_y * DisplayNode::get_height()),
                     DisplayNode::get_width(),
                     DisplayNode::get_height()
                 };
-                return node->make_display_node(disp_box);
+                return {node.get(), disp_box};
             })
-            | std::ranges::to<std::vector<DisplayNode>>();
+            | std::ranges::to<std::vector<NodeGeom>>();
 
-    std::unordered_map<Node*, DisplayNode*> nodes_to_disps;
-    for (int i = 0; i < idxs.size(); ++i) {
-        nodes_to_disps[graph.get_nodes().at(idxs.at(i)).get()] = &displayables.at(i);
+    std::unordered_map<const Node*, const NodeGeom*> nodes_to_geoms;
+    nodes_to_geoms.reserve(geoms.size());
+    for (const auto &geom : geoms) {
+        nodes_to_geoms[geom.node] = &geom;
     }
 
-#ifndef NDEBUG
-    for (int i = 0; i < displayables.size(); ++i) {
-        for (int j = 0; j < displayables.size(); ++j) {
-            if (i != j) {
-                if (displayables.at(i).padding_box.CheckCollision(displayables.at(j).padding_box)) {
-                    std::println(std::cerr, "WARNING: two boxes colliding");
-                }
-            }
-        }
-    }
-#endif //NDEBUG
-
     std::vector<std::array<raylib::Vector2, N_POINTS>> line_points;
 
-    auto edges = collect_edges();
-    for (auto &[child, parent] : collect_edges()) {
-        auto *child_disp = nodes_to_disps[child];
-        auto *parent_disp = nodes_to_disps[parent];
+    for (const auto &[child, parent] : edges) {
+        const auto *child_disp = nodes_to_geoms[child];
+        const auto *parent_disp = nodes_to_geoms[parent];
         auto child_x = child_disp->main_box.x + (child_disp->main_box.width / 2);
         auto child_y = child_disp->main_box.y;
         auto parent_x = parent_disp->main_box.x + (parent_disp->main_box.width / 2);
@@ -536,8 +705,8 @@ auto GraphLayout::make_displayables(Graph& graph) -> LayoutData {
     }
 
     std::vector<raylib::Rectangle> rects;
-    for (const auto &d : displayables) {
-        if ((d.get_underlying()->path_flags & Node::BEST_WC) > 0) {
+    for (const auto &d : geoms) {
+        if ((d.node->path_flags & Node::BEST_WC) > 0) {
             auto new_rect = d.main_box;
             new_rect.x -= 2.0f;
             new_rect.width += 4.0f;
@@ -547,11 +716,116 @@ auto GraphLayout::make_displayables(Graph& graph) -> LayoutData {
         }
     }
 
-    if (rects.empty()) {
-        std::println("NO RECTS");
+    return {.geoms=std::move(geoms),
+        .line_points=std::move(line_points),
+        .highlights=std::move(rects),
+        .overlaps={}};
+}
+
+auto GraphLayout::make_displayables(Graph& graph) -> LayoutData {
+    const Profiler::Scope scope("make_displayables");
+    auto data = make_data(graph, flat_disps, collect_edges(), {0.0f, 0.0f});
+
+#ifndef NDEBUG
+    data.overlaps = find_overlaps(data.geoms);
+    if (!data.overlaps.empty()) {
+        const auto &first = data.overlaps.front();
+        Log::error("layout has {} overlapping node boxes, the first between lines {} and {}",
+            data.overlaps.size(), first.line_a, first.line_b);
     }
+#endif //NDEBUG
 
-    return {.disps=std::move(displayables),
-        .line_points=std::move(line_points),
-        .highlights=std::move(rects)};
+    if (data.highlights.empty()) {
+        Log::info("NO RECTS");
+    }
+
+    return data;
+}
+
+auto GraphLayout::label_extents() const -> std::vector<GroupExtent> {
+    std::vector<GroupExtent> extents;
+    for (std::size_t i = 0; i < top_levels.size(); ++i) {
+        const auto &top = top_levels[i];
+        if (dynamic_cast<const LayoutGroup*>(top.get()) != nullptr) {
+            extents.push_back({.top=i, .node_idx=top->get_idx(), .width=top->width, .height=top->height});
+        }
+    }
+    return extents;
+}
+
+auto GraphLayout::make_group_displayables(const Graph& graph, const std::size_t top, const raylib::Vector2 origin) const -> LayoutData {
+    const Profiler::Scope scope("make_group_displayables");
+    auto &group = *top_levels.at(top);
+
+    std::vector<LayoutBase*> flat;
+    group.flatten(flat);
+    std::unordered_map<Node*, Node*> edges;
+    group.collect_edges(edges);
+
+    const raylib::Vector2 offset{
+        origin.x - (group.layout.left_x * DisplayNode::get_width()),
+        origin.y - (group.layout.top_y * DisplayNode::get_height()),
+    };
+    return make_data(graph, flat, edges, offset);
+}
+
+auto GraphLayout::find_overlaps(const std::span<const NodeGeom> geoms) -> std::vector<LayoutOverlap> {
+    const Profiler::Scope scope("find_overlaps");
+    const float cell_w = DisplayNode::get_width();
+    const float cell_h = DisplayNode::get_height();
+
+    auto cell_of = [&](const float x, const float y) -> std::pair<std::int32_t, std::int32_t> {
+        return {static_cast<std::int32_t>(std::floor(x / cell_w)), static_cast<std::int32_t>(std::floor(y / cell_h))};
+    };
+    auto key = [](const std::pair<std::int32_t, std::int32_t> cell) -> std::uint64_t {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.first)) << 32)
+            | static_cast<std::uint32_t>(cell.second);
+    };
+
+    // a box goes in every cell it touches, which is at most four since boxes are no bigger than a cell
+    std::unordered_map<std::uint64_t, std::vector<unsigned>> cells;
+    cells.reserve(geoms.size());
+    for (unsigned i = 0; i < geoms.size(); ++i) {
+        const auto &box = geoms[i].padding_box;
+        const auto [x0, y0] = cell_of(box.x, box.y);
+        const auto [x1, y1] = cell_of(box.x + box.width, box.y + box.height);
+        for (auto cx = x0; cx <= x1; ++cx) {
+            for (auto cy = y0; cy <= y1; ++cy) {
+                cells[key({cx, cy})].push_back(i);
+            }
+        }
+    }
+
+    std::vector<LayoutOverlap> overlaps;
+    for (const auto &[cell, members] : cells) {
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            for (std::size_t j = i + 1; j < members.size(); ++j) {
+                const auto &a = geoms[members[i]];
+                const auto &b = geoms[members[j]];
+                if (!a.padding_box.CheckCollision(b.padding_box)) {
+                    continue;
+                }
+
+                // boxes sharing more than one cell are only reported by the one the overlap starts in
+                const auto area = a.padding_box.GetCollision(b.padding_box);
+                if (key(cell_of(area.x, area.y)) != cell) {
+                    continue;
+                }
+
+                const auto line_a = a.node->line_and_col().first;
+                const auto line_b = b.node->line_and_col().first;
+                const bool swap = line_b < line_a;
+                overlaps.push_back({
+                    .a=swap ? b.node : a.node,
+                    .b=swap ? a.node : b.node,
+                    .line_a=std::min(line_a, line_b),
+                    .line_b=std::max(line_a, line_b),
+                    .area=area,
+                });
+            }
+        }
+    }
+
+    std::ranges::sort(overlaps, {}, [](const LayoutOverlap &o) { return std::pair(o.line_a, o.line_b); });
+    return overlaps;
 }
@@ -10,7 +10,9 @@
 #include "DisplayNode.hpp"
 
 #include <array>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 
@@ -37,17 +39,21 @@ public:
     float width = 1;
     float height = 1;
     LayoutDims layout{};
+    std::uint64_t shape = 0; // hash of the subtree's structure, which is all its dimensions depend on
+    bool dirty = true;       // dimensions need working out, cleared by update_height (which always runs after update_width)
     explicit LayoutBase(unsigned idx);
     virtual ~LayoutBase() = default;
 
     virtual auto to_string() -> std::string = 0;
     virtual auto has_children() -> bool;
+    virtual auto update_shape() -> std::uint64_t;
     virtual auto update_width() -> float;
     virtual auto update_height() -> float;
     virtual auto update_highest_wc(const std::vector<std::unique_ptr<Node>> &nodes) -> int;
     virtual void mark_highest_wc(const std::vector<std::unique_ptr<Node>>& nodes);
     virtual void flatten(std::vector<LayoutBase*>& flat_disps);
     virtual void collect_edges(std::unordered_map<Node*, Node*>& edges);
+    virtual void collect_all(std::vector<LayoutBase*>& all);
     [[nodiscard]] auto get_idx() const -> unsigned;
 };
 
@@ -69,12 +75,14 @@ public:
     LayoutColumn(const std::vector<std::unique_ptr<Node>>& nodes, unsigned parent_idx, unsigned first_node, const NodeParent* parent_ptr);
     auto to_string() -> std::string override;
     auto has_children() -> bool override;
+    auto update_shape() -> std::uint64_t override;
     auto update_width() -> float override;
     auto update_height() -> float override;
     auto update_highest_wc(const std::vector<std::unique_ptr<Node>>& nodes) -> int override;
     void mark_highest_wc(const std::vector<std::unique_ptr<Node>>& nodes) override;
     void flatten(std::vector<LayoutBase*>& flat_disps) override;
     void collect_edges(std::unordered_map<Node*, Node*>& edges) override;
+    void collect_all(std::vector<LayoutBase*>& all) override;
 };
 
 class LayoutGroup : public LayoutBase {
@@ -89,37 +97,116 @@ public:
     LayoutGroup(unsigned idx, GroupType type, std::vector<LayoutColumn> columns);
     auto to_string() -> std::string override;
     auto has_children() -> bool override;
+    auto update_shape() -> std::uint64_t override;
     auto update_width() -> float override;
     auto update_height() -> float override;
     auto update_highest_wc(const std::vector<std::unique_ptr<Node>>& nodes) -> int override;
     void mark_highest_wc(const std::vector<std::unique_ptr<Node>>& nodes) override;
     void flatten(std::vector<LayoutBase*>& flat_disps) override;
     void collect_edges(std::unordered_map<Node*, Node*>& edges) override;
+    void collect_all(std::vector<LayoutBase*>& all) override;
     [[nodiscard]] auto anchor_x() const -> float;
 };
 
+/**
+ * @brief the computed size and position of one layout element, as stored in the parse cache.
+ */
+struct LayoutSnapshot {
+    float width = 1;
+    float height = 1;
+    float center_offset = 0; // only meaningful for columns
+    LayoutDims layout{};
+    std::uint64_t shape = 0;
+    std::uint32_t n_elems = 0; // elements in the subtree, including this one. Only filled in for top levels
+};
+
 constexpr int N_POINTS = 5;
 
+/**
+ * @brief two node boxes that overlap, which a correct layout never produces.
+ */
+struct LayoutOverlap {
+    const Node *a;
+    const Node *b;
+    unsigned line_a; // line of `a` in the script, `a` always comes first
+    unsigned line_b;
+    raylib::Rectangle area; // where the padding boxes overlap
+};
+
+/**
+ * @brief Everything about a laid out script that doesn't need its text.
+ *
+ * DisplayNodes are only built for the nodes that come into view, see DisplayCache.
+ */
 struct LayoutData {
-    std::vector<DisplayNode> disps;
+    std::vector<NodeGeom> geoms;
     std::vector<std::array<raylib::Vector2, N_POINTS>> line_points;
     std::vector<raylib::Rectangle> highlights;
+    std::vector<LayoutOverlap> overlaps; // only checked for in debug builds
+};
+
+/**
+ * @brief a top level label group and its size, in node widths / heights.
+ */
+struct GroupExtent {
+    std::size_t top;   // index into the top levels
+    unsigned node_idx; // the label's node
+    float width;
+    float height;
 };
 
 class GraphLayout {
     std::vector<std::unique_ptr<LayoutBase>> top_levels;
     std::vector<LayoutBase*> flat_disps;
+    void build_groups(Graph &graph);
     void assign_dimensions() const;
-    void assign_layouts();
+    void assign_layouts(std::size_t first = 0);
     void assign_wc(const std::vector<std::unique_ptr<Node>>&) const;
     void flatten();
     [[nodiscard]] auto collect_edges() const -> std::unordered_map<Node*, Node*>;
+    static auto make_data(const Graph &graph, std::span<LayoutBase* const> flat,
+        const std::unordered_map<Node*, Node*> &edges, raylib::Vector2 offset) -> LayoutData;
 
 public:
     explicit GraphLayout(Graph &graph);
+
+    /**
+     * @brief rebuilds the layout tree but takes sizes and positions from `snapshot`
+     * where they still fit, instead of computing them.
+     *
+     * Top level groups are matched against the snapshot from the start and
+     * from the end by their shape. Matching groups keep their sizes, and the
+     * ones before the first mismatch keep their positions too, so after an
+     * edit only the edited groups are sized again and only the groups from
+     * the first edited one on are positioned again.
+     *
+     * @param fresh_nodes whether the graph was just parsed, rather than restored
+     * along with its path flags, so those still need working out.
+     */
+    GraphLayout(Graph &graph, std::span<const LayoutSnapshot> snapshot, bool fresh_nodes = false);
     auto get_groups() -> std::vector<std::unique_ptr<LayoutBase>>&;
+    [[nodiscard]] auto snapshot() const -> std::vector<LayoutSnapshot>;
     auto get_max_width() -> float;
     auto make_displayables(Graph &graph) -> LayoutData;
+
+    /**
+     * @brief every top level label group, in script order.
+     */
+    [[nodiscard]] auto label_extents() const -> std::vector<GroupExtent>;
+
+    /**
+     * @brief the displayables of just one top level group, moved so its top left corner is at `origin`.
+     */
+    auto make_group_displayables(const Graph &graph, std::size_t top, raylib::Vector2 origin) const -> LayoutData;
+
+    /**
+     * @brief every pair of overlapping padding boxes, ordered by line.
+     *
+     * Boxes are bucketed into a grid of node sized cells and only boxes that
+     * share a cell are compared, so this is linear in the number of nodes for
+     * any layout that is close to correct.
+     */
+    static auto find_overlaps(std::span<const NodeGeom> geoms) -> std::vector<LayoutOverlap>;
 };
 
 namespace Layout {
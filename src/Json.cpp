@@ -0,0 +1,330 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "Json.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <system_error>
+
+namespace {
+    class Parser {
+        static constexpr unsigned MAX_DEPTH = 256;
+
+        std::string_view text;
+        std::size_t pos = 0;
+        unsigned depth = 0;
+
+        using Result = std::expected<Json::Value, std::string>;
+
+        [[nodiscard]] auto error(const std::string_view what) const -> std::unexpected<std::string> {
+            return std::unexpected(std::format("{} at byte {}", what, pos));
+        }
+
+        void skip_ws() {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+                ++pos;
+            }
+        }
+
+        auto eat(const char c) -> bool {
+            skip_ws();
+            if (pos < text.size() && text[pos] == c) {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        auto literal(const std::string_view word, Json::Value value) -> Result {
+            if (text.substr(pos, word.size()) != word) {
+                return error("unknown literal");
+            }
+            pos += word.size();
+            return value;
+        }
+
+        auto hex4() -> std::optional<std::uint32_t> {
+            if (pos + 4 > text.size()) {
+                return std::nullopt;
+            }
+            std::uint32_t code = 0;
+            const auto *first = text.data() + pos;
+            if (const auto [ptr, ec] = std::from_chars(first, first + 4, code, 16); ec != std::errc{} || ptr != first + 4) {
+                return std::nullopt;
+            }
+            pos += 4;
+            return code;
+        }
+
+        static void append_utf8(std::string &out, const std::uint32_t code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        auto string() -> std::expected<std::string, std::string> {
+            ++pos; // the opening quote
+            std::string out;
+            while (pos < text.size()) {
+                // copy plain runs in one go, most strings have no escapes at all
+                const auto run_end = text.find_first_of("\"\\", pos);
+                if (run_end == std::string_view::npos) {
+                    break;
+                }
+                out.append(text.substr(pos, run_end - pos));
+                pos = run_end;
+                if (text[pos] == '"') {
+                    ++pos;
+                    return out;
+                }
+
+                if (++pos >= text.size()) {
+                    break;
+                }
+                switch (text[pos++]) {
+                    case '"':  out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/':  out += '/'; break;
+                    case 'b':  out += '\b'; break;
+                    case 'f':  out += '\f'; break;
+                    case 'n':  out += '\n'; break;
+                    case 'r':  out += '\r'; break;
+                    case 't':  out += '\t'; break;
+                    case 'u': {
+                        auto code = hex4();
+                        if (!code) {
+                            return error("bad \\u escape");
+                        }
+                        // a UTF-16 surrogate pair, as JSON writes anything outside the BMP
+                        if (*code >= 0xD800 && *code < 0xDC00 && text.substr(pos, 2) == "\\u") {
+                            pos += 2;
+                            const auto low = hex4();
+                            if (!low || *low < 0xDC00 || *low >= 0xE000) {
+                                return error("bad surrogate pair");
+                            }
+                            code = 0x10000 + ((*code - 0xD800) << 10) + (*low - 0xDC00);
+                        }
+                        append_utf8(out, *code);
+                        break;
+                    }
+                    default:
+                        return error("unknown escape");
+                }
+            }
+            return error("unterminated string");
+        }
+
+        auto number() -> Result {
+            double value = 0;
+            const auto *first = text.data() + pos;
+            const auto *last = text.data() + text.size();
+            // from_chars doesn't take a leading '+', and neither does JSON
+            const auto [ptr, ec] = std::from_chars(first, last, value);
+            if (ec != std::errc{} || ptr == first) {
+                return error("bad number");
+            }
+            pos += static_cast<std::size_t>(ptr - first);
+            return Json::Value{value};
+        }
+
+        auto array() -> Result {
+            ++pos;
+            Json::Array elems;
+            if (eat(']')) {
+                return Json::Value{std::move(elems)};
+            }
+            do {
+                auto elem = value();
+                if (!elem) {
+                    return elem;
+                }
+                elems.push_back(std::move(*elem));
+            } while (eat(','));
+            if (!eat(']')) {
+                return error("expected , or ]");
+            }
+            return Json::Value{std::move(elems)};
+        }
+
+        auto object() -> Result {
+            ++pos;
+            Json::Object members;
+            if (eat('}')) {
+                return Json::Value{std::move(members)};
+            }
+            do {
+                skip_ws();
+                if (pos >= text.size() || text[pos] != '"') {
+                    return error("expected a member name");
+                }
+                auto key = string();
+                if (!key) {
+                    return std::unexpected(std::move(key.error()));
+                }
+                if (!eat(':')) {
+                    return error("expected :");
+                }
+                auto member = value();
+                if (!member) {
+                    return member;
+                }
+                members.emplace_back(std::move(*key), std::move(*member));
+            } while (eat(','));
+            if (!eat('}')) {
+                return error("expected , or }");
+            }
+            return Json::Value{std::move(members)};
+        }
+
+    public:
+        explicit Parser(const std::string_view text)
+            : text(text) {
+        }
+
+        auto value() -> Result {
+            skip_ws();
+            if (pos >= text.size()) {
+                return error("unexpected end");
+            }
+            if (depth >= MAX_DEPTH) {
+                return error("nested too deep");
+            }
+
+            ++depth;
+            Result result;
+            switch (text[pos]) {
+                case '{': result = object(); break;
+                case '[': result = array(); break;
+                case '"':
+                    if (auto str = string()) {
+                        result = Json::Value{std::move(*str)};
+                    } else {
+                        result = std::unexpected(std::move(str.error()));
+                    }
+                    break;
+                case 't': result = literal("true", Json::Value{true}); break;
+                case 'f': result = literal("false", Json::Value{false}); break;
+                case 'n': result = literal("null", Json::Value{}); break;
+                default:  result = number(); break;
+            }
+            --depth;
+            return result;
+        }
+
+        auto document() -> Result {
+            auto result = value();
+            skip_ws();
+            if (result && pos != text.size()) {
+                return error("trailing characters");
+            }
+            return result;
+        }
+    };
+
+    void dump_to(std::string &out, const Json::Value &value) {
+        std::visit([&]<typename T>(const T &v) -> void {
+            if constexpr (std::is_same_v<T, std::nullptr_t>) {
+                out += "null";
+            } else if constexpr (std::is_same_v<T, bool>) {
+                out += v ? "true" : "false";
+            } else if constexpr (std::is_same_v<T, double>) {
+                std::format_to(std::back_inserter(out), "{}", v);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                Json::write_string_to(std::back_inserter(out), v);
+            } else if constexpr (std::is_same_v<T, Json::Array>) {
+                out += '[';
+                for (std::size_t i = 0; i < v.size(); ++i) {
+                    if (i > 0) {
+                        out += ',';
+                    }
+                    dump_to(out, v[i]);
+                }
+                out += ']';
+            } else {
+                out += '{';
+                for (std::size_t i = 0; i < v.size(); ++i) {
+                    if (i > 0) {
+                        out += ',';
+                    }
+                    Json::write_string_to(std::back_inserter(out), v[i].first);
+                    out += ':';
+                    dump_to(out, v[i].second);
+                }
+                out += '}';
+            }
+        }, value.data);
+    }
+}
+
+void Json::write_string(std::ostream &out, const std::string_view str) {
+    write_string_to(std::ostreambuf_iterator<char>(out), str);
+}
+
+auto Json::Value::operator[](const std::string_view key) const -> const Value& {
+    static const Value null;
+    if (const auto *members = std::get_if<Object>(&data)) {
+        for (const auto &[name, value] : *members) {
+            if (name == key) {
+                return value;
+            }
+        }
+    }
+    return null;
+}
+
+auto Json::Value::is_null() const -> bool {
+    return std::holds_alternative<std::nullptr_t>(data);
+}
+
+auto Json::Value::boolean() const -> std::optional<bool> {
+    if (const auto *b = std::get_if<bool>(&data)) {
+        return *b;
+    }
+    return std::nullopt;
+}
+
+auto Json::Value::number() const -> std::optional<double> {
+    if (const auto *d = std::get_if<double>(&data)) {
+        return *d;
+    }
+    return std::nullopt;
+}
+
+auto Json::Value::string() const -> std::optional<std::string_view> {
+    if (const auto *str = std::get_if<std::string>(&data)) {
+        return *str;
+    }
+    return std::nullopt;
+}
+
+auto Json::Value::array() const -> std::span<const Value> {
+    if (const auto *elems = std::get_if<Array>(&data)) {
+        return *elems;
+    }
+    return {};
+}
+
+auto Json::parse(const std::string_view text) -> std::expected<Value, std::string> {
+    return Parser(text).document();
+}
+
+auto Json::dump(const Value &value) -> std::string {
+    std::string out;
+    dump_to(out, value);
+    return out;
+}
@@ -0,0 +1,93 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_JSON_HPP
+#define RPY_PROJ_ANALYZER_JSON_HPP
+
+#include <cstddef>
+#include <expected>
+#include <format>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Helpers for the hand-written JSON the tool outputs, and a small reader for what it takes in.
+ */
+class Json {
+public:
+    struct Value;
+    using Array = std::vector<Value>;
+    using Object = std::vector<std::pair<std::string, Value>>; // in document order
+
+    /**
+     * @brief a parsed JSON value. Members are looked up linearly, which is plenty for the
+     * small messages this reads.
+     */
+    struct Value {
+        std::variant<std::nullptr_t, bool, double, std::string, Array, Object> data = nullptr;
+
+        /**
+         * @brief the member `key`, or null if there isn't one or this isn't an object.
+         */
+        [[nodiscard]] auto operator[](std::string_view key) const -> const Value&;
+
+        [[nodiscard]] auto is_null() const -> bool;
+        [[nodiscard]] auto boolean() const -> std::optional<bool>;
+        [[nodiscard]] auto number() const -> std::optional<double>;
+        [[nodiscard]] auto string() const -> std::optional<std::string_view>;
+
+        /**
+         * @brief the elements, or none if this isn't an array.
+         */
+        [[nodiscard]] auto array() const -> std::span<const Value>;
+    };
+
+    /**
+     * @brief parses one JSON document, which must be all of `text` apart from whitespace.
+     */
+    static auto parse(std::string_view text) -> std::expected<Value, std::string>;
+
+    /**
+     * @brief `value` written back out as compact JSON.
+     */
+    [[nodiscard]] static auto dump(const Value &value) -> std::string;
+
+    /**
+     * @brief writes `str` as a quoted JSON string, escaping what needs it.
+     */
+    static void write_string(std::ostream &out, std::string_view str);
+
+    /**
+     * @brief the same, through any output iterator of chars.
+     */
+    template<typename Out>
+    static auto write_string_to(Out out, const std::string_view str) -> Out {
+        *out++ = '"';
+        for (const char c : str) {
+            switch (c) {
+                case '"':  out = std::format_to(out, "\\\""); break;
+                case '\\': out = std::format_to(out, "\\\\"); break;
+                case '\n': out = std::format_to(out, "\\n"); break;
+                case '\r': out = std::format_to(out, "\\r"); break;
+                case '\t': out = std::format_to(out, "\\t"); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out = std::format_to(out, "\\u{:04x}", static_cast<unsigned>(c));
+                    } else {
+                        *out++ = c;
+                    }
+            }
+        }
+        *out++ = '"';
+        return out;
+    }
+};
+
+#endif //RPY_PROJ_ANALYZER_JSON_HPP
@@ -0,0 +1,156 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "LabelIndex.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+    using Sites = std::unordered_map<std::string, std::vector<LabelIndex::Site>>;
+
+    /**
+     * @brief drops `file`'s sites for `name`, and `name` itself once nothing else is left.
+     * @return how many sites are left.
+     */
+    auto erase_sites(Sites &sites, const std::string &name, const std::filesystem::path &file) -> std::size_t {
+        const auto found = sites.find(name);
+        if (found == sites.end()) {
+            return 0;
+        }
+        std::erase_if(found->second, [&](const LabelIndex::Site &site) -> bool {
+            return site.file == file;
+        });
+        const auto left = found->second.size();
+        if (left == 0) {
+            sites.erase(found);
+        }
+        return left;
+    }
+}
+
+auto LabelIndex::collect(const std::filesystem::path &file, const Graph &graph) -> FileSymbols {
+    FileSymbols symbols{.file=file, .labels={}, .targets={}};
+
+    for (const auto &node : graph.get_nodes()) {
+        const auto [line, col] = node->line_and_col();
+        if (const auto *label = dynamic_cast<const NodeLabel*>(node.get())) {
+            symbols.labels.push_back({.name=label->get_name(), .line=line, .col=col});
+        } else if (const auto *jump = dynamic_cast<const NodeJump*>(node.get())) {
+            symbols.targets.push_back({.name=jump->get_label(), .line=line, .col=col});
+        } else if (const auto *call = dynamic_cast<const NodeCall*>(node.get())) {
+            symbols.targets.push_back({.name=call->get_label(), .line=line, .col=col});
+        }
+    }
+
+    return symbols;
+}
+
+auto LabelIndex::collect_characters(const std::filesystem::path &file, const Graph &graph) -> FileSymbols {
+    FileSymbols symbols{.file=file, .labels={}, .targets={}};
+
+    for (const auto &node : graph.get_nodes()) {
+        const auto [line, col] = node->line_and_col();
+        if (const auto *dialogue = dynamic_cast<const NodeDialogue*>(node.get())) {
+            if (dialogue->get_name()) {
+                symbols.targets.push_back({.name=*dialogue->get_name(), .line=line, .col=col});
+            }
+        } else if (const auto *expr = dynamic_cast<const NodeExpr*>(node.get()); expr && expr->get_expr()) {
+            // define e = Character(...)
+            const auto *assign = dynamic_cast<const ExprBinary*>(expr->get_expr().get());
+            if (assign == nullptr || assign->op != OpType::Assign) {
+                continue;
+            }
+            const auto *var = dynamic_cast<const ExprVar*>(assign->lhs.get());
+            const auto *call = dynamic_cast<const ExprCall*>(assign->rhs.get());
+            const auto *callee = call ? dynamic_cast<const ExprVar*>(call->callee.get()) : nullptr;
+            if (var && callee && callee->name == "Character") {
+                symbols.labels.push_back({.name=var->name, .line=line, .col=col});
+            }
+        }
+    }
+
+    return symbols;
+}
+
+void LabelIndex::update(FileSymbols symbols) {
+    remove(symbols.file);
+
+    for (const auto &label : symbols.labels) {
+        auto &sites = definitions[label.name];
+        if (sites.empty()) {
+            // whatever jumped to it before resolves now
+            unresolved -= references(label.name).size();
+        }
+        sites.push_back({.file=symbols.file, .line=label.line, .col=label.col});
+    }
+    for (const auto &target : symbols.targets) {
+        if (!definitions.contains(target.name)) {
+            ++unresolved;
+        }
+        uses[target.name].push_back({.file=symbols.file, .line=target.line, .col=target.col});
+    }
+    auto file = symbols.file;
+    files.insert_or_assign(std::move(file), std::move(symbols));
+}
+
+void LabelIndex::remove(const std::filesystem::path &file) {
+    const auto found = files.find(file);
+    if (found == files.end()) {
+        return;
+    }
+    const auto &symbols = found->second;
+
+    // each name once, since a script can jump to one label (or give one character) many lines
+    std::unordered_set<std::string_view> seen;
+    for (const auto &target : symbols.targets) {
+        if (!seen.insert(target.name).second) {
+            continue;
+        }
+        const auto before = references(target.name).size();
+        const auto left = erase_sites(uses, target.name, file);
+        if (!definitions.contains(target.name)) {
+            unresolved -= before - left;
+        }
+    }
+    seen.clear();
+    for (const auto &label : symbols.labels) {
+        if (seen.insert(label.name).second && erase_sites(definitions, label.name, file) == 0) {
+            unresolved += references(label.name).size();
+        }
+    }
+    files.erase(found);
+}
+
+auto LabelIndex::find(const std::string_view label) const -> std::span<const Site> {
+    if (const auto found = definitions.find(std::string(label)); found != definitions.end()) {
+        return found->second;
+    }
+    return {};
+}
+
+auto LabelIndex::references(const std::string_view label) const -> std::span<const Site> {
+    if (const auto found = uses.find(std::string(label)); found != uses.end()) {
+        return found->second;
+    }
+    return {};
+}
+
+auto LabelIndex::symbols(const std::filesystem::path &file) const -> const FileSymbols* {
+    const auto found = files.find(file);
+    return found != files.end() ? &found->second : nullptr;
+}
+
+auto LabelIndex::n_files() const -> std::size_t {
+    return files.size();
+}
+
+auto LabelIndex::n_labels() const -> std::size_t {
+    return definitions.size();
+}
+
+auto LabelIndex::n_unresolved() const -> std::size_t {
+    return unresolved;
+}
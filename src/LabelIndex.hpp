@@ -0,0 +1,81 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_LABELINDEX_HPP
+#define RPY_PROJ_ANALYZER_LABELINDEX_HPP
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Graph.hpp"
+
+/**
+ * @brief Where every label in a project is defined, and which jumps / calls lead nowhere.
+ *
+ * Kept per file, so a changed script only replaces its own entries. Characters
+ * are indexed the same way in a second LabelIndex, see `collect_characters`.
+ */
+class LabelIndex {
+public:
+    struct Site {
+        std::filesystem::path file;
+        unsigned line = 0;
+        unsigned col = 0;
+    };
+
+    struct Symbol {
+        std::string name;
+        unsigned line = 0;
+        unsigned col = 0;
+    };
+
+    struct FileSymbols {
+        std::filesystem::path file;
+        std::vector<Symbol> labels;
+        std::vector<Symbol> targets; // labels that are jumped to or called
+    };
+
+private:
+    std::unordered_map<std::filesystem::path, FileSymbols> files;
+    std::unordered_map<std::string, std::vector<Site>> definitions;
+    std::unordered_map<std::string, std::vector<Site>> uses;
+    std::size_t unresolved = 0; // targets with no definition
+
+public:
+    static auto collect(const std::filesystem::path &file, const Graph &graph) -> FileSymbols;
+
+    /**
+     * @brief the characters a script defines (`define e = Character(...)`) as its labels, and
+     * the speakers of its dialogue as its targets.
+     */
+    static auto collect_characters(const std::filesystem::path &file, const Graph &graph) -> FileSymbols;
+
+    void update(FileSymbols symbols);
+    void remove(const std::filesystem::path &file);
+
+    /**
+     * @brief every place `label` is defined. More than one means it's a duplicate.
+     */
+    [[nodiscard]] auto find(std::string_view label) const -> std::span<const Site>;
+
+    /**
+     * @brief every jump or call to `label`, in no particular order.
+     */
+    [[nodiscard]] auto references(std::string_view label) const -> std::span<const Site>;
+
+    /**
+     * @brief what was last collected from `file`, if it's indexed.
+     */
+    [[nodiscard]] auto symbols(const std::filesystem::path &file) const -> const FileSymbols*;
+
+    [[nodiscard]] auto n_files() const -> std::size_t;
+    [[nodiscard]] auto n_labels() const -> std::size_t;
+    [[nodiscard]] auto n_unresolved() const -> std::size_t;
+};
+
+#endif //RPY_PROJ_ANALYZER_LABELINDEX_HPP
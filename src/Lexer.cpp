@@ -5,7 +5,9 @@
 #include "Lexer.hpp"
 
 #include "ATL.hpp"
+#include "Log.hpp"
 #include "Node.hpp"
+#include "Profiler.hpp"
 #include "Token.hpp"
 
 #include <format>
@@ -64,11 +66,12 @@ void Lexer::parse_num(const bool starts_neg) {
         tokens.emplace_back(TokFloatLit{line, new_col, indent_level, std::stod(num_buff)});
     }
     if (pt_count > 1) {
-        std::println(std::cerr, "warning: incorrect number format on line {}", line);
+        Log::error("warning: incorrect number format on line {}", line);
     }
 }
 
 void Lexer::remove_empty_lines() {
+    const Profiler::Scope scope("remove_empty_lines");
     std::vector<Token> cleaned;
     cleaned.reserve(tokens.size());
     std::list<Token> tok_buff;
@@ -135,7 +138,7 @@ auto Lexer::get_str_lit() -> std::string {
                         txt_buff += '\f';
                         break;
                     default:
-                        std::println(std::cerr, "invalid escape sequence at {}:{}", line, col);
+                        Log::error("invalid escape sequence at {}:{}", line, col);
                         break;
                 }
             }
@@ -150,19 +153,34 @@ auto Lexer::get_str_lit() -> std::string {
 }
 
 Lexer::Lexer(const std::filesystem::path &path) {
-    const auto input_file = std::ifstream(path);
-    std::stringstream buff;
-    buff << input_file.rdbuf();
-    this->input_str = buff.str();
+    {
+        const Profiler::Scope scope("read");
+        const auto input_file = std::ifstream(path);
+        std::stringstream buff;
+        buff << input_file.rdbuf();
+        this->input_str = buff.str();
+    }
 
     if (input_str.empty()) {
-        std::println(std::cerr, "Could not open file: {}", path.string());
+        Log::error("Could not open file: {}", path.string());
     } else {
         tokenize();
     }
 }
 
+Lexer::Lexer(std::vector<Token> tokens)
+    : tokens(std::move(tokens)) {
+}
+
+auto Lexer::from_source(std::string source) -> Lexer {
+    Lexer lexer(std::vector<Token>{});
+    lexer.input_str = std::move(source);
+    lexer.tokenize();
+    return lexer;
+}
+
 auto Lexer::tokenize() -> std::vector<Token> {
+    const Profiler::Scope scope("tokenize");
     static const std::unordered_map<std::string, TFProp> atl_tf_props = {
         { "pos", TFProp::Pos },
         { "xpos", TFProp::XPos },
@@ -466,7 +484,7 @@ auto Lexer::tokenize() -> std::vector<Token> {
                 consume();
                 tokens.emplace_back(TokOp{line, col - 2, indent_level, OpType::NotEq});
             } else {
-                std::println("warning: syntax error on {}:{}", line, col);
+                Log::error("warning: syntax error on {}:{}", line, col);
             }
         } else if (*peek() == '<') {
             consume();
@@ -525,8 +543,10 @@ auto Lexer::tokenize() -> std::vector<Token> {
         }
     }
 
-    std::println("got {} tokens...", tokens.size());
-    print_tokens(5);
+    Log::info("got {} tokens...", tokens.size());
+    if (!Log::quiet()) {
+        print_tokens(5);
+    }
 
     return this->tokens;
 }
@@ -543,6 +563,10 @@ auto Lexer::get_tokens() -> std::vector<Token>& {
     return tokens;
 }
 
+auto Lexer::get_tokens() const -> const std::vector<Token>& {
+    return tokens;
+}
+
 auto Lexer::get_idx() const -> unsigned {
     return idx;
 }
@@ -594,6 +618,10 @@ void Lexer::print_tokens(const unsigned n_lines) const {
     }
 }
 
+auto Lexer::resident_bytes() const -> std::size_t {
+    return sizeof(Lexer) + input_str.capacity() + (tokens.capacity() * sizeof(Token));
+}
+
 auto Lexer::operator++() -> unsigned& {
     idx++;
     // if (idx >= tokens.size()) {
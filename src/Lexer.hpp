@@ -124,13 +124,25 @@ public:
     }
 
     explicit Lexer(const std::filesystem::path &path);
+
+    /**
+     * @brief wraps tokens that were already produced, e.g. read back from the parse cache.
+     */
+    explicit Lexer(std::vector<Token> tokens);
+
+    /**
+     * @brief lexes `source` directly instead of reading it from a file.
+     */
+    static auto from_source(std::string source) -> Lexer;
     auto tokenize() -> std::vector<Token>;
     [[nodiscard]] auto curr() const -> const Token&;
     void adv();
     auto get_tokens() -> std::vector<Token>&;
+    [[nodiscard]] auto get_tokens() const -> const std::vector<Token>&;
     [[nodiscard]] auto get_idx() const -> unsigned;
     [[nodiscard]] auto has_more() const -> bool;
     void print_tokens(unsigned n_lines = 0) const;
+    [[nodiscard]] auto resident_bytes() const -> std::size_t;
 
     // evil operator overloading...
     auto operator++() -> unsigned&;
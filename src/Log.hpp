@@ -0,0 +1,47 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_LOG_HPP
+#define RPY_PROJ_ANALYZER_LOG_HPP
+
+#include <atomic>
+#include <format>
+#include <iostream>
+#include <print>
+#include <utility>
+
+/**
+ * @brief Progress and diagnostic messages printed while lexing and parsing.
+ *
+ * Batch mode writes its results to stdout and reports parse errors as part of
+ * them, so it turns these off with `set_quiet(true)`.
+ */
+class Log {
+    static inline std::atomic<bool> quiet_flag = false;
+
+public:
+    static void set_quiet(const bool quiet) {
+        quiet_flag.store(quiet, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static auto quiet() -> bool {
+        return quiet_flag.load(std::memory_order_relaxed);
+    }
+
+    template<typename... Args>
+    static void info(std::format_string<Args...> fmt, Args&&... args) {
+        if (!quiet()) {
+            std::println(fmt, std::forward<Args>(args)...);
+        }
+    }
+
+    template<typename... Args>
+    static void error(std::format_string<Args...> fmt, Args&&... args) {
+        if (!quiet()) {
+            std::println(std::cerr, fmt, std::forward<Args>(args)...);
+        }
+    }
+};
+
+#endif //RPY_PROJ_ANALYZER_LOG_HPP
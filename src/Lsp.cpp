@@ -0,0 +1,873 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "Lsp.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <deque>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <print>
+#include <ranges>
+#include <system_error>
+
+#include "DirTree.hpp"
+#include "Graph.hpp"
+#include "Node.hpp"
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+struct Lsp::Parsed {
+    Script script;
+    LabelIndex::FileSymbols labels;
+    LabelIndex::FileSymbols characters;
+};
+
+namespace {
+    constexpr unsigned NONE = ~0u;
+
+    // from the protocol: SymbolKind, DiagnosticSeverity and JSON-RPC error codes
+    constexpr std::uint8_t KIND_ENUM = 10;
+    constexpr std::uint8_t KIND_FUNCTION = 12;
+    constexpr std::uint8_t KIND_ENUM_MEMBER = 22;
+    constexpr int SEVERITY_ERROR = 1;
+    constexpr int SEVERITY_WARNING = 2;
+    constexpr int PARSE_ERROR = -32700;
+    constexpr int INVALID_REQUEST = -32600;
+    constexpr int METHOD_NOT_FOUND = -32601;
+    constexpr int SERVER_NOT_INITIALIZED = -32002;
+
+    // label names can have a dot in them, for local labels
+    auto is_ident(const char c) -> bool {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+    }
+
+    auto find_line_starts(const std::string_view text) -> std::vector<std::size_t> {
+        std::vector<std::size_t> starts{0};
+        for (auto nl = text.find('\n'); nl != std::string_view::npos; nl = text.find('\n', nl + 1)) {
+            starts.push_back(nl + 1);
+        }
+        return starts;
+    }
+
+    /**
+     * @brief the bytes of line `row` (from 0), without the line break.
+     */
+    auto line_of(const Lsp::Script &script, const unsigned row) -> std::string_view {
+        if (row >= script.line_starts.size()) {
+            return {};
+        }
+        const auto start = script.line_starts[row];
+        const auto end = row + 1 < script.line_starts.size() ? script.line_starts[row + 1] : script.text.size();
+        auto line = std::string_view(script.text).substr(start, end - start);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+    auto utf16_len(const std::string_view bytes) -> unsigned {
+        unsigned len = 0;
+        for (const char c : bytes) {
+            if (const auto byte = static_cast<unsigned char>(c); (byte & 0xC0) != 0x80) {
+                len += byte >= 0xF0 ? 2 : 1; // four byte sequences are surrogate pairs in UTF-16
+            }
+        }
+        return len;
+    }
+
+    /**
+     * @brief the byte `col` UTF-16 units into `line`.
+     */
+    auto byte_of(const std::string_view line, const unsigned col) -> std::size_t {
+        std::size_t i = 0;
+        unsigned units = 0;
+        while (i < line.size() && units < col) {
+            units += static_cast<unsigned char>(line[i]) >= 0xF0 ? 2 : 1;
+            ++i;
+            while (i < line.size() && (static_cast<unsigned char>(line[i]) & 0xC0) == 0x80) {
+                ++i;
+            }
+        }
+        return i;
+    }
+
+    /**
+     * @brief the byte `pos` is at in `text`, for applying edits.
+     */
+    auto offset_of(const std::string_view text, const Lsp::Position pos) -> std::size_t {
+        std::size_t start = 0;
+        for (unsigned row = 0; row < pos.line; ++row) {
+            const auto nl = text.find('\n', start);
+            if (nl == std::string_view::npos) {
+                return text.size();
+            }
+            start = nl + 1;
+        }
+        const auto end = std::min(text.find('\n', start), text.size());
+        return start + byte_of(text.substr(start, end - start), pos.col);
+    }
+
+    /**
+     * @brief where the parser's line and byte column (both from 1) are in the protocol's terms.
+     */
+    auto position(const Lsp::Script &script, const unsigned line, const unsigned col) -> Lsp::Position {
+        const auto row = line > 0 ? line - 1 : 0;
+        const auto text = line_of(script, row);
+        const auto bytes = std::min<std::size_t>(col > 0 ? col - 1 : 0, text.size());
+        return {.line=row, .col=utf16_len(text.substr(0, bytes))};
+    }
+
+    auto line_end(const Lsp::Script &script, const unsigned row) -> Lsp::Position {
+        return {.line=row, .col=utf16_len(line_of(script, row))};
+    }
+
+    /**
+     * @brief the line `row` without its indentation.
+     */
+    auto line_span(const Lsp::Script &script, const unsigned row) -> Lsp::Range {
+        const auto text = line_of(script, row);
+        const auto first = std::min(text.find_first_not_of(" \t"), text.size());
+        return {.start={.line=row, .col=utf16_len(text.substr(0, first))}, .end=line_end(script, row)};
+    }
+
+    auto find_word(const std::string_view text, const std::string_view word, std::size_t from) -> std::size_t {
+        for (auto at = text.find(word, from); at != std::string_view::npos; at = text.find(word, at + 1)) {
+            const auto end = at + word.size();
+            if ((at == 0 || !is_ident(text[at - 1])) && (end == text.size() || !is_ident(text[end]))) {
+                return at;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    /**
+     * @brief `name` on the parser's line, from its column on, since labels, jumps and defines start with a keyword.
+     */
+    auto name_range(const Lsp::Script &script, const unsigned line, const unsigned col, const std::string_view name)
+        -> Lsp::Range {
+        const auto row = line > 0 ? line - 1 : 0;
+        const auto text = line_of(script, row);
+        auto at = find_word(text, name, col > 0 ? col - 1 : 0);
+        if (at == std::string_view::npos) {
+            at = find_word(text, name, 0);
+        }
+        if (at == std::string_view::npos) {
+            const auto pos = position(script, line, col);
+            return {.start=pos, .end=pos};
+        }
+        const auto start = utf16_len(text.substr(0, at));
+        return {.start={.line=row, .col=start}, .end={.line=row, .col=start + utf16_len(name)}};
+    }
+
+    /**
+     * @brief the "(line:col)" that tok_pos puts in parse errors.
+     */
+    auto error_position(const std::string_view message) -> std::optional<std::pair<unsigned, unsigned>> {
+        const auto *end = message.data() + message.size();
+        for (auto open = message.find('('); open != std::string_view::npos; open = message.find('(', open + 1)) {
+            unsigned line = 0;
+            unsigned col = 0;
+            const auto [colon, line_ec] = std::from_chars(message.data() + open + 1, end, line);
+            if (line_ec != std::errc{} || colon == end || *colon != ':') {
+                continue;
+            }
+            const auto [close, col_ec] = std::from_chars(colon + 1, end, col);
+            if (col_ec != std::errc{} || close == end || *close != ')') {
+                continue;
+            }
+            return std::pair{line, col};
+        }
+        return std::nullopt;
+    }
+
+    auto path_of(std::string_view uri) -> std::optional<std::filesystem::path> {
+        constexpr std::string_view scheme = "file://";
+        if (!uri.starts_with(scheme)) {
+            return std::nullopt;
+        }
+        uri.remove_prefix(scheme.size());
+
+        std::string decoded;
+        decoded.reserve(uri.size());
+        for (std::size_t i = 0; i < uri.size(); ++i) {
+            unsigned byte = 0;
+            if (uri[i] == '%' && i + 2 < uri.size()
+                && std::from_chars(uri.data() + i + 1, uri.data() + i + 3, byte, 16).ptr == uri.data() + i + 3) {
+                decoded += static_cast<char>(byte);
+                i += 2;
+            } else {
+                decoded += uri[i];
+            }
+        }
+        // file:///C:/... on Windows
+        if (decoded.size() > 2 && decoded[0] == '/' && decoded[2] == ':') {
+            decoded.erase(0, 1);
+        }
+        return std::filesystem::path(decoded).lexically_normal();
+    }
+
+    auto uri_of(const std::filesystem::path &path) -> std::string {
+        const auto generic = path.generic_string();
+        std::string uri = "file://";
+        if (!generic.starts_with('/')) {
+            uri += '/';
+        }
+        for (const char c : generic) {
+            if (std::isalnum(static_cast<unsigned char>(c)) || std::string_view("/-._~:").contains(c)) {
+                uri += c;
+            } else {
+                std::format_to(std::back_inserter(uri), "%{:02X}", static_cast<unsigned char>(c));
+            }
+        }
+        return uri;
+    }
+
+    auto read_script(const std::filesystem::path &path) -> std::optional<std::string> {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return std::nullopt;
+        }
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    auto position_param(const Json::Value &pos) -> Lsp::Position {
+        return {
+            .line=static_cast<unsigned>(pos["line"].number().value_or(0)),
+            .col=static_cast<unsigned>(pos["character"].number().value_or(0)),
+        };
+    }
+
+    void write_range(std::string &out, const Lsp::Range &range) {
+        std::format_to(std::back_inserter(out), R"({{"start":{{"line":{},"character":{}}},"end":{{"line":{},"character":{}}}}})",
+            range.start.line, range.start.col, range.end.line, range.end.col);
+    }
+
+    void write_symbol(std::string &out, const Lsp::Script &script, const unsigned idx) {
+        const auto &symbol = script.outline[idx];
+        out += R"({"name":)";
+        Json::write_string_to(std::back_inserter(out), symbol.name);
+        out += R"(,"detail":)";
+        Json::write_string_to(std::back_inserter(out), symbol.detail);
+        std::format_to(std::back_inserter(out), R"(,"kind":{},"range":)", symbol.kind);
+        write_range(out, symbol.range);
+        out += R"(,"selectionRange":)";
+        write_range(out, symbol.selection);
+        out += R"(,"children":[)";
+        for (std::size_t i = 0; i < symbol.children.size(); ++i) {
+            if (i > 0) {
+                out += ',';
+            }
+            write_symbol(out, script, symbol.children[i]);
+        }
+        out += "]}";
+    }
+
+    /**
+     * @brief the labels, menus and choices of the script, nested the way they are in the graph.
+     */
+    void build_outline(Lsp::Script &script, const Graph &graph) {
+        const auto &nodes = graph.get_nodes();
+        std::vector<unsigned> symbol_of(nodes.size(), NONE);
+
+        for (unsigned i = 0; i < nodes.size(); ++i) {
+            const auto *node = nodes[i].get();
+            if (node == nullptr) {
+                continue;
+            }
+            const auto [line, col] = node->line_and_col();
+            const auto row = line > 0 ? line - 1 : 0;
+
+            Lsp::Symbol symbol;
+            if (const auto *label = dynamic_cast<const NodeLabel*>(node)) {
+                symbol.name = label->get_name();
+                symbol.detail = "label";
+                symbol.kind = KIND_FUNCTION;
+                symbol.selection = name_range(script, line, col, label->get_name());
+            } else if (const auto *menu = dynamic_cast<const NodeMenu*>(node)) {
+                symbol.name = "menu";
+                symbol.detail = menu->get_text().value_or("");
+                symbol.kind = KIND_ENUM;
+                symbol.selection = name_range(script, line, col, "menu");
+            } else if (const auto *choice = dynamic_cast<const NodeChoice*>(node)) {
+                // the protocol doesn't allow empty names
+                symbol.name = choice->get_text().empty() ? "\"\"" : choice->get_text();
+                symbol.kind = KIND_ENUM_MEMBER;
+                symbol.selection = line_span(script, row);
+            } else {
+                continue;
+            }
+
+            // the block runs until the next statement that isn't indented further
+            auto last = i;
+            for (auto j = i + 1; j < nodes.size(); ++j) {
+                if (nodes[j] == nullptr) {
+                    continue;
+                }
+                if (nodes[j]->indent <= node->indent) {
+                    break;
+                }
+                last = j;
+            }
+            const auto last_line = nodes[last]->line_and_col().first;
+            symbol.range = {
+                .start=line_span(script, row).start,
+                .end=line_end(script, std::max(last_line > 0 ? last_line - 1 : 0, row)),
+            };
+
+            auto parent = node->parent;
+            while (parent && *parent < i && nodes[*parent] != nullptr && symbol_of[*parent] == NONE) {
+                parent = nodes[*parent]->parent;
+            }
+            const auto idx = static_cast<unsigned>(script.outline.size());
+            if (parent && *parent < i && symbol_of[*parent] != NONE) {
+                script.outline[symbol_of[*parent]].children.push_back(idx);
+            } else {
+                script.outline_roots.push_back(idx);
+            }
+            symbol_of[i] = idx;
+            script.outline.push_back(std::move(symbol));
+        }
+    }
+}
+
+Lsp::Lsp(std::ostream &out, std::optional<std::filesystem::path> root)
+    : out(out) {
+    if (root) {
+        roots.push_back(std::filesystem::absolute(*root).lexically_normal());
+    }
+}
+
+void Lsp::send(const std::string_view body) {
+    std::print(out, "Content-Length: {}\r\n\r\n{}", body.size(), body);
+    out.flush();
+}
+
+void Lsp::respond(const Json::Value &id, const std::string_view result) {
+    send(std::format(R"({{"jsonrpc":"2.0","id":{},"result":{}}})", Json::dump(id), result));
+}
+
+void Lsp::respond_error(const Json::Value &id, const int code, const std::string_view message) {
+    auto body = std::format(R"({{"jsonrpc":"2.0","id":{},"error":{{"code":{},"message":)", Json::dump(id), code);
+    Json::write_string_to(std::back_inserter(body), message);
+    body += "}}";
+    send(body);
+}
+
+auto Lsp::parse(const std::filesystem::path &path, std::string text) -> Parsed {
+    const Profiler::FileScope file_scope(path);
+
+    Parsed parsed;
+    auto &script = parsed.script;
+    script.path = path;
+    script.text = std::move(text);
+    script.line_starts = find_line_starts(script.text);
+    parsed.labels.file = path;
+    parsed.characters.file = path;
+
+    try {
+        auto lexer = Lexer::from_source(script.text);
+        const Graph graph(std::move(lexer.get_tokens()));
+        script.errors = graph.get_errors();
+        parsed.labels = LabelIndex::collect(path, graph);
+        parsed.characters = LabelIndex::collect_characters(path, graph);
+        build_outline(script, graph);
+    } catch (const std::exception &e) {
+        // one broken script shouldn't take the server down with it
+        script.errors = {std::format("parser failed: {}", e.what())};
+    }
+    return parsed;
+}
+
+void Lsp::add(Parsed parsed) {
+    labels.update(std::move(parsed.labels));
+    characters.update(std::move(parsed.characters));
+    auto path = parsed.script.path;
+    scripts.insert_or_assign(std::move(path), std::move(parsed.script));
+}
+
+void Lsp::load_project() {
+    const Profiler::Scope scope("lsp load");
+
+    std::vector<std::filesystem::path> paths;
+    for (const auto &root : roots) {
+        for (const auto &script : list_scripts(root)) {
+            paths.push_back(script.lexically_normal());
+        }
+    }
+
+    ThreadPool pool;
+    const auto max_in_flight = pool.size() * 2;
+    std::deque<std::future<Parsed>> in_flight;
+
+    for (const auto &path : paths) {
+        if (in_flight.size() >= max_in_flight) {
+            add(in_flight.front().get());
+            in_flight.pop_front();
+        }
+        in_flight.push_back(pool.submit([path] -> Parsed {
+            return parse(path, read_script(path).value_or(""));
+        }));
+    }
+    for (auto &f : in_flight) {
+        add(f.get());
+    }
+}
+
+void Lsp::replace(const std::filesystem::path &path, std::string text, const std::optional<double> version) {
+    const Profiler::Scope scope("lsp reparse");
+
+    // labels that were added or removed can change what other scripts' jumps resolve to
+    std::vector<std::string> before;
+    if (const auto *symbols = labels.symbols(path)) {
+        for (const auto &label : symbols->labels) {
+            before.push_back(label.name);
+        }
+    }
+
+    auto parsed = parse(path, std::move(text));
+    parsed.script.version = version;
+    std::vector<std::string> after;
+    for (const auto &label : parsed.labels.labels) {
+        after.push_back(label.name);
+    }
+    add(std::move(parsed));
+
+    std::ranges::sort(before);
+    std::ranges::sort(after);
+    std::vector<std::string> changed;
+    std::ranges::set_symmetric_difference(before, after, std::back_inserter(changed));
+
+    republish(changed, path);
+}
+
+void Lsp::remove(const std::filesystem::path &path) {
+    const auto found = scripts.find(path);
+    if (found == scripts.end()) {
+        return;
+    }
+
+    std::vector<std::string> names;
+    if (const auto *symbols = labels.symbols(path)) {
+        for (const auto &label : symbols->labels) {
+            names.push_back(label.name);
+        }
+    }
+    labels.remove(path);
+    characters.remove(path);
+    scripts.erase(found);
+
+    auto body = std::string(R"({"jsonrpc":"2.0","method":"textDocument/publishDiagnostics","params":{"uri":)");
+    Json::write_string_to(std::back_inserter(body), uri_of(path));
+    body += R"(,"diagnostics":[]}})";
+    send(body);
+    republish(names);
+}
+
+auto Lsp::script_of(const Json::Value &params) -> Script* {
+    const auto path = path_of(params["textDocument"]["uri"].string().value_or(""));
+    if (!path) {
+        return nullptr;
+    }
+    const auto found = scripts.find(*path);
+    return found != scripts.end() ? &found->second : nullptr;
+}
+
+auto Lsp::symbol_at(const Script &script, const Position pos) const
+    -> std::optional<std::pair<const LabelIndex*, std::string>> {
+    const auto text = line_of(script, pos.line);
+    auto at = byte_of(text, pos.col);
+    // the cursor can be just past the end of the word
+    if ((at >= text.size() || !is_ident(text[at])) && at > 0 && is_ident(text[at - 1])) {
+        --at;
+    }
+    if (at >= text.size() || !is_ident(text[at])) {
+        return std::nullopt;
+    }
+    auto first = at;
+    auto last = at;
+    while (first > 0 && is_ident(text[first - 1])) {
+        --first;
+    }
+    while (last < text.size() && is_ident(text[last])) {
+        ++last;
+    }
+    auto word = std::string(text.substr(first, last - first));
+
+    // what the parser found on this line decides first, then whichever index knows the name
+    const auto line = pos.line + 1;
+    const auto here = [&](const LabelIndex::Symbol &symbol) -> bool {
+        return symbol.line == line && symbol.name == word;
+    };
+    for (const auto *index : {&labels, &characters}) {
+        if (const auto *symbols = index->symbols(script.path);
+            symbols && (std::ranges::any_of(symbols->labels, here) || std::ranges::any_of(symbols->targets, here))) {
+            return std::pair{index, std::move(word)};
+        }
+    }
+    for (const auto *index : {&labels, &characters}) {
+        if (!index->find(word).empty() || !index->references(word).empty()) {
+            return std::pair{index, std::move(word)};
+        }
+    }
+    return std::nullopt;
+}
+
+void Lsp::write_locations(std::string &result, const std::span<const LabelIndex::Site> sites, const std::string_view name) const {
+    for (const auto &site : sites) {
+        if (result.size() > 1) {
+            result += ',';
+        }
+        result += R"({"uri":)";
+        Json::write_string_to(std::back_inserter(result), uri_of(site.file));
+        result += R"(,"range":)";
+        if (const auto found = scripts.find(site.file); found != scripts.end()) {
+            write_range(result, name_range(found->second, site.line, site.col, name));
+        } else {
+            const Position pos{.line=site.line > 0 ? site.line - 1 : 0, .col=site.col > 0 ? site.col - 1 : 0};
+            write_range(result, {.start=pos, .end=pos});
+        }
+        result += '}';
+    }
+}
+
+void Lsp::publish(const Script &script, const bool when_clean) {
+    std::string diagnostics;
+    const auto add_diagnostic = [&](const Range &range, const int severity, const std::string_view message) -> void {
+        if (!diagnostics.empty()) {
+            diagnostics += ',';
+        }
+        diagnostics += R"({"range":)";
+        write_range(diagnostics, range);
+        std::format_to(std::back_inserter(diagnostics), R"(,"severity":{},"source":"rpy","message":)", severity);
+        Json::write_string_to(std::back_inserter(diagnostics), message);
+        diagnostics += '}';
+    };
+
+    for (const auto &error : script.errors) {
+        Range range{};
+        if (const auto at = error_position(error)) {
+            // to the end of the line, so there's something to underline
+            range.start = position(script, at->first, at->second);
+            const auto end = line_end(script, range.start.line);
+            range.end = end.col > range.start.col ? end : range.start;
+        }
+        auto message = std::string_view(error);
+        while (!message.empty() && message.back() == ' ') {
+            message.remove_suffix(1);
+        }
+        add_diagnostic(range, SEVERITY_ERROR, message);
+    }
+
+    if (const auto *symbols = labels.symbols(script.path)) {
+        for (const auto &target : symbols->targets) {
+            if (labels.find(target.name).empty()) {
+                add_diagnostic(name_range(script, target.line, target.col, target.name), SEVERITY_WARNING,
+                    std::format("no label named {}", target.name));
+            }
+        }
+        for (const auto &label : symbols->labels) {
+            const auto sites = labels.find(label.name);
+            const auto other = std::ranges::find_if(sites, [&](const LabelIndex::Site &site) -> bool {
+                return site.file != script.path || site.line != label.line;
+            });
+            if (other != sites.end()) {
+                add_diagnostic(name_range(script, label.line, label.col, label.name), SEVERITY_WARNING,
+                    std::format("label {} is also defined at {}:{}", label.name, other->file.filename().string(), other->line));
+            }
+        }
+    }
+
+    if (diagnostics.empty() && !when_clean) {
+        return;
+    }
+
+    auto body = std::string(R"({"jsonrpc":"2.0","method":"textDocument/publishDiagnostics","params":{"uri":)");
+    Json::write_string_to(std::back_inserter(body), uri_of(script.path));
+    if (script.version) {
+        std::format_to(std::back_inserter(body), R"(,"version":{})", *script.version);
+    }
+    std::format_to(std::back_inserter(body), R"(,"diagnostics":[{}]}}}})", diagnostics);
+    send(body);
+}
+
+void Lsp::republish(const std::span<const std::string> names, const std::filesystem::path &also) {
+    std::vector<std::filesystem::path> affected{also};
+    for (const auto &name : names) {
+        for (const auto &site : labels.find(name)) {
+            affected.push_back(site.file);
+        }
+        for (const auto &site : labels.references(name)) {
+            affected.push_back(site.file);
+        }
+    }
+    std::ranges::sort(affected);
+    const auto [first, last] = std::ranges::unique(affected);
+    affected.erase(first, last);
+
+    for (const auto &path : affected) {
+        if (const auto found = scripts.find(path); found != scripts.end()) {
+            publish(found->second);
+        }
+    }
+}
+
+void Lsp::initialize(const Json::Value &id, const Json::Value &params) {
+    std::vector<std::filesystem::path> given;
+    for (const auto &folder : params["workspaceFolders"].array()) {
+        if (auto path = path_of(folder["uri"].string().value_or(""))) {
+            given.push_back(std::move(*path));
+        }
+    }
+    if (given.empty()) {
+        if (auto path = path_of(params["rootUri"].string().value_or(""))) {
+            given.push_back(std::move(*path));
+        } else if (const auto root_path = params["rootPath"].string()) {
+            given.push_back(std::filesystem::path(*root_path).lexically_normal());
+        }
+    }
+    if (!given.empty()) {
+        roots = std::move(given);
+    }
+
+    load_project();
+    initialized = true;
+
+    respond(id, R"({"capabilities":{)"
+        R"("textDocumentSync":{"openClose":true,"change":2},)"
+        R"("definitionProvider":true,"referencesProvider":true,"documentSymbolProvider":true},)"
+        R"("serverInfo":{"name":"rpy_proj_analyzer"}})");
+}
+
+void Lsp::definition(const Json::Value &id, const Json::Value &params) {
+    std::string result = "[";
+    if (const auto *script = script_of(params)) {
+        if (const auto symbol = symbol_at(*script, position_param(params["position"]))) {
+            const auto &[index, name] = *symbol;
+            write_locations(result, index->find(name), name);
+        }
+    }
+    result += ']';
+    respond(id, result);
+}
+
+void Lsp::references(const Json::Value &id, const Json::Value &params) {
+    std::string result = "[";
+    if (const auto *script = script_of(params)) {
+        if (const auto symbol = symbol_at(*script, position_param(params["position"]))) {
+            const auto &[index, name] = *symbol;
+            if (params["context"]["includeDeclaration"].boolean().value_or(false)) {
+                write_locations(result, index->find(name), name);
+            }
+            write_locations(result, index->references(name), name);
+        }
+    }
+    result += ']';
+    respond(id, result);
+}
+
+void Lsp::document_symbols(const Json::Value &id, const Json::Value &params) {
+    std::string result = "[";
+    if (const auto *script = script_of(params)) {
+        for (std::size_t i = 0; i < script->outline_roots.size(); ++i) {
+            if (i > 0) {
+                result += ',';
+            }
+            write_symbol(result, *script, script->outline_roots[i]);
+        }
+    }
+    result += ']';
+    respond(id, result);
+}
+
+void Lsp::did_open(const Json::Value &params) {
+    const auto &doc = params["textDocument"];
+    const auto path = path_of(doc["uri"].string().value_or(""));
+    if (!path) {
+        return;
+    }
+    auto text = std::string(doc["text"].string().value_or(""));
+    const auto version = doc["version"].number();
+
+    // usually nothing changed since the project was loaded
+    if (const auto found = scripts.find(*path); found != scripts.end() && found->second.text == text) {
+        found->second.version = version;
+        publish(found->second);
+        return;
+    }
+    replace(*path, std::move(text), version);
+}
+
+void Lsp::did_change(const Json::Value &params) {
+    const auto *script = script_of(params);
+    if (script == nullptr) {
+        return;
+    }
+    const auto path = script->path;
+
+    auto text = script->text;
+    for (const auto &change : params["contentChanges"].array()) {
+        const auto new_text = change["text"].string().value_or("");
+        const auto &range = change["range"];
+        if (range.is_null()) {
+            text = new_text;
+            continue;
+        }
+        const auto start = offset_of(text, position_param(range["start"]));
+        const auto end = std::max(start, offset_of(text, position_param(range["end"])));
+        text.replace(start, end - start, new_text);
+    }
+    replace(path, std::move(text), params["textDocument"]["version"].number());
+}
+
+void Lsp::did_close(const Json::Value &params) {
+    auto *script = script_of(params);
+    if (script == nullptr) {
+        return;
+    }
+    const auto path = script->path;
+
+    // the editor may have thrown its changes away, so go back to what's on disk
+    auto text = read_script(path);
+    if (!text) {
+        remove(path);
+    } else if (*text != script->text) {
+        replace(path, std::move(*text), std::nullopt);
+    } else {
+        script->version.reset();
+    }
+}
+
+void Lsp::did_change_watched(const Json::Value &params) {
+    for (const auto &change : params["changes"].array()) {
+        const auto path = path_of(change["uri"].string().value_or(""));
+        if (!path || path->extension() != ".rpy") {
+            continue;
+        }
+        // while it's open, the editor's copy is the one that counts
+        if (const auto found = scripts.find(*path); found != scripts.end() && found->second.version) {
+            continue;
+        }
+        constexpr double DELETED = 3; // FileChangeType
+        if (change["type"].number() == DELETED) {
+            remove(*path);
+        } else if (auto text = read_script(*path)) {
+            replace(*path, std::move(*text), std::nullopt);
+        }
+    }
+}
+
+auto Lsp::read_message(std::istream &in) -> std::optional<std::string> {
+    constexpr std::string_view content_length = "Content-Length:";
+    std::optional<std::size_t> length;
+    std::string line;
+
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            if (line.starts_with(content_length)) {
+                auto value = std::string_view(line).substr(content_length.size());
+                while (!value.empty() && value.front() == ' ') {
+                    value.remove_prefix(1);
+                }
+                std::size_t n = 0;
+                if (std::from_chars(value.data(), value.data() + value.size(), n).ec == std::errc{}) {
+                    length = n;
+                }
+            }
+            continue;
+        }
+        // the blank line ending the headers
+        if (!length) {
+            continue;
+        }
+        std::string body(*length, '\0');
+        if (!in.read(body.data(), static_cast<std::streamsize>(body.size()))) {
+            return std::nullopt;
+        }
+        return body;
+    }
+    return std::nullopt;
+}
+
+auto Lsp::handle(const Json::Value &message) -> bool {
+    const Profiler::Scope scope("lsp message");
+
+    const auto method = message["method"].string().value_or("");
+    const auto &id = message["id"];
+    const auto &params = message["params"];
+    const bool is_request = !id.is_null();
+
+    if (method == "exit") {
+        return false;
+    }
+    if (method.empty()) {
+        // a response, and this never sends requests
+        return true;
+    }
+    if (!initialized && method != "initialize") {
+        if (is_request) {
+            respond_error(id, SERVER_NOT_INITIALIZED, "the server hasn't been initialized");
+        }
+        return true;
+    }
+    if ((initialized && method == "initialize") || (shut_down && is_request)) {
+        respond_error(id, INVALID_REQUEST, std::format("{} isn't allowed now", method));
+        return true;
+    }
+
+    if (method == "initialize") {
+        initialize(id, params);
+    } else if (method == "initialized") {
+        for (const auto &script : scripts | std::views::values) {
+            publish(script, false);
+        }
+    } else if (method == "shutdown") {
+        shut_down = true;
+        respond(id, "null");
+    } else if (method == "textDocument/definition") {
+        definition(id, params);
+    } else if (method == "textDocument/references") {
+        references(id, params);
+    } else if (method == "textDocument/documentSymbol") {
+        document_symbols(id, params);
+    } else if (method == "textDocument/didOpen") {
+        did_open(params);
+    } else if (method == "textDocument/didChange") {
+        did_change(params);
+    } else if (method == "textDocument/didClose") {
+        did_close(params);
+    } else if (method == "workspace/didChangeWatchedFiles") {
+        did_change_watched(params);
+    } else if (is_request) {
+        respond_error(id, METHOD_NOT_FOUND, std::format("{} isn't supported", method));
+    }
+    return true;
+}
+
+auto Lsp::exit_code() const -> int {
+    return shut_down ? 0 : 1;
+}
+
+auto Lsp::run(std::istream &in, std::ostream &out, std::optional<std::filesystem::path> root) -> int {
+    Lsp server(out, std::move(root));
+    while (const auto body = read_message(in)) {
+        const auto message = Json::parse(*body);
+        if (!message) {
+            server.respond_error(Json::Value{}, PARSE_ERROR, message.error());
+            continue;
+        }
+        if (!server.handle(*message)) {
+            break;
+        }
+    }
+    return server.exit_code();
+}
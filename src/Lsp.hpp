@@ -0,0 +1,152 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_LSP_HPP
+#define RPY_PROJ_ANALYZER_LSP_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Json.hpp"
+#include "LabelIndex.hpp"
+
+/**
+ * @brief A language server for scripts, over stdin / stdout (`--lsp`).
+ *
+ * On `initialize` every script in the workspace is parsed on a thread pool, as
+ * in Batch, and cut down to a Script: its text, outline and errors, plus its
+ * entries in the label and character indexes. The graphs aren't kept. After
+ * that an edit reparses only the edited script and swaps its entries in the
+ * indexes, so definitions, references, symbols and diagnostics are all answered
+ * from memory.
+ *
+ * Positions are the protocol's: lines from 0, columns in UTF-16 code units.
+ */
+class Lsp {
+public:
+    struct Position {
+        unsigned line = 0;
+        unsigned col = 0;
+    };
+
+    struct Range {
+        Position start;
+        Position end;
+    };
+
+    /**
+     * @brief a label, menu or choice in a script's outline.
+     */
+    struct Symbol {
+        std::string name;
+        std::string detail;
+        std::uint8_t kind = 0; // an LSP SymbolKind
+        Range range;           // the whole block
+        Range selection;       // just the name
+        std::vector<unsigned> children; // indices into Script::outline
+    };
+
+    struct Script {
+        std::filesystem::path path;
+        std::string text;
+        std::vector<std::size_t> line_starts;
+        std::optional<double> version; // set while the editor has it open
+        std::vector<Symbol> outline;
+        std::vector<unsigned> outline_roots;
+        std::vector<std::string> errors;
+    };
+
+private:
+    struct Parsed;
+
+    std::ostream &out;
+    std::vector<std::filesystem::path> roots;
+    std::unordered_map<std::filesystem::path, Script> scripts;
+    LabelIndex labels;
+    LabelIndex characters;
+    bool initialized = false;
+    bool shut_down = false;
+
+    void send(std::string_view body);
+    void respond(const Json::Value &id, std::string_view result);
+    void respond_error(const Json::Value &id, int code, std::string_view message);
+
+    /**
+     * @brief parses `text` as the script at `path`. Safe to call from any thread.
+     */
+    static auto parse(const std::filesystem::path &path, std::string text) -> Parsed;
+
+    void add(Parsed parsed);
+    void load_project();
+    void replace(const std::filesystem::path &path, std::string text, std::optional<double> version);
+    void remove(const std::filesystem::path &path);
+
+    [[nodiscard]] auto script_of(const Json::Value &params) -> Script*;
+
+    /**
+     * @brief the label or character under `pos`, and the index it's in.
+     */
+    [[nodiscard]] auto symbol_at(const Script &script, Position pos) const
+        -> std::optional<std::pair<const LabelIndex*, std::string>>;
+
+    void write_locations(std::string &result, std::span<const LabelIndex::Site> sites, std::string_view name) const;
+
+    /**
+     * @brief sends the script's diagnostics: parse errors, jumps to missing labels and duplicate labels.
+     * @param when_clean whether to send them even if there are none, to clear old ones.
+     */
+    void publish(const Script &script, bool when_clean = true);
+
+    /**
+     * @brief publishes again for `also` and every script that defines or jumps to one of `names`.
+     */
+    void republish(std::span<const std::string> names, const std::filesystem::path &also = {});
+
+    void initialize(const Json::Value &id, const Json::Value &params);
+    void definition(const Json::Value &id, const Json::Value &params);
+    void references(const Json::Value &id, const Json::Value &params);
+    void document_symbols(const Json::Value &id, const Json::Value &params);
+    void did_open(const Json::Value &params);
+    void did_change(const Json::Value &params);
+    void did_close(const Json::Value &params);
+    void did_change_watched(const Json::Value &params);
+
+public:
+    /**
+     * @param root the workspace to load if the client doesn't name one.
+     */
+    explicit Lsp(std::ostream &out, std::optional<std::filesystem::path> root = std::nullopt);
+
+    /**
+     * @brief the body of the next message, or nothing once the input ends.
+     */
+    static auto read_message(std::istream &in) -> std::optional<std::string>;
+
+    /**
+     * @brief answers one request or takes in one notification.
+     * @return false once the client has sent `exit`.
+     */
+    auto handle(const Json::Value &message) -> bool;
+
+    /**
+     * @brief 0 if the client asked to shut down before exiting, 1 if not, as the protocol asks.
+     */
+    [[nodiscard]] auto exit_code() const -> int;
+
+    /**
+     * @brief serves messages from `in` until `exit` or the end of the input.
+     */
+    static auto run(std::istream &in, std::ostream &out, std::optional<std::filesystem::path> root) -> int;
+};
+
+#endif //RPY_PROJ_ANALYZER_LSP_HPP
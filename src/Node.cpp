@@ -5,11 +5,38 @@
 #include "Node.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <format>
+#include <iterator>
 #include <utility>
 
 #include "Typing.hpp"
 
+namespace {
+    // reused by every TokenText on the thread, so building a string only allocates the result
+    thread_local std::string tok_buf;
+}
+
+TokenText::TokenText(const std::span<const Token> toks)
+    : toks(toks) {
+}
+
+auto TokenText::raw() const -> std::string {
+    tok_buf.clear();
+    for (const auto &t : toks) {
+        std::format_to(std::back_inserter(tok_buf), "{:r} ", t);
+    }
+    return tok_buf;
+}
+
+auto TokenText::colored() const -> std::string {
+    tok_buf.clear();
+    for (const auto &t : toks) {
+        std::format_to(std::back_inserter(tok_buf), "{:cr} ", t);
+    }
+    return tok_buf;
+}
+
 auto operator<<(std::ostream& o, const Node& node) -> std::ostream& {
     o << std::string(node.indent, '\t') << node.to_string();
     return o;
@@ -97,7 +124,7 @@ auto NodeShow::to_string() const -> std::string {
     return ret;
 }
 
-auto NodeShow::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeShow::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
     fields.reserve(1 + attrs.size() + transforms.size());
     if (is_scene) {
@@ -135,7 +162,7 @@ auto NodeShow::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
         }
         fields.push_back(atl_str);
     }
-    return {this, rect, is_scene ? "Scene" : "Show", std::move(fields)};
+    return {is_scene ? "Scene" : "Show", std::move(fields)};
 }
 
 NodeHide::NodeHide(const Tok& token, std::string name, std::optional<std::string> onlayer)
@@ -147,39 +174,30 @@ auto NodeHide::to_string() const -> std::string {
     return ret;
 }
 
-auto NodeHide::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeHide::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
     fields.reserve(1);
     fields.push_back(std::format("Character: {}", name));
-    return {this, rect, "Hide", std::move(fields)};
+    return {"Hide", std::move(fields)};
 }
 
 NodeWith::NodeWith(const Tok& token, std::span<const Token> expr_toks)
-    : Node(token),
-    expr_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-        out += std::format("{:r} ", t);
-        return out;
-    })),
-    display_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-        out += std::format("{:cr} ", t);
-        return out;
-    })) {
+    : Node(token), text(expr_toks) {
     trans = *fold_into_expr(expr_toks);
 }
 
 NodeWith::NodeWith(const Tok& token, const Transition& trans)
     : Node(token),
     trans(std::make_unique<ExprLit>(ATL::trans_str(trans))),
-    expr_str(ATL::trans_str(trans)),
-    display_str(ATL::trans_str(trans)) {
+    trans_str(ATL::trans_str(trans)) {
 }
 
 auto NodeWith::to_string() const -> std::string {
-    return std::format("With: {}", expr_str);
+    return std::format("With: {}", trans_str.empty() ? text.raw() : trans_str);
 }
 
-auto NodeWith::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
-    return {this, rect, "With", {display_str}};
+auto NodeWith::display_fields() const -> NodeFields {
+    return {"With", {trans_str.empty() ? text.colored() : trans_str}};
 }
 
 NodeMenu::NodeMenu(const Tok& token, const std::optional<std::string>& text, const std::optional<std::string>& set)
@@ -197,12 +215,16 @@ auto NodeMenu::to_string() const -> std::string {
     return ret;
 }
 
-auto NodeMenu::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeMenu::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
     fields.reserve(text.has_value() + set.has_value());
     if (text) { fields.push_back(std::format("\"{}\"", *text)); }
     if (set) { fields.push_back(std::format("Using set: {}", *set)); }
-    return {this, rect, "Menu", std::move(fields)};
+    return {"Menu", std::move(fields)};
+}
+
+auto NodeMenu::get_text() const -> const std::optional<std::string>& {
+    return text;
 }
 
 NodeChoice::NodeChoice(const Tok& token, std::string text)
@@ -210,15 +232,7 @@ NodeChoice::NodeChoice(const Tok& token, std::string text)
 }
 
 NodeChoice::NodeChoice(const Tok& token, std::string text, std::span<const Token> expr_toks)
-    : NodeParent(token), text(std::move(text)),
-    expr_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-        out += std::format("{:r} ", t);
-        return out;
-    })),
-    display_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-        out += std::format("{:r} ", t);
-        return out;
-    })) {
+    : NodeParent(token), text(std::move(text)), clause_text(expr_toks) {
     clause = *fold_into_expr(expr_toks);
 }
 
@@ -226,14 +240,18 @@ auto NodeChoice::to_string() const -> std::string {
     return std::format("Choice: \"{}\"", text);
 }
 
-auto NodeChoice::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeChoice::display_fields() const -> NodeFields {
     if (clause != nullptr) {
-        return {this, rect, "Choice", {
+        return {"Choice", {
             std::format("\"{}\"", text),
-            std::format("Clause: {}", *display_str),
+            std::format("Clause: {}", clause_text.raw()),
         }};
     }
-    return {this, rect, "Choice", {std::format("\"{}\"", text)}};
+    return {"Choice", {std::format("\"{}\"", text)}};
+}
+
+auto NodeChoice::get_text() const -> const std::string& {
+    return text;
 }
 
 NodeLabel::NodeLabel(const Tok& token, std::string name)
@@ -244,8 +262,12 @@ auto NodeLabel::to_string() const -> std::string {
     return std::format("Label: \"{}\"", name);
 }
 
-auto NodeLabel::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
-    return {this, rect, "Label", {name}};
+auto NodeLabel::display_fields() const -> NodeFields {
+    return {"Label", {name}};
+}
+
+auto NodeLabel::get_name() const -> const std::string& {
+    return name;
 }
 
 auto NodeDialogue::count_words() const -> int {
@@ -276,28 +298,25 @@ auto NodeDialogue::to_string() const -> std::string {
     return std::format("\"{}\"", text);
 }
 
-auto NodeDialogue::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeDialogue::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
     fields.reserve(name.has_value() + 1); // text is always filled next
     if (name) { fields.push_back(std::format("Character: {}", *name)); }
     fields.push_back(std::format("\"{}\"", text));
-    return {this, rect, "Dialogue", std::move(fields)};
+    return {"Dialogue", std::move(fields)};
+}
+
+auto NodeDialogue::get_name() const -> const std::optional<std::string>& {
+    return name;
 }
 
 NodeExpr::NodeExpr(const Tok& token, const std::span<const Token> expr_toks)
     : Node(token),
-      expr_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format("{:r} ", t);
-          return out;
-      })),
-      display_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format("{:cr} ", t);
-          return out;
-      })),
-      expr(fold_into_expr(expr_toks).value_or(nullptr)) {
+      expr(fold_into_expr(expr_toks).value_or(nullptr)),
+      text(expr_toks) {
     // expr = *fold_into_expr(expr_toks);
     if (const auto t = Typing::deduce_type(expr)) {
-        std::println("{}", *t);
+        Log::info("{}", *t);
     }
     if (is_valid_assign(expr.get())) {
         type = DeclareType::Python;
@@ -307,15 +326,7 @@ NodeExpr::NodeExpr(const Tok& token, const std::span<const Token> expr_toks)
 }
 
 NodeExpr::NodeExpr(const Tok& token, std::span<const Token> expr_toks, std::unique_ptr<Expr> expr, const bool ro)
-    : Node(token), expr(std::move(expr)),
-    expr_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-        out += std::format("{:r} ", t);
-        return out;
-    })),
-    display_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-        out += std::format("{:cr} ", t);
-        return out;
-    })) {
+    : Node(token), expr(std::move(expr)), text(expr_toks) {
     if (ro) {
         type = DeclareType::Define;
     } else {
@@ -325,18 +336,18 @@ NodeExpr::NodeExpr(const Tok& token, std::span<const Token> expr_toks, std::uniq
 
 auto NodeExpr::to_string() const -> std::string {
     if (type == DeclareType::Default) {
-        return std::format("Default Init: {}", expr_str);
+        return std::format("Default Init: {}", text.raw());
     }
     if (type == DeclareType::Define) {
-        return std::format("Define Init: {}", expr_str);
+        return std::format("Define Init: {}", text.raw());
     }
 
-    return std::format("Expression: {}", expr_str);
+    return std::format("Expression: {}", text.raw());
 }
 
-auto NodeExpr::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeExpr::display_fields() const -> NodeFields {
     std::string title;
-    std::vector fields = {display_str};
+    std::vector fields = {text.colored()};
     if (type == DeclareType::Default) {
         title = "Default Init";
     } else if (type == DeclareType::Define) {
@@ -345,7 +356,7 @@ auto NodeExpr::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
         title = "Expression";
     }
 
-    return {this, rect, title, fields};
+    return {std::move(title), std::move(fields)};
 }
 
 auto NodeExpr::get_expr() const -> const std::unique_ptr<Expr>& {
@@ -371,7 +382,7 @@ auto NodePlay::to_string() const -> std::string {
     return std::format("Play {}: \"{}\"", ch_str, path);
 }
 
-auto NodePlay::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodePlay::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
     fields.reserve(2);
     switch (channel) {
@@ -384,51 +395,35 @@ auto NodePlay::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
             break;
     }
     fields.push_back(std::format("File path: \"{}\"", path));
-    return {this, rect, "Play", std::move(fields)};
+    return {"Play", std::move(fields)};
 }
 
 NodeIf::NodeIf(const Tok& token, const std::span<const Token> expr_toks)
-    : NodeParent(token),
-      expr_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format("{:r} ", t);
-          return out;
-      })),
-      color_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format("{:cr} ", t);
-          return out;
-      })) {
+    : NodeParent(token), text(expr_toks) {
     expr = *fold_into_expr(expr_toks);
 }
 
 auto NodeIf::to_string() const -> std::string {
-    return std::format("If: {}", expr_str);
+    return std::format("If: {}", text.raw());
 }
 
-auto NodeIf::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
-    return {this, rect, "If", {color_str}};
+auto NodeIf::display_fields() const -> NodeFields {
+    return {"If", {text.colored()}};
 }
 
 NodeElif::NodeElif(const Tok& token, const std::span<const Token> expr_toks)
-    : NodeParent(token.line, token.col, token.indent),
-      expr_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format("{:r} ", t);
-          return out;
-      })),
-      color_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format("{:cr} ", t);
-          return out;
-      })) {
+    : NodeParent(token.line, token.col, token.indent), text(expr_toks) {
     expr = *fold_into_expr(expr_toks);
 }
 
 auto NodeElif::to_string() const -> std::string {
-    return std::format("Elif: {}", expr_str);
+    return std::format("Elif: {}", text.raw());
 }
 
-auto NodeElif::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeElif::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
-    fields.push_back(color_str);
-    return {this, rect, "Elif", std::move(fields)};
+    fields.push_back(text.colored());
+    return {"Elif", std::move(fields)};
 }
 
 NodeElse::NodeElse(const Tok& token)
@@ -439,32 +434,23 @@ auto NodeElse::to_string() const -> std::string {
     return "Else:";
 }
 
-auto NodeElse::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
-    return DisplayNode(this, rect, "Else");
+auto NodeElse::display_fields() const -> NodeFields {
+    return {"Else", {}};
 }
 
 NodeWhile::NodeWhile(const Tok& token, const std::span<const Token> expr_toks)
-    : NodeParent(token.line, token.col, token.indent),
-      expr_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format("{:r} ", t);
-          return out;
-      })),
-      color_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format(
-              "{:cr} ", t);
-          return out;
-      })) {
+    : NodeParent(token.line, token.col, token.indent), text(expr_toks) {
     expr = *fold_into_expr(expr_toks);
 }
 
 auto NodeWhile::to_string() const -> std::string {
-    return std::format("While: {}", expr_str);
+    return std::format("While: {}", text.raw());
 }
 
-auto NodeWhile::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeWhile::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
-    fields.push_back(color_str);
-    return {this, rect, "While", std::move(fields)};
+    fields.push_back(text.colored());
+    return {"While", std::move(fields)};
 }
 
 NodeReturn::NodeReturn(const Tok& token)
@@ -473,35 +459,25 @@ NodeReturn::NodeReturn(const Tok& token)
 }
 
 NodeReturn::NodeReturn(const Tok& token, const std::span<const Token> expr_toks)
-    : Node(token.line, token.col, token.indent),
-      expr_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format(
-              "{:r} ", t);
-          return out;
-      })),
-      color_str(std::ranges::fold_left(expr_toks, std::string{}, [](std::string out, const Token& t) {
-          out += std::format(
-              "{:cr} ", t);
-          return out;
-      })) {
+    : Node(token.line, token.col, token.indent), text(expr_toks) {
     expr = *fold_into_expr(expr_toks);
 }
 
 auto NodeReturn::to_string() const -> std::string {
     if (expr) {
-        return std::format("Return: {}", expr_str);
+        return std::format("Return: {}", text.raw());
     }
 
     return "Return";
 }
 
-auto NodeReturn::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeReturn::display_fields() const -> NodeFields {
     if (expr) {
         std::vector<std::string> fields;
-        fields.push_back(color_str);
-        return {this, rect, "Return", std::move(fields)};
+        fields.push_back(text.colored());
+        return {"Return", std::move(fields)};
     }
-    return DisplayNode(this, rect, "Return");
+    return {"Return", {}};
 }
 
 NodePass::NodePass(const Tok& token)
@@ -512,8 +488,8 @@ auto NodePass::to_string() const -> std::string {
     return "Pass";
 }
 
-auto NodePass::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
-    return DisplayNode(this, rect, "Pass");
+auto NodePass::display_fields() const -> NodeFields {
+    return {"Pass", {}};
 }
 
 NodeCall::NodeCall(const Tok& token, std::string label)
@@ -524,10 +500,14 @@ auto NodeCall::to_string() const -> std::string {
     return std::format("Call label: {}", label);
 }
 
-auto NodeCall::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeCall::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
     fields.push_back(std::format("Label: {}", label));
-    return {this, rect, "Call", std::move(fields)};
+    return {"Call", std::move(fields)};
+}
+
+auto NodeCall::get_label() const -> const std::string& {
+    return label;
 }
 
 NodeJump::NodeJump(const Tok& token, std::string label)
@@ -538,10 +518,14 @@ auto NodeJump::to_string() const -> std::string {
     return std::format("Jump to label: {}", label);
 }
 
-auto NodeJump::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeJump::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
     fields.push_back(std::format("Label: {}", label));
-    return {this, rect, "Jump", std::move(fields)};
+    return {"Jump", std::move(fields)};
+}
+
+auto NodeJump::get_label() const -> const std::string& {
+    return label;
 }
 
 NodeImage::NodeImage(const Tok& token, std::string char_name, std::vector<std::string> attrs, std::string file_path)
@@ -552,7 +536,7 @@ auto NodeImage::to_string() const -> std::string {
     return std::format(R"(Image "{} {}", path: "{}")", char_name, attrs, file_path);
 }
 
-auto NodeImage::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
+auto NodeImage::display_fields() const -> NodeFields {
     std::vector<std::string> fields;
     fields.reserve(3);
     fields.push_back(std::format("Character: \"{}\"", char_name));
@@ -561,5 +545,5 @@ auto NodeImage::make_display_node(raylib::Rectangle rect) const -> DisplayNode {
         fields.push_back(std::format("\t{}", a));
     }
     fields.push_back(std::format("File path: \"{}\"", file_path));
-    return {this, rect, "Image", std::move(fields)};
+    return {"Image", std::move(fields)};
 }
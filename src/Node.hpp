@@ -6,10 +6,10 @@
 #define RPY_PROJ_ANALYZER_NODE_HPP
 
 #include "ATL.hpp"
-#include "DisplayNode.hpp"
 #include "Expr.hpp"
 #include "Token.hpp"
 
+#include <cstdint>
 #include <format>
 #include <memory>
 #include <optional>
@@ -17,8 +17,6 @@
 #include <string>
 #include <vector>
 
-#include "raylib-cpp.hpp"
-
 enum class AudioChannel : std::uint8_t {
     Music,
     Sfx,
@@ -40,6 +38,38 @@ struct ShowProps {
     std::vector<ATLStmt> atl_stmts;
 };
 
+/**
+ * @brief The tokens of an expression, turned into text only when a node is printed or displayed.
+ *
+ * Points into the tokens of the Graph that made the node, so it is only good
+ * for as long as that Graph is.
+ */
+class TokenText {
+    std::span<const Token> toks;
+
+public:
+    TokenText() = default;
+    explicit TokenText(std::span<const Token> toks);
+
+    /**
+     * @brief the tokens as written in the script, for to_string.
+     */
+    [[nodiscard]] auto raw() const -> std::string;
+
+    /**
+     * @brief the tokens with TextHelper color tags, for display nodes.
+     */
+    [[nodiscard]] auto colored() const -> std::string;
+};
+
+/**
+ * @brief A node's title and the lines under it in the view. Fields can have TextHelper tags.
+ */
+struct NodeFields {
+    std::string title;
+    std::vector<std::string> fields;
+};
+
 class Node {
 protected:
     unsigned line = 0;
@@ -69,7 +99,10 @@ public:
 
     [[nodiscard]] virtual auto has_children() const -> bool;
 
-    [[nodiscard]] virtual auto make_display_node(raylib::Rectangle rect) const -> DisplayNode = 0;
+    /**
+     * @brief what the view shows for the node, see DisplayNode::of.
+     */
+    [[nodiscard]] virtual auto display_fields() const -> NodeFields = 0;
 
     friend auto operator<<(std::ostream& o, const Node& node) -> std::ostream&;
 };
@@ -101,7 +134,7 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeHide final : public Node {
@@ -113,13 +146,13 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeWith final : public Node {
     std::unique_ptr<Expr> trans;
-    std::string expr_str;
-    std::string display_str;
+    TokenText text;
+    std::string trans_str; // only for an ATL transition, which has no tokens
 
 public:
     explicit NodeWith(const Tok& token, std::span<const Token> expr_toks);
@@ -127,7 +160,7 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeMenu final : public NodeParent {
@@ -139,13 +172,14 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
+
+    [[nodiscard]] auto get_text() const -> const std::optional<std::string>&;
 };
 
 class NodeChoice final : public NodeParent {
     std::string text;
-    std::optional<std::string> expr_str;
-    std::optional<std::string> display_str;
+    TokenText clause_text;
     std::unique_ptr<Expr> clause = nullptr;
 
 public:
@@ -154,7 +188,9 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
+
+    [[nodiscard]] auto get_text() const -> const std::string&;
 };
 
 class NodeLabel final : public NodeParent {
@@ -165,7 +201,9 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
+
+    [[nodiscard]] auto get_name() const -> const std::string&;
 };
 
 class NodeScene final : public Node {
@@ -176,7 +214,7 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeDialogue final : public Node {
@@ -194,13 +232,17 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
+
+    /**
+     * @brief the character speaking, unset for narration.
+     */
+    [[nodiscard]] auto get_name() const -> const std::optional<std::string>&;
 };
 
 class NodeExpr final : public Node {
     std::unique_ptr<Expr> expr;
-    std::string expr_str;
-    std::string display_str;
+    TokenText text;
     DeclareType type;
 
 public:
@@ -210,7 +252,7 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 
     auto get_expr() const -> const std::unique_ptr<Expr>&;
 };
@@ -224,33 +266,31 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeIf final : public NodeParent {
     std::unique_ptr<Expr> expr;
-    std::string expr_str;
-    std::string color_str;
+    TokenText text;
 
 public:
     explicit NodeIf(const Tok& token, std::span<const Token> expr_toks);
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeElif final : public NodeParent {
     std::unique_ptr<Expr> expr;
-    std::string expr_str;
-    std::string color_str;
+    TokenText text;
 
 public:
     explicit NodeElif(const Tok& token, std::span<const Token> expr_toks);
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeElse final : public NodeParent {
@@ -259,26 +299,24 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeWhile final : public NodeParent {
     std::unique_ptr<Expr> expr;
-    std::string expr_str;
-    std::string color_str;
+    TokenText text;
 
 public:
     explicit NodeWhile(const Tok& token, std::span<const Token> expr_toks);
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeReturn final : public Node {
     std::unique_ptr<Expr> expr;
-    std::string expr_str;
-    std::string color_str;
+    TokenText text;
 
 public:
     explicit NodeReturn(const Tok& token);
@@ -287,14 +325,14 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodePass final : public Node {
 public:
     explicit NodePass(const Tok& token);
     [[nodiscard]] auto to_string() const -> std::string override;
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 class NodeCall final : public Node {
@@ -305,7 +343,9 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
+
+    [[nodiscard]] auto get_label() const -> const std::string&;
 };
 
 class NodeJump final : public Node {
@@ -316,7 +356,9 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
+
+    [[nodiscard]] auto get_label() const -> const std::string&;
 };
 
 class NodeImage final : public Node {
@@ -329,7 +371,7 @@ public:
 
     [[nodiscard]] auto to_string() const -> std::string override;
 
-    [[nodiscard]] auto make_display_node(raylib::Rectangle rect) const -> DisplayNode override;
+    [[nodiscard]] auto display_fields() const -> NodeFields override;
 };
 
 // class NodeTransform final : public NodeParent {
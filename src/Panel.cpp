@@ -4,91 +4,180 @@
 
 #include "Panel.hpp"
 
-#include "TextHelper.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+#include "AllocCounter.hpp"
 
 FileTreePanel::FileTreePanel(const std::filesystem::path &path)
     : Panel({0.0, 0.0, 200, 1000}), path(path), tree(build_dir_tree(path)) {
-    float y = 0.0f;
-    for (auto &child : tree.children) {
-        files.emplace_back(raylib::Rectangle{0.0f, y, 200, 20}, &child, 0);
-        y += 20.0f;
+    reset_state();
+}
+
+void FileTreePanel::reset_state() {
+    state.assign(tree.size(), EntryState{});
+    for (unsigned i = 0; i < tree.size(); ++i) {
+        state[i].n_rows = tree.entries[i].n_children;
     }
+    state.front().open = true; // the root itself isn't shown, its children are the top level rows
 }
 
-void FileTreePanel::update(const raylib::Window &win) {
-    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && rect.CheckCollision(GetMousePosition())) {
-        const auto last_size = files.size();
-        for (int i = 0; i < files.size(); ++i) {
-            auto &[file_rect, node, depth, open] = files.at(i);
-            if (file_rect.CheckCollision(GetMousePosition())) {
-                if (node->is_dir && !open) {
-                    open = true;
-                    std::vector<FileEntry> new_files;
-                    float new_y = file_rect.y + 20.0f;
-                    new_files.reserve(node->children.size());
-                    for (auto &child : node->children) {
-                        raylib::Rectangle new_rect{file_rect.x + 10.0f, new_y, file_rect.width -  10.0f, file_rect.height};
-                        new_files.emplace_back(new_rect, &child, depth + 1);
-                        new_y += 20.0f;
-                    }
-                    files.insert(files.begin() + i + 1, new_files.begin(), new_files.end());
-                    break;
-                }
-                if (node->is_dir && open) {
-                    int j = i + 1;
-                    while (j < files.size()) {
-                        if (files.at(j).depth > depth) {
-                            j++;
-                        } else {
-                            break;
-                        }
-                    }
-                    files.erase(files.begin() + i + 1, files.begin() + j);
-                    open = false;
-                    break;
-                }
-                if (!node->is_dir) {
-                    curr_script = node->path;
-                }
-            }
+void FileTreePanel::set_open(const unsigned idx, const bool open) {
+    if (state[idx].open == open) {
+        return;
+    }
+    state[idx].open = open;
+
+    // only the open ancestors (up to the first closed one) show this entry's rows
+    const auto n_rows = state[idx].n_rows;
+    for (unsigned parent = tree.entries[idx].parent; parent != DirTree::NONE; parent = tree.entries[parent].parent) {
+        if (open) {
+            state[parent].n_rows += n_rows;
+        } else {
+            state[parent].n_rows -= n_rows;
         }
+        if (!state[parent].open) {
+            break;
+        }
+    }
+}
+
+auto FileTreePanel::visible_rows(const unsigned idx) const -> unsigned {
+    return state[idx].open ? state[idx].n_rows : 0;
+}
+
+auto FileTreePanel::row_at(unsigned row) const -> std::pair<unsigned, int> {
+    unsigned parent = 0;
+    int depth = 0;
 
-        if (files.size() != last_size) {
-            float y = 0.0f;
-            for (auto &[rect, n, depth, o] : files) {
-                rect.x = 0.0f + (static_cast<float>(depth) * 10.0f);
-                rect.y = y;
-                rect.width = 200.0f - (static_cast<float>(depth) * 10.0f);
-                y += 20.0f;
+    while (true) {
+        bool descended = false;
+        const auto &entry = tree.entries[parent];
+        for (unsigned child = entry.first_child; child < entry.first_child + entry.n_children; ++child) {
+            if (row == 0) {
+                return {child, depth};
             }
+            --row;
+            const auto rows = visible_rows(child);
+            if (row < rows) {
+                parent = child;
+                ++depth;
+                descended = true;
+                break;
+            }
+            row -= rows;
+        }
+        if (!descended) {
+            return {DirTree::NONE, depth};
         }
     }
 }
 
+auto FileTreePanel::next_row(unsigned idx, int &depth) const -> unsigned {
+    if (const auto &entry = tree.entries[idx]; state[idx].open && entry.n_children > 0) {
+        ++depth;
+        return entry.first_child;
+    }
+
+    while (idx != 0) {
+        const auto parent = tree.entries[idx].parent;
+        const auto &p = tree.entries[parent];
+        if (idx + 1 < p.first_child + p.n_children) {
+            return idx + 1;
+        }
+        idx = parent;
+        --depth;
+    }
+    return DirTree::NONE;
+}
+
+void FileTreePanel::clamp_scroll() {
+    const auto content_height = static_cast<float>(state.front().n_rows) * row_height;
+    scroll = std::clamp(scroll, 0.0f, std::max(0.0f, content_height - rect.height));
+}
+
+void FileTreePanel::update(const raylib::Window &win) {
+    rect.height = static_cast<float>(win.GetHeight());
+
+    if (hovered()) {
+        scroll -= GetMouseWheelMove() * row_height * 3.0f;
+    }
+    clamp_scroll();
+
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && hovered()) {
+        const auto mouse_y = static_cast<float>(GetMouseY()) - rect.y + scroll;
+        const auto [idx, _] = row_at(static_cast<unsigned>(mouse_y / row_height));
+        if (idx == DirTree::NONE) {
+            return;
+        }
+
+        if (tree.entries[idx].is_dir) {
+            set_open(idx, !state[idx].open);
+            clamp_scroll();
+        } else {
+            curr_script = tree.path_of(idx);
+        }
+    }
+}
+
+void FileTreePanel::rescan() {
+    std::unordered_set<std::filesystem::path> open_dirs;
+    for (unsigned i = 1; i < tree.size(); ++i) {
+        if (state[i].open) {
+            open_dirs.insert(tree.path_of(i));
+        }
+    }
+
+    tree = build_dir_tree(path);
+    reset_state();
+
+    for (unsigned i = 1; i < tree.size(); ++i) {
+        if (tree.entries[i].is_dir && open_dirs.contains(tree.path_of(i))) {
+            set_open(i, true);
+        }
+    }
+
+    clamp_scroll();
+}
+
+auto FileTreePanel::hovered() const -> bool {
+    return rect.CheckCollision(GetMousePosition());
+}
+
 void FileTreePanel::draw(const raylib::Window &win) {
     rect.Draw(raylib::Color::White());
 
-    const auto rec_draw = [&](this auto self, const DirTree &t, const int lvl) -> void {
-        for (const auto & [rect, node, d, o] : files) {
-            if (node->is_dir) {
-                rect.DrawLines(raylib::Color::Black());
-                dir_icon->Draw(raylib::Vector2{rect.x, rect.y});
-                auto draw_at = rect;
-                draw_at.x += dir_icon->width;
-                draw_at.width -= dir_icon->width;
-                TextHelper::draw_text(node->name, {draw_at.x, rect.y});
-            } else {
-                rect.DrawLines(raylib::Color::Black());
-                doc_icon->Draw(raylib::Vector2{rect.x, rect.y});
-                auto draw_at = rect;
-                draw_at.x += doc_icon->width;
-                draw_at.width -= doc_icon->width;
-                TextHelper::draw_text(node->name, {draw_at.x, rect.y});
-            }
+    const auto first_row = static_cast<unsigned>(scroll / row_height);
+    const auto n_rows = static_cast<unsigned>(std::ceil(rect.height / row_height)) + 1;
+    auto [idx, depth] = row_at(first_row);
+
+    BeginScissorMode(static_cast<int>(rect.x), static_cast<int>(rect.y),
+        static_cast<int>(rect.width), static_cast<int>(rect.height));
+
+    float y = rect.y + (static_cast<float>(first_row) * row_height) - scroll;
+    for (unsigned r = 0; r < n_rows && idx != DirTree::NONE; ++r) {
+        const auto &entry = tree.entries[idx];
+        auto &label = state[idx].label;
+        if (!label) {
+            const NoAllocGuard::Allow allow; // once per entry
+            label = TextHelper::into_disp_text(entry.name);
         }
-    };
 
-    rec_draw(tree, 0);
+        const auto x = rect.x + (static_cast<float>(depth) * indent);
+        const raylib::Rectangle row_rect{x, y, rect.width - (static_cast<float>(depth) * indent), row_height};
+        const auto &icon = entry.is_dir ? dir_icon : doc_icon;
+
+        row_rect.DrawLines(raylib::Color::Black());
+        icon->Draw(raylib::Vector2{row_rect.x, row_rect.y});
+        TextHelper::draw_text(*label, {row_rect.x + static_cast<float>(icon->width), row_rect.y});
+
+        y += row_height;
+        idx = next_row(idx, depth);
+    }
+
+    TextHelper::flush_text();
+    EndScissorMode();
 }
 
 void FileTreePanel::unload_textures() {
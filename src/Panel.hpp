@@ -5,16 +5,17 @@
 #ifndef RPY_PROJ_ANALYZER_PANEL_HPP
 #define RPY_PROJ_ANALYZER_PANEL_HPP
 
-#include <algorithm>
 #include <filesystem>
-#include <format>
+#include <memory>
 #include <optional>
-#include <string>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "raylib-cpp.hpp"
 
+#include "DirTree.hpp"
+#include "TextHelper.hpp"
+
 class Panel {
 protected:
     raylib::Rectangle rect;
@@ -26,78 +27,35 @@ public:
     virtual void draw(const raylib::Window &win) = 0;
 };
 
-struct DirTree {
-    std::string name;
-    std::filesystem::path path;
-    std::vector<DirTree> children;
-    bool is_dir;
-
-    explicit DirTree(const std::filesystem::path &path) : path(path) {
-        is_dir = is_directory(path);
-        name = path.filename().string();
-    }
-
-    auto operator<(const DirTree &other) const -> bool {
-        if (other.is_dir && !is_dir) {
-            return false;
-        }
-        if (!other.is_dir && is_dir) {
-            return true;
-        }
-        return name < other.name;
-    }
-};
-
-inline auto flat_files(const DirTree &tree) -> std::vector<std::string>  {
-    std::vector<std::string> files;
-
-     auto rec_add = [&](this auto self, const DirTree &t, const int lvl) -> void {
-        for (const auto &child : t.children) {
-            std::string spaces(lvl, '\t');
-            files.push_back(std::format("{}{}", spaces, child.name));
-            if (child.is_dir) {
-                self(child, lvl + 1);
-            }
-        }
-    };
-
-    rec_add(tree, 0);
-
-    return files;
-}
-
-inline auto build_dir_tree(const std::filesystem::path &path) -> DirTree {
-    DirTree root(path);
-
-    static const std::unordered_set<std::filesystem::path> valid_exts = {".rpy"};
-
-    for (const auto &dir : std::filesystem::directory_iterator(path)) {
-        if (std::filesystem::is_directory(dir)) {
-            if (auto sub_dir = build_dir_tree(dir.path()); !sub_dir.children.empty()) {
-                root.children.push_back(sub_dir);
-            }
-        } else if (std::filesystem::is_regular_file(dir) && valid_exts.contains(dir.path().extension())) {
-            root.children.emplace_back(dir.path());
-        }
-    }
-
-    std::ranges::sort(root.children, [](const DirTree &a, const DirTree &b) -> bool {
-        return a < b;
-    });
-
-    return root;
-}
-
+/**
+ * @brief Collapsible list of the project's scripts.
+ *
+ * Only the rows inside the panel are looked up and drawn each frame, so the
+ * cost doesn't grow with the size of the project. Rows aren't stored at all:
+ * every entry of the tree keeps how many rows sit under it while it's open,
+ * which is enough to find the entry on a given row and to update the counts
+ * when a folder is opened or closed.
+ */
 class FileTreePanel final : public Panel {
+    static constexpr float row_height = 20.0f;
+    static constexpr float indent = 10.0f;
+
     std::filesystem::path path;
     DirTree tree;
-    struct FileEntry {
-        raylib::Rectangle rect;
-        DirTree* node;
-        int depth;
+    struct EntryState {
+        unsigned n_rows = 0; // rows under this entry while it's open
         bool open = false;
+        std::optional<TextHelper::DispText> label; // made the first time the entry is drawn
     };
-    std::vector<FileEntry> files;
+    std::vector<EntryState> state; // indexed like tree.entries
+    float scroll = 0.0f;
+
+    void reset_state();
+    void set_open(unsigned idx, bool open);
+    [[nodiscard]] auto visible_rows(unsigned idx) const -> unsigned;
+    [[nodiscard]] auto row_at(unsigned row) const -> std::pair<unsigned, int>;
+    [[nodiscard]] auto next_row(unsigned idx, int &depth) const -> unsigned;
+    void clamp_scroll();
 
 public:
     static inline std::unique_ptr<raylib::Texture2D> doc_icon;
@@ -105,6 +63,12 @@ public:
     explicit FileTreePanel(const std::filesystem::path &path);
     void update(const raylib::Window &win) override;
     void draw(const raylib::Window &win) override;
+
+    /**
+     * @brief re-reads the directory after scripts were added or removed, keeping open folders open.
+     */
+    void rescan();
+    [[nodiscard]] auto hovered() const -> bool;
     std::optional<std::filesystem::path> curr_script;
     static void unload_textures();
 };
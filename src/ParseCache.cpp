@@ -0,0 +1,453 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "ParseCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "GraphExport.hpp"
+#include "GraphFile.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    using Header = GraphFile::Header;
+    using TokenRec = GraphFile::TokenRec;
+    using NodeRec = GraphFile::NodeRec;
+    using EdgeRec = GraphFile::EdgeRec;
+    constexpr auto NO_IDX = GraphFile::NO_IDX;
+
+    static_assert(std::is_trivially_copyable_v<LayoutSnapshot> && alignof(LayoutSnapshot) <= 8);
+
+    auto pack_str(const std::string_view str, std::string &pool) -> GraphFile::StrRef {
+        const auto off = static_cast<std::uint64_t>(pool.size());
+        pool += str;
+        return (off << 32) | static_cast<std::uint32_t>(str.size());
+    }
+
+    auto unpack_str(const std::uint64_t payload, const std::string_view pool) -> std::optional<std::string> {
+        const auto off = payload >> 32;
+        const auto len = payload & 0xFFFFFFFF;
+        if (off > pool.size() || len > pool.size() - off) {
+            return std::nullopt;
+        }
+        return std::string(pool.substr(off, len));
+    }
+
+    template<typename T>
+    auto encode_payload(const T &tok, std::string &pool) -> std::uint64_t {
+        if constexpr (std::is_same_v<T, TokIdent>) {
+            return pack_str(tok.name, pool);
+        } else if constexpr (std::is_same_v<T, TokStrLit>) {
+            return pack_str(tok.text, pool);
+        } else if constexpr (std::is_same_v<T, TokIntLit>) {
+            return static_cast<std::uint32_t>(tok.value);
+        } else if constexpr (std::is_same_v<T, TokFloatLit>) {
+            return std::bit_cast<std::uint64_t>(tok.value);
+        } else if constexpr (std::is_same_v<T, TokBoolLit>) {
+            return tok.value ? 1 : 0;
+        } else if constexpr (std::is_same_v<T, TokOp>) {
+            return std::to_underlying(tok.type);
+        } else if constexpr (std::is_same_v<T, TokATLProperty>) {
+            return std::to_underlying(tok.type);
+        } else if constexpr (std::is_same_v<T, TokATLEvent>) {
+            return std::to_underlying(tok.event);
+        } else if constexpr (std::is_same_v<T, TokATLTransition>) {
+            return std::to_underlying(tok.trans);
+        } else if constexpr (std::is_same_v<T, TokATLWarper>) {
+            return std::to_underlying(tok.warper);
+        } else {
+            return 0;
+        }
+    }
+
+    template<typename T>
+    auto decode_token(const TokenRec &rec, const std::string_view pool) -> std::optional<Token> {
+        T tok{};
+        static_cast<Tok&>(tok) = Tok{rec.line, rec.col, rec.indent};
+
+        if constexpr (std::is_same_v<T, TokIdent> || std::is_same_v<T, TokStrLit>) {
+            auto str = unpack_str(rec.payload, pool);
+            if (!str) {
+                return std::nullopt;
+            }
+            if constexpr (std::is_same_v<T, TokIdent>) {
+                tok.name = std::move(*str);
+            } else {
+                tok.text = std::move(*str);
+            }
+        } else if constexpr (std::is_same_v<T, TokIntLit>) {
+            tok.value = static_cast<int>(static_cast<std::uint32_t>(rec.payload));
+        } else if constexpr (std::is_same_v<T, TokFloatLit>) {
+            tok.value = std::bit_cast<double>(rec.payload);
+        } else if constexpr (std::is_same_v<T, TokBoolLit>) {
+            tok.value = rec.payload != 0;
+        } else if constexpr (std::is_same_v<T, TokOp>) {
+            tok.type = static_cast<OpType>(rec.payload);
+        } else if constexpr (std::is_same_v<T, TokATLProperty>) {
+            tok.type = static_cast<TFProp>(rec.payload);
+        } else if constexpr (std::is_same_v<T, TokATLEvent>) {
+            tok.event = static_cast<Event>(rec.payload);
+        } else if constexpr (std::is_same_v<T, TokATLTransition>) {
+            tok.trans = static_cast<Transition>(rec.payload);
+        } else if constexpr (std::is_same_v<T, TokATLWarper>) {
+            tok.warper = static_cast<Warper>(rec.payload);
+        }
+
+        return tok;
+    }
+
+    using Decoder = auto (*)(const TokenRec&, std::string_view) -> std::optional<Token>;
+
+    template<std::size_t... Is>
+    consteval auto make_decoders(std::index_sequence<Is...>) -> std::array<Decoder, sizeof...(Is)> {
+        return {&decode_token<std::variant_alternative_t<Is, Token>>...};
+    }
+
+    constexpr auto decoders = make_decoders(std::make_index_sequence<std::variant_size_v<Token>>{});
+
+    auto to_rec_idx(const std::optional<unsigned> &idx) -> std::uint32_t {
+        return idx ? static_cast<std::uint32_t>(*idx) : NO_IDX;
+    }
+
+    auto from_rec_idx(const std::uint32_t idx) -> std::optional<unsigned> {
+        if (idx == NO_IDX) {
+            return std::nullopt;
+        }
+        return idx;
+    }
+
+    auto hash_str(const std::string_view str) -> std::uint64_t {
+        std::uint64_t hash = 0xCBF29CE484222325;
+        for (const char c : str) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 0x100000001B3;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief where to write `dest` before renaming it into place, one per thread.
+     */
+    auto temp_path(const std::filesystem::path &dest) -> std::filesystem::path {
+        auto tmp = dest;
+        tmp += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        return tmp;
+    }
+
+    /**
+     * @brief records the script's new `mtime` in the entry, so the next load doesn't hash it again.
+     *
+     * Patches a copy and renames it over the entry like `store()` does, so whoever has the
+     * old entry mapped keeps reading the old file. If a newer entry lands in between it may
+     * be replaced by this one, which only costs a hash and a re-parse on the next load.
+     * Best effort: if it fails the entry is still valid, just slower to check.
+     */
+    void touch_entry(const std::filesystem::path &entry, const std::int64_t mtime) {
+        std::error_code ec;
+        const auto tmp = temp_path(entry);
+        if (!std::filesystem::copy_file(entry, tmp, std::filesystem::copy_options::overwrite_existing, ec)) {
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+
+        bool patched = false;
+        {
+            std::fstream out(tmp, std::ios::binary | std::ios::in | std::ios::out);
+            out.seekp(offsetof(Header, mtime));
+            out.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+            out.flush();
+            patched = static_cast<bool>(out);
+        }
+
+        if (patched) {
+            std::filesystem::rename(tmp, entry, ec);
+        }
+        if (!patched || ec) {
+            std::filesystem::remove(tmp, ec);
+        }
+    }
+}
+
+auto ParseCache::cache_dir() -> std::filesystem::path {
+    if (dir_override) {
+        return *dir_override;
+    }
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr && *xdg != '\0') {
+        return std::filesystem::path(xdg) / "rpy_proj_analyzer";
+    }
+    if (const char *home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+        return std::filesystem::path(home) / ".cache" / "rpy_proj_analyzer";
+    }
+    return std::filesystem::temp_directory_path() / "rpy_proj_analyzer";
+}
+
+void ParseCache::set_cache_dir(const std::filesystem::path &dir) {
+    dir_override = dir;
+}
+
+auto ParseCache::entry_path(const std::filesystem::path &script) -> std::filesystem::path {
+    std::error_code ec;
+    auto abs = std::filesystem::weakly_canonical(script, ec);
+    if (ec) {
+        abs = std::filesystem::absolute(script);
+    }
+    return cache_dir() / std::format("{:016x}.rpyc", hash_str(abs.string()));
+}
+
+auto ParseCache::load(const std::filesystem::path &script) -> std::expected<Loaded, std::string> {
+    const Profiler::Scope scope("cache_load");
+    const auto entry_file = entry_path(script);
+    const auto entry = GraphFile::open(entry_file);
+    if (!entry) {
+        return std::unexpected(entry.error());
+    }
+
+    const auto &hdr = entry->header();
+    if (hdr.n_token_kinds != std::variant_size_v<Token> || hdr.layout_rec_size != sizeof(LayoutSnapshot)) {
+        return std::unexpected("cache entry is from a different build");
+    }
+
+    std::error_code ec;
+    FileStamp stamp;
+    stamp.mtime = std::filesystem::last_write_time(script, ec);
+    stamp.size = ec ? 0 : std::filesystem::file_size(script, ec);
+    if (ec) {
+        return std::unexpected(std::format("could not stat {}", script.string()));
+    }
+    if (stamp.size != hdr.size) {
+        return std::unexpected("stale");
+    }
+    if (const auto mtime = static_cast<std::int64_t>(stamp.mtime.time_since_epoch().count()); mtime != hdr.mtime) {
+        // touched but maybe not edited, let the contents decide
+        if (FileStamp::hash_file(script) != hdr.hash) {
+            return std::unexpected("stale");
+        }
+        touch_entry(entry_file, mtime);
+    }
+    stamp.hash = hdr.hash;
+
+    // the table is 8 byte aligned in the file, and the mapping is page aligned
+    const auto layout_recs = GraphFile::table<LayoutSnapshot>(entry->layout(), 0, hdr.n_layout);
+    if (!layout_recs) {
+        return std::unexpected("cache entry is truncated");
+    }
+    const auto tok_recs = entry->tokens();
+    const auto node_recs = entry->nodes();
+    const auto pool = entry->strings();
+
+    std::vector<Token> tokens;
+    tokens.reserve(tok_recs.size());
+    for (const auto &rec : tok_recs) {
+        if (rec.kind >= decoders.size()) {
+            return std::unexpected("bad token kind in cache entry");
+        }
+        auto tok = decoders[rec.kind](rec, pool);
+        if (!tok) {
+            return std::unexpected("bad string in cache entry");
+        }
+        tokens.push_back(std::move(*tok));
+    }
+
+    Graph graph(std::move(tokens), false);
+
+    auto &nodes = graph.get_nodes();
+    if (nodes.size() != node_recs.size()) {
+        return std::unexpected("node table doesn't match the tokens");
+    }
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const auto &rec = node_recs[i];
+        auto &node = *nodes[i];
+        if (const auto [line, col] = node.line_and_col(); line != rec.line || col != rec.col || node.indent != rec.indent) {
+            return std::unexpected("node table doesn't match the tokens");
+        }
+
+        node.parent = from_rec_idx(rec.parent);
+        node.next = from_rec_idx(rec.next);
+        node.prev = from_rec_idx(rec.prev);
+        node.path_flags = static_cast<std::uint8_t>(rec.path_flags);
+        if (auto *parent = dynamic_cast<NodeParent*>(&node)) {
+            parent->first_child = from_rec_idx(rec.first_child);
+            parent->after_block = from_rec_idx(rec.after_block);
+        }
+    }
+
+    auto file = std::make_unique<RenpyFile>(std::move(graph), *layout_recs);
+    return Loaded{.stamp=stamp, .file=std::move(file)};
+}
+
+auto ParseCache::write(std::ostream &out, const std::filesystem::path &script, const FileStamp &stamp, const RenpyFile &file,
+                       const bool with_text) -> std::expected<void, std::string> {
+    const auto &tokens = file.graph.get_tokens();
+    const auto &nodes = file.graph.get_nodes();
+    const auto layout = file.layout.snapshot();
+    const auto info = GraphExport::collect(script, file.graph);
+
+    std::string pool;
+    std::vector<TokenRec> tok_recs;
+    tok_recs.reserve(tokens.size());
+    for (const auto &tok : tokens) {
+        std::visit([&]<typename T>(const T &t) {
+            const Tok &base = t;
+            tok_recs.push_back({
+                .kind=static_cast<std::uint32_t>(tok.index()),
+                .line=base.line,
+                .col=base.col,
+                .indent=base.indent,
+                .payload=encode_payload(t, pool),
+            });
+        }, tok);
+    }
+
+    std::vector<NodeRec> node_recs;
+    node_recs.reserve(nodes.size());
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+        const auto &node = nodes[i];
+        const auto &node_info = info.nodes[i];
+        const auto [line, col] = node->line_and_col();
+        const auto *parent = dynamic_cast<const NodeParent*>(node.get());
+        node_recs.push_back({
+            .line=line,
+            .col=col,
+            .indent=node->indent,
+            .parent=to_rec_idx(node->parent),
+            .next=to_rec_idx(node->next),
+            .prev=to_rec_idx(node->prev),
+            .first_child=parent != nullptr ? to_rec_idx(parent->first_child) : NO_IDX,
+            .after_block=parent != nullptr ? to_rec_idx(parent->after_block) : NO_IDX,
+            .path_flags=node->path_flags,
+            .kind=node_info.kind,
+            .label=node_info.label == GraphExport::NONE ? NO_IDX : info.labels[node_info.label].node,
+            .words=node_info.words,
+            .text=with_text ? pack_str(node->to_string(), pool) : 0,
+            .target=0,
+        });
+    }
+
+    std::vector<EdgeRec> edge_recs;
+    edge_recs.reserve(info.edges.size() + info.jumps.size());
+    for (const auto &[from, to, type] : info.edges) {
+        edge_recs.push_back({.from=from, .to=to, .type=std::to_underlying(type)});
+    }
+    // only jumps within the script become edges, readers can go by `target` for the rest
+    for (const auto &[node, target] : info.jumps) {
+        node_recs[node].target = pack_str(target, pool);
+        const auto label = std::ranges::find(info.labels, target, &GraphExport::Label::name);
+        if (label != info.labels.end()) {
+            edge_recs.push_back({.from=node, .to=label->node, .type=std::to_underlying(GraphFile::EdgeType::Jump)});
+        }
+    }
+
+    if (pool.size() > std::numeric_limits<std::uint32_t>::max()) {
+        return std::unexpected(std::format("{} is too large to cache", script.string()));
+    }
+
+    Header hdr{
+        .magic=GraphFile::MAGIC,
+        .version=GraphFile::VERSION,
+        .n_token_kinds=std::variant_size_v<Token>,
+        .mtime=static_cast<std::int64_t>(stamp.mtime.time_since_epoch().count()),
+        .size=stamp.size,
+        .hash=stamp.hash,
+        .n_tokens=static_cast<std::uint32_t>(tok_recs.size()),
+        .n_nodes=static_cast<std::uint32_t>(node_recs.size()),
+        .n_edges=static_cast<std::uint32_t>(edge_recs.size()),
+        .n_layout=static_cast<std::uint32_t>(layout.size()),
+        .tokens_off=0,
+        .nodes_off=0,
+        .edges_off=0,
+        .layout_off=0,
+        .strings_off=0,
+        .strings_size=pool.size(),
+        .layout_rec_size=sizeof(LayoutSnapshot),
+        .flags=with_text ? GraphFile::NODE_TEXT : 0,
+    };
+    hdr.tokens_off = GraphFile::align8(sizeof(Header));
+    hdr.nodes_off = GraphFile::align8(hdr.tokens_off + (tok_recs.size() * sizeof(TokenRec)));
+    hdr.edges_off = GraphFile::align8(hdr.nodes_off + (node_recs.size() * sizeof(NodeRec)));
+    hdr.layout_off = GraphFile::align8(hdr.edges_off + (edge_recs.size() * sizeof(EdgeRec)));
+    hdr.strings_off = GraphFile::align8(hdr.layout_off + (layout.size() * sizeof(LayoutSnapshot)));
+
+    std::uint64_t written = 0;
+    auto write_at = [&](const std::uint64_t off, const void *data, const std::size_t n) -> void {
+        static constexpr std::array<char, 8> zeros{};
+        out.write(zeros.data(), static_cast<std::streamsize>(off - written));
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+        written = off + n;
+    };
+
+    write_at(0, &hdr, sizeof(Header));
+    write_at(hdr.tokens_off, tok_recs.data(), tok_recs.size() * sizeof(TokenRec));
+    write_at(hdr.nodes_off, node_recs.data(), node_recs.size() * sizeof(NodeRec));
+    write_at(hdr.edges_off, edge_recs.data(), edge_recs.size() * sizeof(EdgeRec));
+    write_at(hdr.layout_off, layout.data(), layout.size() * sizeof(LayoutSnapshot));
+    write_at(hdr.strings_off, pool.data(), pool.size());
+
+    if (!out) {
+        return std::unexpected("write failed");
+    }
+    return {};
+}
+
+auto ParseCache::store(const std::filesystem::path &script, const FileStamp &stamp, const RenpyFile &file)
+    -> std::expected<void, std::string> {
+    const Profiler::Scope scope("cache_store");
+
+    std::error_code ec;
+    const auto dest = entry_path(script);
+    std::filesystem::create_directories(dest.parent_path(), ec);
+    if (ec) {
+        return std::unexpected(std::format("could not create {}: {}", dest.parent_path().string(), ec.message()));
+    }
+
+    // write next to the real entry and rename over it, so readers never see half a file
+    const auto tmp = temp_path(dest);
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return std::unexpected(std::format("could not write {}", tmp.string()));
+        }
+        if (auto written = write(out, script, stamp, file); !written) {
+            out.close();
+            std::filesystem::remove(tmp, ec);
+            return std::unexpected(std::format("could not write {}: {}", tmp.string(), written.error()));
+        }
+    }
+
+    std::filesystem::rename(tmp, dest, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return std::unexpected(std::format("could not replace {}: {}", dest.string(), ec.message()));
+    }
+
+    return {};
+}
+
+auto ParseCache::load_or_parse(const std::filesystem::path &script, const std::span<const LayoutSnapshot> prev) -> Loaded {
+    if (auto cached = load(script)) {
+        return std::move(*cached);
+    }
+
+    const auto stamp = FileStamp::of(script);
+    auto file = prev.empty()
+        ? std::make_unique<RenpyFile>(Graph(script))
+        : std::make_unique<RenpyFile>(Graph(script), prev, true);
+    if (auto stored = store(script, stamp, *file); !stored) {
+        std::println(std::cerr, "not caching {}: {}", script.string(), stored.error());
+    }
+
+    return {.stamp=stamp, .file=std::move(file)};
+}
@@ -0,0 +1,76 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_PARSECACHE_HPP
+#define RPY_PROJ_ANALYZER_PARSECACHE_HPP
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+
+#include "ScriptLoader.hpp"
+
+/**
+ * @brief On-disk cache of lexed, parsed and laid out scripts.
+ *
+ * Every script gets one GraphFile in the cache directory (named after a hash
+ * of its absolute path), which is mapped and read in place. The header records
+ * the script's mtime, size and content hash. A cache file is only used when
+ * those still match, so editing one script only costs a re-parse of that script.
+ *
+ * A hit skips lexing, linking and layout. The nodes themselves are still built
+ * from the cached tokens (`generate_nodes` without linking), then get their
+ * links from the node table.
+ */
+class ParseCache {
+    static inline std::optional<std::filesystem::path> dir_override;
+
+public:
+    struct Loaded {
+        FileStamp stamp;
+        std::unique_ptr<RenpyFile> file;
+    };
+
+    /**
+     * @brief `$XDG_CACHE_HOME/rpy_proj_analyzer`, falling back to `~/.cache/rpy_proj_analyzer`.
+     */
+    static auto cache_dir() -> std::filesystem::path;
+    static void set_cache_dir(const std::filesystem::path &dir);
+    static auto entry_path(const std::filesystem::path &script) -> std::filesystem::path;
+
+    /**
+     * @brief maps the cache file for `script` and rebuilds it, if it is still up to date.
+     *
+     * The error only says why the cache couldn't be used; callers should just parse instead.
+     */
+    static auto load(const std::filesystem::path &script) -> std::expected<Loaded, std::string>;
+
+    /**
+     * @brief writes `file` to `out` as a GraphFile.
+     * @param with_text whether to write every node's text too, for readers without the parser.
+     */
+    static auto write(std::ostream &out, const std::filesystem::path &script, const FileStamp &stamp, const RenpyFile &file,
+                      bool with_text = false) -> std::expected<void, std::string>;
+
+    /**
+     * @brief writes `file` to the cache, replacing any older entry for `script`.
+     */
+    static auto store(const std::filesystem::path &script, const FileStamp &stamp, const RenpyFile &file)
+        -> std::expected<void, std::string>;
+
+    /**
+     * @brief `load()`, or parse the script (and cache it) when that doesn't work out.
+     *
+     * @param prev the layout of the script before it changed, if there is one.
+     * Parts of it that still fit are kept instead of being laid out again.
+     */
+    static auto load_or_parse(const std::filesystem::path &script, std::span<const LayoutSnapshot> prev = {}) -> Loaded;
+};
+
+#endif //RPY_PROJ_ANALYZER_PARSECACHE_HPP
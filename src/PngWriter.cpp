@@ -0,0 +1,123 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "PngWriter.hpp"
+
+#include <array>
+#include <cassert>
+
+namespace {
+    constexpr auto crc_table = [] {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t n = 0; n < table.size(); ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) != 0 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+
+    auto crc_update(std::uint32_t crc, const std::span<const std::uint8_t> bytes) -> std::uint32_t {
+        for (const auto byte : bytes) {
+            crc = crc_table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    void put_be32(std::uint8_t *dst, const std::uint32_t value) {
+        dst[0] = static_cast<std::uint8_t>(value >> 24);
+        dst[1] = static_cast<std::uint8_t>(value >> 16);
+        dst[2] = static_cast<std::uint8_t>(value >> 8);
+        dst[3] = static_cast<std::uint8_t>(value);
+    }
+}
+
+PngWriter::PngWriter(std::ostream &out, const std::uint32_t width, const std::uint32_t height)
+    : out(out), width(width), height(height), chunk(max_chunk) {
+    deflating = ::deflateInit(&zs, Z_DEFAULT_COMPRESSION) == Z_OK;
+    zs.next_out = chunk.data();
+    zs.avail_out = static_cast<uInt>(chunk.size());
+
+    constexpr std::array<std::uint8_t, 8> signature{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.write(reinterpret_cast<const char*>(signature.data()), signature.size());
+
+    std::array<std::uint8_t, 13> ihdr{};
+    put_be32(&ihdr[0], width);
+    put_be32(&ihdr[4], height);
+    ihdr[8] = 8;  // bits per channel
+    ihdr[9] = 2;  // RGB
+    ihdr[10] = 0; // deflate
+    ihdr[11] = 0; // adaptive filtering, though every row uses none
+    ihdr[12] = 0; // not interlaced
+    write_chunk("IHDR", ihdr);
+}
+
+void PngWriter::write_chunk(const std::string_view type, const std::span<const std::uint8_t> data) {
+    std::array<std::uint8_t, 4> word{};
+    put_be32(word.data(), static_cast<std::uint32_t>(data.size()));
+    out.write(reinterpret_cast<const char*>(word.data()), word.size());
+    out.write(type.data(), static_cast<std::streamsize>(type.size()));
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    auto crc = crc_update(0xFFFFFFFFu, {reinterpret_cast<const std::uint8_t*>(type.data()), type.size()});
+    crc = crc_update(crc, data) ^ 0xFFFFFFFFu;
+    put_be32(word.data(), crc);
+    out.write(reinterpret_cast<const char*>(word.data()), word.size());
+}
+
+PngWriter::~PngWriter() {
+    ::deflateEnd(&zs);
+}
+
+void PngWriter::write_idat() {
+    const auto used = chunk.size() - zs.avail_out;
+    if (used > 0) {
+        write_chunk("IDAT", std::span(chunk).first(used));
+    }
+    zs.next_out = chunk.data();
+    zs.avail_out = static_cast<uInt>(chunk.size());
+}
+
+void PngWriter::compress(const std::span<const std::uint8_t> bytes, const int flush) {
+    if (!deflating) {
+        return;
+    }
+
+    // zlib never writes through next_in, it's only not const for old compilers
+    zs.next_in = const_cast<Bytef*>(bytes.data());
+    zs.avail_in = static_cast<uInt>(bytes.size());
+    while (true) {
+        const int ret = ::deflate(&zs, flush);
+        if (ret == Z_STREAM_ERROR) {
+            deflating = false;
+            return;
+        }
+        if (zs.avail_out == 0) {
+            write_idat();
+        }
+        // without Z_FINISH deflate may keep some of the input back, that's fine until the end
+        if (flush == Z_FINISH ? ret == Z_STREAM_END : zs.avail_in == 0) {
+            return;
+        }
+    }
+}
+
+void PngWriter::write_row(const std::span<const std::uint8_t> rgb) {
+    assert(rgb.size() == static_cast<std::size_t>(width) * 3 && rows < height);
+    constexpr std::array<std::uint8_t, 1> filter_none{0};
+    compress(filter_none, Z_NO_FLUSH);
+    compress(rgb, Z_NO_FLUSH);
+    ++rows;
+}
+
+auto PngWriter::finish() -> bool {
+    assert(rows == height);
+    compress({}, Z_FINISH);
+    write_idat();
+    write_chunk("IEND", {});
+    out.flush();
+    return deflating && out.good();
+}
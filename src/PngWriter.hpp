@@ -0,0 +1,61 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_PNGWRITER_HPP
+#define RPY_PROJ_ANALYZER_PNGWRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <zlib.h>
+
+/**
+ * @brief Writes an 8 bit RGB PNG one row at a time, so the image never has to be in memory.
+ *
+ * The rows go through one zlib deflate stream, whose output is written out in
+ * IDAT chunks of up to 64 KB as it comes. Writing one takes a fixed amount of
+ * memory (zlib's window and one chunk) whatever the size of the image.
+ */
+class PngWriter {
+    static constexpr std::size_t max_chunk = 65536;
+
+    std::ostream &out;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t rows = 0;
+    z_stream zs{};
+    bool deflating = false; // deflateInit worked and nothing failed since
+    std::vector<std::uint8_t> chunk;
+
+    void write_chunk(std::string_view type, std::span<const std::uint8_t> data);
+    void write_idat();
+
+    /**
+     * @brief feeds `bytes` to deflate, writing out each chunk as it fills. `flush` is Z_NO_FLUSH or Z_FINISH.
+     */
+    void compress(std::span<const std::uint8_t> bytes, int flush);
+
+public:
+    PngWriter(std::ostream &out, std::uint32_t width, std::uint32_t height);
+    PngWriter(const PngWriter&) = delete;
+    auto operator=(const PngWriter&) -> PngWriter& = delete;
+    ~PngWriter();
+
+    /**
+     * @brief adds the next row, `width * 3` bytes of RGB.
+     */
+    void write_row(std::span<const std::uint8_t> rgb);
+
+    /**
+     * @brief ends the image. Every row has to have been written by then.
+     * @return whether the whole file made it to the stream.
+     */
+    auto finish() -> bool;
+};
+
+#endif //RPY_PROJ_ANALYZER_PNGWRITER_HPP
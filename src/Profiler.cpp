@@ -0,0 +1,225 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "Profiler.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <print>
+#include <unordered_map>
+#include <vector>
+
+#include "Json.hpp"
+
+namespace {
+    struct Event {
+        const char *phase;
+        std::uint32_t file; // index into file_names
+        std::uint32_t tid;
+        Profiler::Clock::time_point start;
+        Profiler::Clock::duration dur;
+        AllocStats allocs;
+    };
+
+    // a long GUI session shouldn't be able to eat all memory with trace events
+    constexpr std::size_t max_events = 1'000'000;
+
+    std::atomic<bool> on = false;
+    std::atomic<bool> tracing = false;
+    std::atomic<std::uint32_t> next_tid = 0;
+    const auto epoch = Profiler::Clock::now();
+
+    std::mutex mtx;
+    Profiler::PhaseTotals totals;
+    std::unordered_map<std::string, Profiler::PhaseTotals> per_file;
+    std::vector<Event> events;
+    std::size_t dropped_events = 0;
+    std::vector<std::string> file_names;
+    std::unordered_map<std::string, std::uint32_t> file_ids;
+
+    void add(Profiler::Totals &t, const Profiler::Clock::duration dur, const AllocStats &allocs) {
+        ++t.calls;
+        t.time += dur;
+        t.bytes += allocs.bytes;
+        t.allocs += allocs.count;
+    }
+
+    /**
+     * @brief adds `from` to `into` and zeroes it. The keys stay, so adding to them again doesn't allocate.
+     */
+    void merge(Profiler::PhaseTotals &into, Profiler::PhaseTotals &from) {
+        for (auto &[phase, t] : from) {
+            if (t.calls == 0) {
+                continue;
+            }
+            auto &sum = into[phase];
+            sum.calls += t.calls;
+            sum.time += t.time;
+            sum.bytes += t.bytes;
+            sum.allocs += t.allocs;
+            t = {};
+        }
+    }
+
+    /**
+     * @brief a thread's totals since it last merged them, so closing a scope doesn't take the lock.
+     */
+    struct Pending {
+        Profiler::PhaseTotals phases;
+        Profiler::PhaseTotals file; // for current_file
+
+        Pending() = default;
+        Pending(const Pending&) = delete;
+        auto operator=(const Pending&) -> Pending& = delete;
+
+        ~Pending() {
+            std::lock_guard lock(mtx);
+            merge(totals, phases);
+        }
+    };
+
+    thread_local Pending pending;
+    thread_local const std::string *current_file = nullptr;
+    thread_local const std::uint32_t thread_id = next_tid++;
+
+    /**
+     * @brief merges this thread's totals, its per file ones into `file`.
+     */
+    void flush(const std::string *file) {
+        std::lock_guard lock(mtx);
+        merge(totals, pending.phases);
+        if (file != nullptr) {
+            merge(per_file[*file], pending.file);
+        }
+    }
+
+    auto file_id(const std::string &path) -> std::uint32_t {
+        const auto [it, inserted] = file_ids.try_emplace(path, static_cast<std::uint32_t>(file_names.size()));
+        if (inserted) {
+            file_names.push_back(path);
+        }
+        return it->second;
+    }
+
+    void write_totals(std::ostream &out, const Profiler::PhaseTotals &phases) {
+        out << '{';
+        bool first = true;
+        for (const auto &[phase, t] : phases) {
+            std::print(out, R"({}"{}":{{"calls":{},"ms":{:.3f},"bytes":{},"allocs":{}}})",
+                first ? "" : ",", phase, t.calls,
+                std::chrono::duration<double, std::milli>(t.time).count(), t.bytes, t.allocs);
+            first = false;
+        }
+        out << '}';
+    }
+}
+
+Profiler::Scope::Scope(const char *phase)
+    : phase(phase), active(on.load(std::memory_order_relaxed)) {
+    if (active) {
+        allocs_before = thread_alloc_stats();
+        start = Clock::now();
+    }
+}
+
+Profiler::Scope::~Scope() {
+    if (!active) {
+        return;
+    }
+    const auto dur = Clock::now() - start;
+    const auto allocs = thread_alloc_stats() - allocs_before;
+
+    add(pending.phases[phase], dur, allocs);
+    if (current_file != nullptr) {
+        add(pending.file[phase], dur, allocs);
+    }
+
+    if (tracing.load(std::memory_order_relaxed)) {
+        std::lock_guard lock(mtx);
+        if (events.size() < max_events) {
+            const auto file = current_file != nullptr ? file_id(*current_file) : file_id("");
+            events.push_back({.phase=phase, .file=file, .tid=thread_id, .start=start, .dur=dur, .allocs=allocs});
+        } else {
+            ++dropped_events;
+        }
+    }
+}
+
+Profiler::FileScope::FileScope(const std::filesystem::path &path)
+    : path(path.string()), prev(current_file) {
+    if (prev != nullptr) {
+        flush(prev); // what was counted so far belongs to the outer script
+    }
+    current_file = &this->path;
+}
+
+Profiler::FileScope::~FileScope() {
+    flush(current_file);
+    current_file = prev;
+}
+
+void Profiler::set_enabled(const bool enabled) {
+    on.store(enabled, std::memory_order_relaxed);
+}
+
+auto Profiler::enabled() -> bool {
+    return on.load(std::memory_order_relaxed);
+}
+
+void Profiler::set_tracing(const bool tracing_on) {
+    tracing.store(tracing_on, std::memory_order_relaxed);
+}
+
+auto Profiler::phase_totals() -> PhaseTotals {
+    flush(current_file);
+    std::lock_guard lock(mtx);
+    return totals;
+}
+
+auto Profiler::file_totals(const std::filesystem::path &path) -> PhaseTotals {
+    std::lock_guard lock(mtx);
+    const auto it = per_file.find(path.string());
+    return it == per_file.end() ? PhaseTotals{} : it->second;
+}
+
+void Profiler::write_json(std::ostream &out) {
+    flush(current_file);
+    std::lock_guard lock(mtx);
+
+    out << R"({"phases":)";
+    write_totals(out, totals);
+    out << R"(,"files":{)";
+    bool first = true;
+    for (const auto &[path, phases] : std::map(per_file.begin(), per_file.end())) {
+        out << (first ? "" : ",");
+        Json::write_string(out, path);
+        out << ':';
+        write_totals(out, phases);
+        first = false;
+    }
+    out << "}}\n";
+}
+
+void Profiler::write_trace(std::ostream &out) {
+    std::lock_guard lock(mtx);
+
+    out << R"({"displayTimeUnit":"ms","traceEvents":[)";
+    bool first = true;
+    for (const auto &e : events) {
+        using us = std::chrono::duration<double, std::micro>;
+        std::print(out, R"({}{{"name":"{}","cat":"load","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"file":)",
+            first ? "" : ",\n", e.phase, e.tid,
+            us(e.start - epoch).count(), us(e.dur).count());
+        Json::write_string(out, file_names[e.file]);
+        std::print(out, R"(,"bytes":{},"allocs":{}}}}})", e.allocs.bytes, e.allocs.count);
+        first = false;
+    }
+    out << "]}\n";
+
+    if (dropped_events > 0) {
+        std::println(std::cerr, "trace is missing the last {} events, only {} are kept", dropped_events, max_events);
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_PROFILER_HPP
+#define RPY_PROJ_ANALYZER_PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "AllocCounter.hpp"
+
+/**
+ * @brief Wall time and heap allocations spent in each phase of loading a script.
+ *
+ * Phases are marked with a `Profiler::Scope`, and the script they belong to
+ * with a `Profiler::FileScope` on the same thread. Totals are kept per phase
+ * and per script. Scopes nest and are inclusive: a phase's time and
+ * allocations include those of any phase inside it.
+ *
+ * Off by default; a disabled scope only checks a flag. An enabled one adds to
+ * its thread's own totals, which are merged into the shared ones when a
+ * FileScope closes or the totals are read, so scopes on the pool's threads
+ * don't wait on each other. Totals from other threads' open file scopes
+ * aren't visible yet. Individual events (for `write_trace`) are only kept when
+ * tracing is on as well.
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Totals {
+        std::size_t calls = 0;
+        Clock::duration time{};
+        std::size_t bytes = 0;
+        std::size_t allocs = 0;
+    };
+
+    // phase names are string literals, so views of them stay valid
+    using PhaseTotals = std::map<std::string_view, Totals>;
+
+    class Scope {
+        const char *phase;
+        Clock::time_point start;
+        AllocStats allocs_before;
+        bool active;
+
+    public:
+        explicit Scope(const char *phase);
+        Scope(const Scope&) = delete;
+        auto operator=(const Scope&) -> Scope& = delete;
+        ~Scope();
+    };
+
+    class FileScope {
+        std::string path;
+        const std::string *prev;
+
+    public:
+        explicit FileScope(const std::filesystem::path &path);
+        FileScope(const FileScope&) = delete;
+        auto operator=(const FileScope&) -> FileScope& = delete;
+        ~FileScope();
+    };
+
+    static void set_enabled(bool enabled);
+    [[nodiscard]] static auto enabled() -> bool;
+    static void set_tracing(bool tracing);
+
+    [[nodiscard]] static auto phase_totals() -> PhaseTotals;
+    [[nodiscard]] static auto file_totals(const std::filesystem::path &path) -> PhaseTotals;
+
+    /**
+     * @brief totals per phase, then per script, as one JSON object.
+     */
+    static void write_json(std::ostream &out);
+
+    /**
+     * @brief every recorded scope in the Chrome trace event format (chrome://tracing, Perfetto).
+     */
+    static void write_trace(std::ostream &out);
+};
+
+#endif //RPY_PROJ_ANALYZER_PROFILER_HPP
@@ -0,0 +1,377 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "ProjectCanvas.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <ranges>
+
+#include "AllocCounter.hpp"
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    constexpr float gap = 40.0f;      // between tiles, and between a script's rows
+    constexpr float file_gap = 200.0f; // between scripts
+
+    auto grown(const raylib::Rectangle &rect, const float dx, const float dy) -> raylib::Rectangle {
+        return {rect.x - dx, rect.y - dy, rect.width + (2 * dx), rect.height + (2 * dy)};
+    }
+
+    auto shaped(const std::string_view text) -> TextHelper::DispText {
+        auto disp = TextHelper::into_disp_text(text);
+        TextHelper::layout(disp, 0); // so drawing it doesn't have to
+        return disp;
+    }
+}
+
+auto ProjectCanvas::collect(const std::filesystem::path &file, const RenpyFile &loaded) -> FileTiles {
+    FileTiles tiles{.file=file, .tiles={}};
+
+    const auto &nodes = loaded.graph.get_nodes();
+    for (const auto &[top, node_idx, width, height] : loaded.layout.label_extents()) {
+        const auto *label = dynamic_cast<const NodeLabel*>(nodes.at(node_idx).get());
+        if (label == nullptr) {
+            continue;
+        }
+
+        TileInfo info{
+            .label=label->get_name(),
+            .line=label->line_and_col().first,
+            .top=top,
+            .width=width,
+            .height=height,
+            .jumps={},
+        };
+        // a label's body is everything up to the next unindented node
+        for (auto i = node_idx + 1; i < nodes.size() && nodes[i]->indent > 0; ++i) {
+            if (const auto *jump = dynamic_cast<const NodeJump*>(nodes[i].get())) {
+                info.jumps.push_back(jump->get_label());
+            } else if (const auto *call = dynamic_cast<const NodeCall*>(nodes[i].get())) {
+                info.jumps.push_back(call->get_label());
+            }
+        }
+        tiles.tiles.push_back(std::move(info));
+    }
+
+    return tiles;
+}
+
+void ProjectCanvas::update(FileTiles tiles) {
+    changes.insert_or_assign(std::move(tiles.file), std::move(tiles.tiles));
+}
+
+void ProjectCanvas::remove(const std::filesystem::path &file) {
+    changes.insert_or_assign(file, std::vector<TileInfo>{});
+}
+
+void ProjectCanvas::apply_changes() {
+    for (auto &[path, tiles] : changes) {
+        if (auto found = files.find(path); found != files.end()) {
+            // the script changed, so whatever was loaded for it is stale
+            release(found->second);
+            files.erase(found);
+        }
+        if (tiles.empty()) {
+            continue;
+        }
+
+        File file{.tiles={}, .name=shaped(std::format("{{b}}{}{{/b}}", path.filename().string())),
+            .header={}, .bounds={}, .pending={}, .loaded=nullptr};
+        file.tiles.reserve(tiles.size());
+        for (auto &info : tiles) {
+            auto title = shaped(info.label);
+            file.tiles.push_back({.info=std::move(info), .title=std::move(title), .rect={}, .content=nullptr});
+        }
+        files.emplace(path, std::move(file));
+    }
+
+    changes.clear();
+    needs_layout = true;
+}
+
+void ProjectCanvas::relayout() {
+    const Profiler::Scope scope("canvas_layout");
+    const float unit_w = DisplayNode::get_width();
+    const float unit_h = DisplayNode::get_height();
+
+    // rows about as wide as the whole project would be tall if it were square
+    float area = 0;
+    float widest = 0;
+    for (const auto &file : files | std::views::values) {
+        for (const auto &tile : file.tiles) {
+            area += ((tile.info.width * unit_w) + gap) * ((tile.info.height * unit_h) + gap);
+            widest = std::max(widest, tile.info.width * unit_w);
+        }
+    }
+    const float row_limit = std::max(widest, std::sqrt(area));
+
+    float y = 0;
+    float max_x = 0;
+    label_rects.clear();
+    for (auto &file : files | std::views::values) {
+        file.header = {0, y, row_limit, unit_h};
+        y += unit_h + gap;
+
+        float x = 0;
+        float row_h = 0;
+        float file_w = row_limit;
+        for (auto &tile : file.tiles) {
+            const float w = tile.info.width * unit_w;
+            const float h = tile.info.height * unit_h;
+            if (x > 0 && x + w > row_limit) {
+                y += row_h + gap;
+                x = 0;
+                row_h = 0;
+            }
+            tile.rect = {x, y, w, h};
+            x += w + gap;
+            row_h = std::max(row_h, h);
+            file_w = std::max(file_w, x - gap);
+
+            // the first definition wins, like in Ren'Py
+            label_rects.try_emplace(tile.info.label, tile.rect);
+        }
+        y += row_h;
+        file.bounds = {0, file.header.y, file_w, y - file.header.y};
+        max_x = std::max(max_x, file_w);
+        y += file_gap;
+    }
+    bounds = {0, 0, max_x, std::max(0.0f, y - file_gap)};
+
+    // positions changed, so every built tile is out of date
+    for (auto &file : files | std::views::values) {
+        for (auto &tile : file.tiles) {
+            if (tile.content) {
+                resident_geoms -= tile.content->data.geoms.size();
+                tile.content.reset();
+                --built_tiles;
+            }
+        }
+    }
+
+    links.clear();
+    for (const auto &file : files | std::views::values) {
+        for (const auto &tile : file.tiles) {
+            for (const auto &target : tile.info.jumps) {
+                const auto found = label_rects.find(target);
+                if (found == label_rects.end() || (found->second.x == tile.rect.x && found->second.y == tile.rect.y)) {
+                    continue;
+                }
+                const raylib::Vector2 from{tile.rect.x + (tile.rect.width / 2), tile.rect.y + tile.rect.height};
+                const raylib::Vector2 to{found->second.x + (found->second.width / 2), found->second.y};
+                const raylib::Rectangle link_bounds{
+                    std::min(from.x, to.x), std::min(from.y, to.y),
+                    std::abs(to.x - from.x) + 1, std::abs(to.y - from.y) + 1,
+                };
+                links.push_back({.from=from, .to=to, .bounds=link_bounds});
+            }
+        }
+    }
+
+    needs_layout = false;
+    Log::info("project canvas: {} tiles in {} scripts, {} links", n_tiles(), files.size(), links.size());
+}
+
+void ProjectCanvas::release(File &file) {
+    for (auto &tile : file.tiles) {
+        if (tile.content) {
+            resident_geoms -= tile.content->data.geoms.size();
+            tile.content.reset();
+            --built_tiles;
+        }
+    }
+    file.loaded.reset();
+    // a load still in flight finishes on its own, its result is just never picked up
+    file.pending = {};
+}
+
+void ProjectCanvas::build(Tile &tile, RenpyFile &loaded) {
+    auto content = std::make_unique<Content>();
+
+    auto &groups = loaded.layout.get_groups();
+    // the script may have changed on disk since it was indexed, the watcher catches up soon
+    if (tile.info.top < groups.size() && dynamic_cast<const LayoutGroup*>(groups[tile.info.top].get()) != nullptr) {
+        content->data = loaded.layout.make_group_displayables(loaded.graph, tile.info.top, {tile.rect.x, tile.rect.y});
+        content->edges = EdgeRenderer(content->data.line_points);
+    }
+
+    resident_geoms += content->data.geoms.size();
+    ++built_tiles;
+    tile.content = std::move(content);
+}
+
+void ProjectCanvas::cull(const raylib::Rectangle view, const float zoom, ThreadPool &pool, std::vector<DisplayNode*> &on_screen) {
+    using namespace std::chrono_literals;
+
+    if (!changes.empty()) {
+        const NoAllocGuard::Allow allow; // only when a script changed
+        apply_changes();
+    }
+    if (needs_layout) {
+        const NoAllocGuard::Allow allow;
+        relayout();
+    }
+
+    // tiles a bit outside the view are kept too, so they are ready before they scroll in
+    const bool detail = zoom >= detail_zoom;
+    const auto keep = grown(view, view.width / 2, view.height / 2);
+
+    for (auto &[path, file] : files) {
+        const bool near = detail && file.bounds.CheckCollision(keep);
+        if (!near) {
+            if (file.loaded || file.pending.valid()) {
+                release(file);
+            }
+            continue;
+        }
+
+        if (file.pending.valid() && file.pending.wait_for(0s) == std::future_status::ready) {
+            const NoAllocGuard::Allow allow; // once per script coming into view
+            file.loaded = file.pending.get().file;
+        }
+
+        bool wanted = false;
+        for (auto &tile : file.tiles) {
+            if (!tile.rect.CheckCollision(keep)) {
+                if (tile.content) {
+                    resident_geoms -= tile.content->data.geoms.size();
+                    tile.content.reset();
+                    --built_tiles;
+                }
+                continue;
+            }
+
+            wanted = true;
+            if (!file.loaded) {
+                continue;
+            }
+            if (!tile.content) {
+                const NoAllocGuard::Allow allow; // once per tile coming into view
+                build(tile, *file.loaded);
+            }
+            if (!tile.rect.CheckCollision(view)) {
+                continue;
+            }
+
+            if (on_screen.capacity() < resident_geoms) {
+                const NoAllocGuard::Allow allow;
+                on_screen.reserve(resident_geoms);
+            }
+            auto &[data, displays, edges] = *tile.content;
+            displays.next_frame();
+            for (unsigned i = 0; i < data.geoms.size(); ++i) {
+                const auto &geom = data.geoms[i];
+                if (geom.padding_box.CheckCollision(view)) {
+                    // builds the node's text the first time it comes into view
+                    on_screen.push_back(&displays.get(data.geoms, i));
+                }
+            }
+        }
+
+        if (!wanted) {
+            release(file);
+        } else if (!file.loaded && !file.pending.valid()) {
+            const NoAllocGuard::Allow allow;
+            file.pending = pool.submit([path] -> ParseCache::Loaded {
+                const Profiler::FileScope file_scope(path);
+                return ParseCache::load_or_parse(path);
+            });
+        }
+    }
+}
+
+auto ProjectCanvas::draw(const raylib::Rectangle view) const -> unsigned {
+    unsigned edges_drawn = 0;
+
+    for (const auto &file : files | std::views::values) {
+        if (!file.bounds.CheckCollision(view)) {
+            continue;
+        }
+
+        file.header.Draw(DisplayNode::default_color);
+        for (const auto &tile : file.tiles) {
+            if (!tile.rect.CheckCollision(view)) {
+                continue;
+            }
+
+            if (tile.content) {
+                edges_drawn += tile.content->edges.draw(view, DisplayNode::line_color);
+                for (const auto &h : tile.content->data.highlights) {
+                    h.Draw(raylib::Color::Green());
+                }
+            } else {
+                tile.rect.Draw(DisplayNode::default_color);
+            }
+            tile.rect.DrawLines(DisplayNode::line_color);
+        }
+    }
+
+    for (const auto &[from, to, link_bounds] : links) {
+        if (link_bounds.CheckCollision(view)) {
+            DrawLineEx(from, to, 3.0f, raylib::Color{0x3B7DD8C0});
+        }
+    }
+
+    return edges_drawn;
+}
+
+void ProjectCanvas::draw_titles(const raylib::Rectangle view, const raylib::Camera2D &camera) const {
+    for (const auto &file : files | std::views::values) {
+        if (!file.bounds.CheckCollision(view)) {
+            continue;
+        }
+
+        const raylib::Vector2 name_pos = GetWorldToScreen2D({file.header.x, file.header.y}, camera);
+        TextHelper::draw_text(file.name, {std::max(name_pos.x, 10.0f), name_pos.y});
+
+        for (const auto &tile : file.tiles) {
+            // built tiles show their nodes, so only the boxes need a name
+            if (tile.content || !tile.rect.CheckCollision(view) || tile.rect.width * camera.zoom < tile.title.width + 10) {
+                continue;
+            }
+            const raylib::Vector2 pos = GetWorldToScreen2D({tile.rect.x, tile.rect.y}, camera);
+            TextHelper::draw_text(tile.title, {pos.x + 5, pos.y + 5});
+        }
+    }
+}
+
+auto ProjectCanvas::find_label(const std::string_view label) const -> std::optional<raylib::Rectangle> {
+    if (const auto found = label_rects.find(std::string(label)); found != label_rects.end()) {
+        return found->second;
+    }
+    return std::nullopt;
+}
+
+auto ProjectCanvas::find_file(const std::filesystem::path &file) const -> std::optional<raylib::Rectangle> {
+    if (const auto found = files.find(file); found != files.end()) {
+        return found->second.bounds;
+    }
+    return std::nullopt;
+}
+
+auto ProjectCanvas::get_bounds() const -> raylib::Rectangle {
+    return bounds;
+}
+
+auto ProjectCanvas::n_tiles() const -> std::size_t {
+    std::size_t n = 0;
+    for (const auto &file : files | std::views::values) {
+        n += file.tiles.size();
+    }
+    return n;
+}
+
+auto ProjectCanvas::n_built() const -> std::size_t {
+    return built_tiles;
+}
+
+auto ProjectCanvas::n_loaded() const -> std::size_t {
+    return std::ranges::count_if(files | std::views::values, [](const File &file) -> bool {
+        return file.loaded != nullptr;
+    });
+}
@@ -0,0 +1,146 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_PROJECTCANVAS_HPP
+#define RPY_PROJ_ANALYZER_PROJECTCANVAS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "raylib-cpp.hpp"
+
+#include "DisplayCache.hpp"
+#include "EdgeRenderer.hpp"
+#include "GraphLayout.hpp"
+#include "ParseCache.hpp"
+#include "TextHelper.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief The whole project on one canvas, with every label as a tile.
+ *
+ * Only the size of each label is kept for the whole project, which is enough
+ * to place the tiles. A tile's nodes are built when it comes into view, by
+ * loading its script (usually straight from the parse cache), and dropped
+ * again once it is well out of view, along with the script if none of its
+ * other tiles are showing. Zoomed far out, tiles are drawn as plain boxes and
+ * nothing is loaded at all.
+ */
+class ProjectCanvas {
+public:
+    struct TileInfo {
+        std::string label;
+        unsigned line = 0;
+        std::size_t top = 0; // top level group in the script's GraphLayout
+        float width = 1;     // in node widths
+        float height = 1;    // in node heights
+        std::vector<std::string> jumps; // labels jumped to or called from inside this one
+    };
+
+    struct FileTiles {
+        std::filesystem::path file;
+        std::vector<TileInfo> tiles;
+    };
+
+private:
+    struct Content {
+        LayoutData data;
+        DisplayCache displays;
+        EdgeRenderer edges;
+    };
+
+    struct Tile {
+        TileInfo info;
+        TextHelper::DispText title;
+        raylib::Rectangle rect{};
+        std::unique_ptr<Content> content; // only while in or near the view
+    };
+
+    struct File {
+        std::vector<Tile> tiles;
+        TextHelper::DispText name;
+        raylib::Rectangle header{};
+        raylib::Rectangle bounds{}; // header and every tile
+        std::future<ParseCache::Loaded> pending;
+        std::unique_ptr<RenpyFile> loaded; // only while one of its tiles has content
+    };
+
+    struct Link {
+        raylib::Vector2 from;
+        raylib::Vector2 to;
+        raylib::Rectangle bounds;
+    };
+
+    std::map<std::filesystem::path, File> files; // in file tree order
+    // the newest tiles of every script changed since the last cull, empty if it was removed
+    std::unordered_map<std::filesystem::path, std::vector<TileInfo>> changes;
+    std::vector<Link> links;                     // jumps and calls between tiles
+    std::unordered_map<std::string, raylib::Rectangle> label_rects;
+    raylib::Rectangle bounds{};
+    bool needs_layout = false;
+    std::size_t resident_geoms = 0;
+    std::size_t built_tiles = 0;
+
+    void apply_changes();
+    void relayout();
+    void release(File &file);
+    void build(Tile &tile, RenpyFile &loaded);
+
+public:
+    static constexpr float detail_zoom = 0.15f; // below this tiles are only boxes
+    static constexpr float min_zoom = 0.02f;
+
+    /**
+     * @brief the tiles of one parsed script.
+     */
+    static auto collect(const std::filesystem::path &file, const RenpyFile &loaded) -> FileTiles;
+
+    /**
+     * @brief replaces the tiles of `tiles.file`. Takes effect at the next `cull`.
+     *
+     * Only the newest tiles of a script are kept until then, so however many
+     * changes come in while the canvas isn't shown, it is laid out once.
+     */
+    void update(FileTiles tiles);
+    void remove(const std::filesystem::path &file);
+
+    /**
+     * @brief places the tiles again if the project changed, builds the tiles near `view`
+     * and drops the rest, and adds the DisplayNodes inside `view` to `on_screen`.
+     *
+     * Scripts that need loading are loaded on `pool`, so their tiles fill in a few frames later.
+     */
+    void cull(raylib::Rectangle view, float zoom, ThreadPool &pool, std::vector<DisplayNode*> &on_screen);
+
+    /**
+     * @brief draws the tiles, their edges and the links between them, in world coordinates.
+     * @return the number of edges drawn.
+     */
+    [[nodiscard]] auto draw(raylib::Rectangle view) const -> unsigned;
+
+    /**
+     * @brief draws the label and script names in screen coordinates, wherever they fit.
+     */
+    void draw_titles(raylib::Rectangle view, const raylib::Camera2D &camera) const;
+
+    [[nodiscard]] auto find_label(std::string_view label) const -> std::optional<raylib::Rectangle>;
+    [[nodiscard]] auto find_file(const std::filesystem::path &file) const -> std::optional<raylib::Rectangle>;
+
+    [[nodiscard]] auto get_bounds() const -> raylib::Rectangle;
+    [[nodiscard]] auto n_tiles() const -> std::size_t;
+    [[nodiscard]] auto n_built() const -> std::size_t;
+    [[nodiscard]] auto n_loaded() const -> std::size_t;
+};
+
+#endif //RPY_PROJ_ANALYZER_PROJECTCANVAS_HPP
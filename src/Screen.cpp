@@ -4,11 +4,30 @@
 
 #include "Screen.hpp"
 
-#include <ranges>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <format>
+#include <utility>
 #include <raylib.h>
 
+#include "AllocCounter.hpp"
 #include "App.hpp"
 #include "ArgVParser.hpp"
+#include "ParseCache.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    /**
+     * @brief formats into a buffer on the stack, since the debug overlay is redrawn every frame.
+     */
+    template<typename... Args>
+    void draw_debug_text(const int x, const int y, std::format_string<Args...> fmt, Args&&... args) {
+        std::array<char, 128> buf{};
+        *std::format_to_n(buf.data(), buf.size() - 1, fmt, std::forward<Args>(args)...).out = '\0';
+        raylib::DrawText(buf.data(), x, y, 20, raylib::Color::Blue());
+    }
+}
 
 LoadScreen::LoadScreen() = default;
 
@@ -64,69 +83,42 @@ void LoadScreen::draw(const raylib::Window &win) {
     }
 }
 
-ViewScreen::ViewScreen(const std::filesystem::path &path, const raylib::Window &win, const bool is_dir) {
+ViewScreen::ViewScreen(const std::filesystem::path &path, const raylib::Window &win, const bool is_dir)
+    : cache(ArgVParser::cache_mb ? static_cast<std::size_t>(*ArgVParser::cache_mb) * 1024 * 1024 : ScriptCache::default_budget) {
+    camera.target = {0.0f, 0.0f};
+    camera.offset = {0.0f, 0.0f};
+    camera.rotation = 0.0f;
+    camera.zoom = 1.0f;
+    min_x = 0.0f;
+    max_x = 0.0f;
+    min_y = 0.0f;
+    max_y = 0.0f;
+    other_camera = camera;
+
     if (is_dir) {
-        camera.target = {0.0f, 0.0f};
-        camera.offset = {0.0f, 0.0f};
-        camera.rotation = 0.0f;
-        camera.zoom = 1.0f;
-        min_x = 0.0f;
-        max_x = 0.0f;
-        min_y = 0.0f;
-        max_y = 0.0f;
         file_tree = std::make_unique<FileTreePanel>(path);
     } else {
-        raylib::SetWindowTitle(std::format("rpy_proj_analyzer: {}", path.filename().string()));
-        scripts[path] = std::make_unique<RenpyFile>(path);
-        auto [disps, line_pts, hlights] = scripts[path]->layout.make_displayables(scripts[path]->graph);
-        this->display_nodes = std::move(disps);
-        this->line_points = std::move(line_pts);
-        this->highlights = std::move(hlights);
-
-        auto dn_min_x = std::numeric_limits<float>::max();
-        auto dn_max_x = -std::numeric_limits<float>::max();
-        auto dn_min_y = std::numeric_limits<float>::max();
-        auto dn_max_y = -std::numeric_limits<float>::max();
-
-        const auto &first_node = display_nodes.front();
-
-        for (const auto &dn : display_nodes) {
-            if (dn.padding_box.x < dn_min_x) {
-                dn_min_x = dn.padding_box.x;
-            } else if (dn.padding_box.x > dn_max_x) {
-                dn_max_x = dn.padding_box.x;
-            }
-
-            if (dn.padding_box.y < dn_min_y) {
-                dn_min_y = dn.padding_box.y;
-            } else if (dn.padding_box.y > dn_max_y) {
-                dn_max_y = dn.padding_box.y;
-            }
-        }
-
-        const auto init_x = first_node.padding_box.x + (first_node.padding_box.width / 2) - (static_cast<float>(win.GetWidth()) / 2);
-        camera.target = {init_x, 0.0f};
-        camera.offset = {0.0f, 0.0f};
-        camera.rotation = 0.0f;
-        camera.zoom = 1.0f;
-
-        min_x = 0.0f;
-        max_x = (scripts[path]->layout.get_max_width() * DisplayNode::get_width()) - 40.0f;
-        // const float min_y = -40.0f;
-        min_y = 0.0f;
-        // const float max_y = display_nodes.back().box.y + display_nodes.back().box.height - 40.0f;
-        max_y = dn_max_y - 40.0f;
+        loader.request(path);
     }
+
+    watcher = std::make_unique<FileWatcher>(path);
+    index_project(path);
 }
 
-void ViewScreen::setup_viewport(const std::filesystem::path &path, const raylib::Window &win) {
-    raylib::SetWindowTitle(std::format("rpy_proj_analyzer: {}", path.filename().string()));
-    const auto &file = scripts.at(path);
-    auto [disps, line_pts, hlights] = file->layout.make_displayables(file->graph);
-    this->display_nodes = std::move(disps);
-    this->line_points = std::move(line_pts);
-    this->highlights = std::move(hlights);
-    // std::tie(display_nodes, line_points) = file->layout.make_displayables(file->graph);
+void ViewScreen::setup_viewport(ScriptCache::Entry &entry, const raylib::Window &win, const bool keep_camera) {
+    raylib::SetWindowTitle(std::format("rpy_proj_analyzer: {}", entry.path.filename().string()));
+    this->current = &entry;
+    this->on_screen.clear();
+    // never more than every node, so culling doesn't have to grow it later
+    this->on_screen.reserve(entry.data.geoms.size());
+    this->clicked_node = nullptr;
+    cache.pin(current);
+
+    const auto &file = entry.file;
+    const auto &display_nodes = entry.data.geoms;
+    if (display_nodes.empty()) {
+        return;
+    }
 
     auto dn_min_x = std::numeric_limits<float>::max();
     auto dn_max_x = -std::numeric_limits<float>::max();
@@ -149,11 +141,13 @@ void ViewScreen::setup_viewport(const std::filesystem::path &path, const raylib:
         }
     }
 
-    const auto init_x = first_node.padding_box.x + (first_node.padding_box.width / 2) - (static_cast<float>(win.GetWidth()) / 2);
-    camera.target = {init_x, 0.0f};
-    camera.offset = {0.0f, 0.0f};
-    camera.rotation = 0.0f;
-    camera.zoom = 1.0f;
+    if (!keep_camera) {
+        const auto init_x = first_node.padding_box.x + (first_node.padding_box.width / 2) - (static_cast<float>(win.GetWidth()) / 2);
+        camera.target = {init_x, 0.0f};
+        camera.offset = {0.0f, 0.0f};
+        camera.rotation = 0.0f;
+        camera.zoom = 1.0f;
+    }
 
     min_x = 0.0f;
     max_x = (file->layout.get_max_width() * DisplayNode::get_width()) - 40.0f;
@@ -164,7 +158,141 @@ void ViewScreen::setup_viewport(const std::filesystem::path &path, const raylib:
 
 }
 
-void ViewScreen::update(const raylib::Window &win, State& state) {
+void ViewScreen::index_project(const std::filesystem::path &path) {
+    auto index_script = [this](const std::filesystem::path &script) -> void {
+        indexing.push_back(pool.submit([script, gen = ++generation] -> Indexed {
+            const Profiler::FileScope file_scope(script);
+            const auto loaded = ParseCache::load_or_parse(script);
+            return {.path=script, .generation=gen,
+                .symbols=LabelIndex::collect(script, loaded.file->graph),
+                .tiles=ProjectCanvas::collect(script, *loaded.file)};
+        }));
+    };
+
+    if (!std::filesystem::is_directory(path)) {
+        index_script(path);
+        return;
+    }
+
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, ec)) {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".rpy") {
+            index_script(entry.path());
+        }
+    }
+}
+
+void ViewScreen::refresh_script(const std::filesystem::path &path) {
+    if (refreshing.contains(path)) {
+        requeue.insert(path);
+        return;
+    }
+
+    // only lay out scripts someone is looking at or is likely to come back to
+    const bool display = (current != nullptr && current->path == path) || cache.contains(path);
+
+    // the old layout, so the parts of the script that weren't edited keep theirs
+    std::vector<LayoutSnapshot> prev;
+    if (display) {
+        const auto *entry = current != nullptr && current->path == path ? current : cache.peek(path);
+        if (entry != nullptr) {
+            prev = entry->file->layout.snapshot();
+        }
+    }
+
+    auto result = pool.submit([path, display, prev = std::move(prev)] -> ScriptLoader::Result {
+        const Profiler::FileScope file_scope(path);
+        auto [stamp, file] = ParseCache::load_or_parse(path, prev);
+        LayoutData data;
+        if (display) {
+            data = file->layout.make_displayables(file->graph);
+        }
+        return {.path=path, .stamp=stamp, .file=std::move(file), .data=std::move(data)};
+    });
+    refreshing.emplace(path, Refresh{.result=std::move(result), .display=display, .generation=++generation});
+}
+
+auto ViewScreen::take_generation(const std::filesystem::path &path, const std::uint64_t gen) -> bool {
+    auto &last = applied[path];
+    if (gen < last) {
+        return false;
+    }
+    last = gen;
+    return true;
+}
+
+void ViewScreen::apply_changes(const raylib::Window &win) {
+    using namespace std::chrono_literals;
+
+    if (watcher) {
+        bool tree_changed = false;
+        for (const auto &[path, added, removed] : watcher->poll()) {
+            tree_changed = tree_changed || added || removed;
+            if (removed) {
+                // anything still running for it is older than this
+                applied[path] = ++generation;
+                labels.remove(path);
+                canvas.remove(path);
+            } else {
+                refresh_script(path);
+            }
+        }
+        if (tree_changed && file_tree) {
+            file_tree->rescan();
+        }
+    }
+
+    for (auto it = indexing.begin(); it != indexing.end();) {
+        if (it->wait_for(0s) == std::future_status::ready) {
+            // a refresh or removal that finished first already has newer data
+            if (auto [path, gen, symbols, tiles] = it->get(); take_generation(path, gen)) {
+                labels.update(std::move(symbols));
+                canvas.update(std::move(tiles));
+            }
+            it = indexing.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::vector<std::filesystem::path> again;
+    for (auto it = refreshing.begin(); it != refreshing.end();) {
+        auto &[path, refresh] = *it;
+        if (refresh.result.wait_for(0s) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        auto result = refresh.result.get();
+        const bool newest = take_generation(path, refresh.generation);
+        if (newest) {
+            labels.update(LabelIndex::collect(path, result.file->graph));
+            canvas.update(ProjectCanvas::collect(path, *result.file));
+        }
+        if (newest && refresh.display) {
+            const bool is_current = current != nullptr && current->path == path;
+            auto *entry = cache.insert(std::move(result));
+            if (is_current) {
+                // same script, so leave the camera where the user had it
+                setup_viewport(*entry, win, true);
+            }
+        }
+
+        if (requeue.erase(path) > 0) {
+            again.push_back(path);
+        }
+        it = refreshing.erase(it);
+    }
+
+    for (const auto &path : again) {
+        refresh_script(path);
+    }
+}
+
+void ViewScreen::update_view(const raylib::Window &win) {
+    // runs every frame, so it must not touch the heap
+    const NoAllocGuard guard("ViewScreen::update_view");
+
     if (IsKeyPressed(KEY_UP)) {
         scroll_speed += 5.0f;
     } else if (IsKeyPressed(KEY_DOWN)) {
@@ -175,6 +303,18 @@ void ViewScreen::update(const raylib::Window &win, State& state) {
         debug = !debug;
     }
 
+    if (App::mod_down() && IsKeyPressed(KEY_P)) {
+        project_view = !project_view;
+        std::swap(camera, other_camera);
+        on_screen.clear();
+        clicked_node = nullptr;
+        if (!project_view && current != nullptr) {
+            const NoAllocGuard::Allow allow; // only when switching views
+            // puts the script's bounds back
+            setup_viewport(*current, win, true);
+        }
+    }
+
     if (!App::mod_down()) {
         if (IsKeyDown(KEY_S)) {
             camera.target.y += 5;
@@ -189,8 +329,13 @@ void ViewScreen::update(const raylib::Window &win, State& state) {
         }
     }
 
+    // the file tree scrolls itself while the mouse is over it
+    const bool over_panel = file_tree && file_tree->hovered();
+
     if (App::alt_down()) {
         scroll_speed += GetMouseWheelMove();
+    } else if (over_panel) {
+        // nothing, the wheel belongs to the panel
     } else if (App::shift_down()) {
         camera.target.x -= (GetMouseWheelMoveV().y * scroll_speed);
     } else if (!App::mod_down()) {
@@ -204,7 +349,7 @@ void ViewScreen::update(const raylib::Window &win, State& state) {
 
     const raylib::Vector2 before_zoom = GetScreenToWorld2D(GetMousePosition(), camera);
 
-    if (App::mod_down()) {
+    if (App::mod_down() && !over_panel) {
         camera.zoom += GetMouseWheelMove() / 10;
     } else if (IsKeyPressed(KEY_MINUS) || (IsKeyPressed(KEY_KP_SUBTRACT))) {
         camera.zoom -= 0.1f;
@@ -214,36 +359,56 @@ void ViewScreen::update(const raylib::Window &win, State& state) {
         camera.zoom = 1.0f;
     }
 
-    camera.zoom = std::clamp(camera.zoom, min_zoom, max_zoom);
+    camera.zoom = std::clamp(camera.zoom, project_view ? ProjectCanvas::min_zoom : min_zoom, max_zoom);
 
     const raylib::Vector2 curr_mouse_pos = GetScreenToWorld2D(GetMousePosition(), camera);
 
     camera.target.x += (before_zoom.x - curr_mouse_pos.x);
     camera.target.y += (before_zoom.y - curr_mouse_pos.y);
 
+    if (project_view) {
+        // the canvas grows while the project is being indexed
+        const auto bounds = canvas.get_bounds();
+        min_x = bounds.x - 40.0f;
+        max_x = std::max(min_x, bounds.x + bounds.width - 40.0f);
+        min_y = bounds.y - 40.0f;
+        max_y = std::max(min_y, bounds.y + bounds.height - 40.0f);
+    }
+
     camera.target.x = std::clamp(camera.target.x, min_x, max_x);
     camera.target.y = std::clamp(camera.target.y, min_y, max_y);
 
     auto [cam_min_x, cam_min_y] = GetScreenToWorld2D({0.0f, 0.0f}, camera);
     auto [cam_max_x, cam_max_y] = GetScreenToWorld2D({static_cast<float>(win.GetWidth()), static_cast<float>(win.GetHeight())}, camera);
-
-    on_screen = display_nodes
-        | std::views::filter([&](const DisplayNode &dn) -> bool {
-            const auto top_y = cam_min_y - dn.padding_box.height - 50;
+    view_rect = raylib::Rectangle{cam_min_x, cam_min_y, cam_max_x - cam_min_x, cam_max_y - cam_min_y};
+
+    // refilled in place, setup_viewport reserved room for every node
+    on_screen.clear();
+    if (project_view) {
+        canvas.cull(view_rect, camera.zoom, pool, on_screen);
+    } else if (current != nullptr) {
+        current->displays.next_frame();
+        const auto &geoms = current->data.geoms;
+        for (unsigned i = 0; i < geoms.size(); ++i) {
+            const auto &geom = geoms[i];
+            const auto top_y = cam_min_y - geom.padding_box.height - 50;
             const auto bottom_y = cam_max_y + 50;
-            const auto left_x = cam_min_x - dn.padding_box.width - 50;
+            const auto left_x = cam_min_x - geom.padding_box.width - 50;
             const auto right_x = cam_max_x + 50;
-            const auto visible_x = dn.main_box.x == std::clamp(dn.main_box.x, left_x, right_x);
-            const auto visible_y = dn.main_box.y == std::clamp(dn.main_box.y, top_y, bottom_y);
-            return visible_x && visible_y;
-        })
-        | std::views::transform([](auto &dn) -> DisplayNode* { return &dn; })
-        | std::ranges::to<std::vector<DisplayNode*>>();
+            const auto visible_x = geom.main_box.x == std::clamp(geom.main_box.x, left_x, right_x);
+            const auto visible_y = geom.main_box.y == std::clamp(geom.main_box.y, top_y, bottom_y);
+            if (visible_x && visible_y) {
+                // builds the node's text the first time it comes into view
+                on_screen.push_back(&current->displays.get(geoms, i));
+            }
+        }
+        cache.update_displays(*current);
+    }
 
     for (const auto &dn : on_screen) {
         dn->is_mouse_hovering(camera);
         if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            const bool same_clicked = (dn == clicked_ptr);
+            const bool same_clicked = (dn->get_underlying() == clicked_node);
             const bool double_click = [&] () -> bool {
                 if (last_clicked) {
                     if (std::chrono::steady_clock::now() - *last_clicked <= std::chrono::milliseconds(500)) {
@@ -255,42 +420,95 @@ void ViewScreen::update(const raylib::Window &win, State& state) {
             }();
             const bool collide = dn->main_box.CheckCollision(curr_mouse_pos);
             if (collide && same_clicked && double_click) {
+                const NoAllocGuard::Allow allow;
+                // on the canvas, double clicking a jump or call follows it
+                const auto *jump = dynamic_cast<const NodeJump*>(clicked_node);
+                const auto *call = dynamic_cast<const NodeCall*>(clicked_node);
+                const auto target = !project_view ? std::nullopt
+                    : jump != nullptr ? canvas.find_label(jump->get_label())
+                    : call != nullptr ? canvas.find_label(call->get_label())
+                    : std::nullopt;
+                if (target) {
+                    center_on(*target, win);
+                    last_clicked.reset();
+                    break;
+                }
                 auto now = std::chrono::system_clock::now();
                 std::println("clicked waow {}", now.time_since_epoch());
             } else if (collide) {
                 last_clicked = std::chrono::steady_clock::now();
-                clicked_ptr = dn;
+                clicked_node = dn->get_underlying();
             }
         }
     }
+}
+
+void ViewScreen::center_on(const raylib::Rectangle rect, const raylib::Window &win) {
+    // the camera's target is the top left of the view
+    const auto view_w = static_cast<float>(win.GetWidth()) / camera.zoom;
+    camera.target = {rect.x + (rect.width / 2) - (view_w / 2), rect.y - 40.0f};
+}
+
+void ViewScreen::update(const raylib::Window &win, State& state) {
+    update_view(win);
+
+    // on the canvas, a script opened now is set up for when the canvas is left
+    auto show = [&](ScriptCache::Entry &entry) -> void {
+        if (project_view) {
+            std::swap(camera, other_camera);
+        }
+        setup_viewport(entry, win);
+        if (project_view) {
+            std::swap(camera, other_camera);
+        }
+    };
 
     if (file_tree) {
         const auto prev_script = file_tree->curr_script;
         file_tree->update(win);
         if (auto cs = file_tree->curr_script; cs != prev_script) {
-            scripts[*cs] = std::make_unique<RenpyFile>(*cs);
-            setup_viewport(*cs, win);
+            if (const auto where = project_view ? canvas.find_file(*cs) : std::nullopt) {
+                center_on(*where, win);
+            } else if (auto *entry = cache.find(*cs)) {
+                loader.cancel();
+                show(*entry);
+            } else {
+                loader.request(*cs);
+            }
         }
     }
+
+    // swapping in a finished script only ever happens here, between two frames
+    if (auto loaded = loader.poll()) {
+        show(*cache.insert(std::move(*loaded)));
+    }
+
+    apply_changes(win);
+}
+
+auto ViewScreen::settled() const -> bool {
+    return current != nullptr && !loader.busy() && indexing.empty() && refreshing.empty();
 }
 
 void ViewScreen::draw(const raylib::Window &win) {
-    std::string hover_text;
+    const NoAllocGuard guard("ViewScreen::draw");
+    const TextHelper::DispText *hover_text = nullptr;
 
     camera.BeginMode();
     {
-        for (const auto &points : line_points) {
-            // DrawSplineBasis(points.data(), 5, 2.0, raylib::Color::Red());
-            // DrawLineEx(points.at(1), points.at(3), 2.0, raylib::Color::Red());
-        }
+        if (project_view) {
+            edges_drawn = canvas.draw(view_rect);
+        } else if (current != nullptr) {
+            edges_drawn = current->edges.draw(view_rect, DisplayNode::line_color);
 
-        for (const auto &h : highlights) {
-            h.Draw(raylib::Color::Green());
+            for (const auto &h : current->data.highlights) {
+                h.Draw(raylib::Color::Green());
+            }
         }
 
         for (const auto& dn : on_screen) {
-            if (const auto &text = dn->draw()) {
-                hover_text = *text;
+            if (const auto *text = dn->draw()) {
+                hover_text = text;
             }
             if (debug) {
                 dn->margin_box.DrawLines(raylib::Color::Orange());
@@ -298,38 +516,95 @@ void ViewScreen::draw(const raylib::Window &win) {
                 dn->padding_box.DrawLines(raylib::Color::Lime());
             }
         }
+        if (debug && !project_view && current != nullptr) {
+            for (const auto &overlap : current->data.overlaps) {
+                overlap.area.Draw(raylib::Color{0xE6292980});
+            }
+        }
+        TextHelper::flush_text();
     }
 
     camera.EndMode();
 
-    if (!hover_text.empty()) {
+    if (project_view) {
+        canvas.draw_titles(view_rect, camera);
+        TextHelper::flush_text();
+    }
+
+    if (hover_text != nullptr) {
         constexpr auto box_height = 40.0f; // TODO: make this not magic
-        const auto text_width = TextHelper::text_width(hover_text);
+        const auto text_width = TextHelper::text_width(*hover_text);
         auto x = static_cast<float>(GetMouseX());
         auto y = static_cast<float>(GetMouseY()) - box_height;
 
         const raylib::Rectangle hover_box(x, y, text_width + 2, box_height);
         hover_box.Draw(DisplayNode::default_color);
         hover_box.DrawLines(DisplayNode::line_color);
-        TextHelper::draw_text(hover_text, {x, y}, hover_box.width);
+        TextHelper::draw_text(*hover_text, {x, y}, hover_box.width);
+        TextHelper::flush_text();
     }
 
     if (file_tree) {
         file_tree->draw(win);
     }
 
+    if (loader.busy()) {
+        const NoAllocGuard::Allow allow; // only while a script is loading
+        const auto pending = loader.pending_path();
+        const auto msg = std::format("Loading {{b}}{}{{/b}}: {}...",
+            pending ? pending->filename().string() : "", ScriptLoader::stage_str(loader.stage()));
+        const auto msg_w = TextHelper::text_width(msg);
+        const auto msg_x = (static_cast<float>(win.GetWidth()) / 2.0f) - (msg_w / 2.0f);
+        const auto msg_y = static_cast<float>(win.GetHeight()) - 60.0f;
+        const raylib::Rectangle msg_box(msg_x - 10.0f, msg_y - 10.0f, msg_w + 20.0f, TextHelper::font_size + 20.0f);
+        msg_box.Draw(DisplayNode::default_color);
+        msg_box.DrawLines(DisplayNode::line_color);
+        TextHelper::draw_text(msg, {msg_x, msg_y});
+        TextHelper::flush_text();
+    }
+
     if (debug) {
         raylib::Rectangle(0, 0, static_cast<float>(win.GetWidth()), 50).Draw(raylib::Color{0xF5F5F5AF});
         DrawFPS(GetScreenWidth() - 80, 5);
-        raylib::DrawText(std::format("scroll speed: {:.1f}", scroll_speed).c_str(),
-            10, 5, 20, raylib::Color::Blue());
-        raylib::DrawText(std::format("cam x: {}", camera.target.x).c_str(),
-            200, 5, 20, raylib::Color::Blue());
-        raylib::DrawText(std::format("cam y: {}", camera.target.y).c_str(),
-            400, 5, 20, raylib::Color::Blue());
-        raylib::DrawText(std::format("on screen nodes: {}", on_screen.size()).c_str(),
-            10, 25, 20, raylib::Color::Blue());
-        raylib::DrawText(std::format("camera zoom: {:.2f}", camera.zoom).c_str(),
-            300, 25, 20, raylib::Color::Blue());
+        draw_debug_text(10, 5, "scroll speed: {:.1f}", scroll_speed);
+        draw_debug_text(200, 5, "cam x: {}", camera.target.x);
+        draw_debug_text(400, 5, "cam y: {}", camera.target.y);
+        draw_debug_text(10, 25, "on screen nodes: {} ({} built)", on_screen.size(),
+            !project_view && current != nullptr ? current->displays.size() : 0);
+        draw_debug_text(300, 25, "camera zoom: {:.2f}", camera.zoom);
+        draw_debug_text(500, 25, "edges: {} / {}", edges_drawn,
+            project_view ? edges_drawn : current != nullptr ? current->edges.size() : 0);
+        if (project_view) {
+            const auto bottom = win.GetHeight() - 30;
+            raylib::Rectangle(0, static_cast<float>(bottom), 560, 30).Draw(raylib::Color{0xF5F5F5AF});
+            draw_debug_text(10, bottom + 5, "tiles: {} / {} built, {} scripts loaded",
+                canvas.n_built(), canvas.n_tiles(), canvas.n_loaded());
+        }
+        const auto [hits, misses, evictions, resident, entries] = cache.get_stats();
+        draw_debug_text(700, 25, "cache: {} hit / {} miss, {:.1f} / {:.0f} MB in {} scripts",
+            hits, misses,
+            static_cast<double>(resident) / (1024.0 * 1024.0),
+            static_cast<double>(cache.get_budget()) / (1024.0 * 1024.0),
+            entries);
+        draw_debug_text(600, 5, "labels: {} in {} scripts, {} unresolved{} ({})",
+            labels.n_labels(), labels.n_files(), labels.n_unresolved(),
+            indexing.empty() ? "" : ", indexing...",
+            watcher == nullptr ? "not watching" : watcher->using_inotify() ? "inotify" : "polling");
+
+        if (current != nullptr && Profiler::enabled()) {
+            // totals over every time this script was loaded, scopes are inclusive
+            const NoAllocGuard::Allow allow; // copies the totals out from under the profiler's lock
+            const auto phases = Profiler::file_totals(current->path);
+            raylib::Rectangle(0, 50, 520, 20.0f * static_cast<float>(phases.size() + 1) + 10.0f)
+                .Draw(raylib::Color{0xF5F5F5AF});
+            raylib::DrawText("phase                      ms       KB   allocs", 10, 55, 20, raylib::Color::Blue());
+            int y = 75;
+            for (const auto &[phase, t] : phases) {
+                draw_debug_text(10, y, "{:<20} {:>9.2f} {:>8.1f} {:>8}",
+                    phase, std::chrono::duration<double, std::milli>(t.time).count(),
+                    static_cast<double>(t.bytes) / 1024.0, t.allocs);
+                y += 20;
+            }
+        }
     }
 }
@@ -6,18 +6,28 @@
 #define RPY_PROJ_ANALYZER_SCREEN_HPP
 
 #include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <future>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "raylib-cpp.hpp"
 
 #include "DisplayNode.hpp"
+#include "EdgeRenderer.hpp"
+#include "FileWatcher.hpp"
 #include "Graph.hpp"
 #include "GraphLayout.hpp"
+#include "LabelIndex.hpp"
 #include "Lexer.hpp"
 #include "Panel.hpp"
+#include "ProjectCanvas.hpp"
+#include "ScriptCache.hpp"
+#include "ScriptLoader.hpp"
+#include "ThreadPool.hpp"
 
 struct State;
 
@@ -55,30 +65,19 @@ class ViewScreen final : public Screen {
     static constexpr float min_zoom = 0.2f;
     static constexpr float max_zoom = 2.0f;
 
-    struct RenpyFile {
-        // Lexer lexer;
-        Graph graph;
-        GraphLayout layout;
-
-        explicit RenpyFile(const std::filesystem::path &path)
-            : graph(path), layout(graph) {
-        }
-    };
-
-    std::unordered_map<std::filesystem::path, std::unique_ptr<RenpyFile>> scripts;
-
-    std::vector<DisplayNode> display_nodes;
-    std::vector<std::array<raylib::Vector2, 5>> line_points;
-    std::vector<raylib::Rectangle> highlights;
+    ScriptCache cache;
+    ScriptCache::Entry *current = nullptr;
+    unsigned edges_drawn = 0;
 
     raylib::Camera2D camera;
+    raylib::Rectangle view_rect{};
     float min_x;
     float max_x;
     float min_y;
     float max_y;
 
     std::optional<std::chrono::steady_clock::time_point> last_clicked;
-    DisplayNode *clicked_ptr = nullptr;
+    const Node *clicked_node = nullptr; // DisplayNodes come and go, the Node stays
 
     bool debug = true;
 
@@ -86,12 +85,55 @@ class ViewScreen final : public Screen {
 
     std::unique_ptr<FileTreePanel> file_tree = nullptr;
 
-    void setup_viewport(const std::filesystem::path &path, const raylib::Window &win);
+    ScriptLoader loader;
+
+    ProjectCanvas canvas;
+    bool project_view = false; // the whole project instead of one script
+    raylib::Camera2D other_camera; // where the view that isn't showing was left
+
+    struct Indexed {
+        std::filesystem::path path;
+        std::uint64_t generation;
+        LabelIndex::FileSymbols symbols;
+        ProjectCanvas::FileTiles tiles;
+    };
+
+    struct Refresh {
+        std::future<ScriptLoader::Result> result;
+        bool display; // whether the result has displayables worth keeping
+        std::uint64_t generation;
+    };
+
+    ThreadPool pool;
+    LabelIndex labels;
+    std::unique_ptr<FileWatcher> watcher = nullptr;
+    std::vector<std::future<Indexed>> indexing;
+    std::unordered_map<std::filesystem::path, Refresh> refreshing;
+    std::unordered_set<std::filesystem::path> requeue; // changed again while being refreshed
+    std::uint64_t generation = 0; // bumped for every indexing job, refresh and removal
+    std::unordered_map<std::filesystem::path, std::uint64_t> applied; // generation labels and canvas hold, per script
+
+    void setup_viewport(ScriptCache::Entry &entry, const raylib::Window &win, bool keep_camera = false);
+    void index_project(const std::filesystem::path &path);
+    void refresh_script(const std::filesystem::path &path);
+    void apply_changes(const raylib::Window &win);
+
+    /**
+     * @brief whether a result of `gen` for `path` is newer than what was applied, and marks it applied if so.
+     */
+    auto take_generation(const std::filesystem::path &path, std::uint64_t gen) -> bool;
+    void update_view(const raylib::Window &win);
+    void center_on(raylib::Rectangle rect, const raylib::Window &win);
 
 public:
     explicit ViewScreen(const std::filesystem::path &path, const raylib::Window &win, bool is_dir);
     void update(const raylib::Window &win, State& state) override;
     void draw(const raylib::Window &win) override;
+
+    /**
+     * @brief whether a script is shown and nothing is loading, indexing or refreshing, so frames are steady-state.
+     */
+    [[nodiscard]] auto settled() const -> bool;
 };
 
 #endif //RPY_PROJ_ANALYZER_SCREEN_HPP
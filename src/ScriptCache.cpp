@@ -0,0 +1,145 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "ScriptCache.hpp"
+
+#include <utility>
+
+auto ScriptCache::estimate_bytes(const Entry &entry) -> std::size_t {
+    const auto &[geoms, line_points, highlights, overlaps] = entry.data;
+
+    // the DisplayNodes are built later, as they come into view, see update_displays
+    std::size_t bytes = sizeof(Entry) + sizeof(RenpyFile);
+    bytes += entry.file->graph.resident_bytes();
+    bytes += geoms.capacity() * sizeof(NodeGeom);
+    bytes += line_points.capacity() * sizeof(line_points.front());
+    bytes += highlights.capacity() * sizeof(raylib::Rectangle);
+    bytes += overlaps.capacity() * sizeof(LayoutOverlap);
+    bytes += entry.edges.resident_bytes();
+
+    return bytes;
+}
+
+void ScriptCache::evict(const Entry *keep) {
+    auto it = lru.end();
+    while (resident > budget && it != lru.begin()) {
+        --it;
+        if (&*it == pinned || &*it == keep) {
+            continue;
+        }
+
+        resident -= it->bytes;
+        index.erase(it->path);
+        it = lru.erase(it);
+        stats.evictions++;
+    }
+}
+
+ScriptCache::ScriptCache(const std::size_t budget_bytes)
+    : budget(budget_bytes) {
+}
+
+auto ScriptCache::find(const std::filesystem::path &path) -> Entry* {
+    const auto found = index.find(path);
+    if (found == index.end()) {
+        stats.misses++;
+        return nullptr;
+    }
+
+    auto &entry = *found->second;
+
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    const auto size = ec ? 0 : std::filesystem::file_size(path, ec);
+
+    bool fresh = !ec && mtime == entry.stamp.mtime && size == entry.stamp.size;
+    if (!fresh && !ec && size == entry.stamp.size) {
+        // touched but maybe not edited, let the contents decide
+        if (FileStamp::hash_file(path) == entry.stamp.hash) {
+            entry.stamp.mtime = mtime;
+            fresh = true;
+        }
+    }
+
+    if (!fresh) {
+        if (&entry != pinned) {
+            resident -= entry.bytes;
+            lru.erase(found->second);
+            index.erase(found);
+        }
+        stats.misses++;
+        return nullptr;
+    }
+
+    lru.splice(lru.begin(), lru, found->second);
+    stats.hits++;
+    return &lru.front();
+}
+
+auto ScriptCache::insert(ScriptLoader::Result result) -> Entry* {
+    if (const auto found = index.find(result.path); found != index.end()) {
+        if (&*found->second == pinned) {
+            pinned = nullptr;
+        }
+        resident -= found->second->bytes;
+        lru.erase(found->second);
+        index.erase(found);
+    }
+
+    const auto added = lru.emplace(lru.begin());
+    auto &entry = *added;
+    entry.path = std::move(result.path);
+    entry.stamp = result.stamp;
+    entry.file = std::move(result.file);
+    entry.data = std::move(result.data);
+    entry.edges = EdgeRenderer(entry.data.line_points);
+    entry.base_bytes = estimate_bytes(entry);
+    entry.bytes = entry.base_bytes + entry.displays.resident_bytes();
+
+    index[entry.path] = added;
+    resident += entry.bytes;
+
+    // it's about to be shown, even if it's bigger than the whole budget
+    evict(&entry);
+
+    return &entry;
+}
+
+void ScriptCache::update_displays(Entry &entry) {
+    const auto bytes = entry.base_bytes + entry.displays.resident_bytes();
+    if (bytes == entry.bytes) {
+        return;
+    }
+
+    resident = resident - entry.bytes + bytes;
+    entry.bytes = bytes;
+    if (resident > budget) {
+        evict(&entry);
+    }
+}
+
+void ScriptCache::pin(const Entry *entry) {
+    pinned = entry;
+    evict();
+}
+
+auto ScriptCache::contains(const std::filesystem::path &path) const -> bool {
+    return index.contains(path);
+}
+
+auto ScriptCache::peek(const std::filesystem::path &path) const -> const Entry* {
+    const auto found = index.find(path);
+    return found != index.end() ? &*found->second : nullptr;
+}
+
+auto ScriptCache::get_stats() const -> Stats {
+    auto ret = stats;
+    ret.resident_bytes = resident;
+    ret.entries = lru.size();
+    return ret;
+}
+
+auto ScriptCache::get_budget() const -> std::size_t {
+    return budget;
+}
@@ -0,0 +1,108 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_SCRIPTCACHE_HPP
+#define RPY_PROJ_ANALYZER_SCRIPTCACHE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "DisplayCache.hpp"
+#include "EdgeRenderer.hpp"
+#include "GraphLayout.hpp"
+#include "ScriptLoader.hpp"
+
+/**
+ * @brief LRU cache of parsed + laid out scripts, bounded by a memory budget.
+ *
+ * Entries are keyed by path and validated against the file's mtime / size,
+ * falling back to a content hash when those changed, so re-opening a script
+ * that hasn't been edited reuses its Graph, GraphLayout and LayoutData.
+ */
+class ScriptCache {
+public:
+    struct Entry {
+        std::filesystem::path path;
+        FileStamp stamp;
+        std::unique_ptr<RenpyFile> file;
+        LayoutData data;
+        DisplayCache displays;
+        EdgeRenderer edges;
+        std::size_t base_bytes = 0; // everything but the DisplayNodes
+        std::size_t bytes = 0;      // base_bytes and the DisplayNodes as of the last update_displays
+    };
+
+    struct Stats {
+        unsigned hits = 0;
+        unsigned misses = 0;
+        unsigned evictions = 0;
+        std::size_t resident_bytes = 0;
+        std::size_t entries = 0;
+    };
+
+private:
+    std::list<Entry> lru; // most recently used at the front
+    std::unordered_map<std::filesystem::path, std::list<Entry>::iterator> index;
+    std::size_t budget;
+    std::size_t resident = 0;
+    Stats stats;
+
+    const Entry *pinned = nullptr;
+
+    static auto estimate_bytes(const Entry &entry) -> std::size_t;
+
+    /**
+     * @brief drops least recently used entries until within budget, but never the pinned one or `keep`.
+     */
+    void evict(const Entry *keep = nullptr);
+
+public:
+    static constexpr std::size_t default_budget = 256ull * 1024 * 1024;
+
+    explicit ScriptCache(std::size_t budget_bytes = default_budget);
+
+    /**
+     * @brief returns the cached script if it is still up to date with the file on disk.
+     *
+     * Stale entries are dropped. Counts as a hit or a miss.
+     */
+    auto find(const std::filesystem::path &path) -> Entry*;
+
+    /**
+     * @brief adds a freshly loaded script, evicting least recently used ones if over budget.
+     *
+     * The new entry itself is never evicted here, even if it's over budget on its own.
+     */
+    auto insert(ScriptLoader::Result result) -> Entry*;
+
+    /**
+     * @brief re-accounts `entry` after its DisplayCache built or dropped nodes.
+     *
+     * Evicts other entries if that put the cache over budget. Cheap enough to call every frame.
+     */
+    void update_displays(Entry &entry);
+
+    /**
+     * @brief keeps `entry` (the one currently on screen) from being evicted.
+     */
+    void pin(const Entry *entry);
+
+    /**
+     * @brief whether `path` has an entry, fresh or not. Doesn't count as a hit or a miss.
+     */
+    [[nodiscard]] auto contains(const std::filesystem::path &path) const -> bool;
+
+    /**
+     * @brief the entry for `path`, fresh or not. Doesn't count as a hit or a miss, or move it up.
+     */
+    [[nodiscard]] auto peek(const std::filesystem::path &path) const -> const Entry*;
+
+    [[nodiscard]] auto get_stats() const -> Stats;
+    [[nodiscard]] auto get_budget() const -> std::size_t;
+};
+
+#endif //RPY_PROJ_ANALYZER_SCRIPTCACHE_HPP
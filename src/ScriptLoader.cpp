@@ -0,0 +1,191 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "ScriptLoader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <utility>
+
+#include "ParseCache.hpp"
+#include "Profiler.hpp"
+
+auto FileStamp::of(const std::filesystem::path &path) -> FileStamp {
+    std::error_code ec;
+    FileStamp stamp;
+    stamp.mtime = std::filesystem::last_write_time(path, ec);
+    stamp.size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        stamp.size = 0;
+    }
+    stamp.hash = hash_file(path);
+    return stamp;
+}
+
+auto FileStamp::hash_file(const std::filesystem::path &path) -> std::uint64_t {
+    constexpr std::uint64_t FNV_OFFSET = 0xCBF29CE484222325;
+    constexpr std::uint64_t FNV_PRIME = 0x100000001B3;
+
+    std::uint64_t hash = FNV_OFFSET;
+    std::ifstream file(path, std::ios::binary);
+    std::array<char, 1 << 16> buff{};
+
+    while (file) {
+        file.read(buff.data(), buff.size());
+        const auto n_read = file.gcount();
+        for (std::streamsize i = 0; i < n_read; ++i) {
+            hash ^= static_cast<std::uint8_t>(buff[i]);
+            hash *= FNV_PRIME;
+        }
+    }
+
+    return hash;
+}
+
+void ScriptLoader::run(const std::stop_token stop, const std::shared_ptr<Job> &job) {
+    auto cancelled = [&] -> bool {
+        if (stop.stop_requested()) {
+            job->stage = Stage::Cancelled;
+            return true;
+        }
+        return false;
+    };
+
+    const Profiler::FileScope file_scope(job->path);
+    job->stage = Stage::Parsing;
+    FileStamp stamp;
+    std::unique_ptr<RenpyFile> file;
+    if (auto cached = ParseCache::load(job->path)) {
+        stamp = cached->stamp;
+        file = std::move(cached->file);
+    } else {
+        stamp = FileStamp::of(job->path);
+        Graph graph(job->path);
+        if (cancelled()) {
+            return;
+        }
+
+        job->stage = Stage::Layout;
+        file = std::make_unique<RenpyFile>(std::move(graph));
+
+        if (auto stored = ParseCache::store(job->path, stamp, *file); !stored) {
+            std::println(std::cerr, "not caching {}: {}", job->path.string(), stored.error());
+        }
+    }
+    if (cancelled()) {
+        return;
+    }
+
+    job->stage = Stage::Displayables;
+    auto data = file->layout.make_displayables(file->graph);
+    if (cancelled()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(job->mtx);
+        job->result = Result{.path=job->path, .stamp=stamp, .file=std::move(file), .data=std::move(data)};
+    }
+    job->stage = Stage::Done;
+}
+
+void ScriptLoader::reap_retired() {
+    std::erase_if(retired, [](auto &r) -> bool {
+        const auto stage = r.first->stage.load();
+        if (stage == Stage::Done || stage == Stage::Cancelled) {
+            r.second.join();
+            return true;
+        }
+        return false;
+    });
+}
+
+ScriptLoader::~ScriptLoader() {
+    if (worker.joinable()) {
+        worker.request_stop();
+    }
+    for (auto &[_, thread] : retired) {
+        thread.request_stop();
+    }
+    // the jthreads join themselves from here on out
+}
+
+void ScriptLoader::request(const std::filesystem::path &path) {
+    if (job && job->path == path && busy()) {
+        return;
+    }
+
+    cancel();
+
+    job = std::make_shared<Job>();
+    job->path = path;
+    worker = std::jthread([j = job](const std::stop_token &stop) {
+        run(stop, j);
+    });
+}
+
+void ScriptLoader::cancel() {
+    if (worker.joinable()) {
+        worker.request_stop();
+        retired.emplace_back(std::move(job), std::move(worker));
+    }
+    job.reset();
+}
+
+auto ScriptLoader::poll() -> std::optional<Result> {
+    reap_retired();
+
+    if (!job || job->stage != Stage::Done) {
+        return std::nullopt;
+    }
+
+    worker.join();
+    std::optional<Result> result;
+    {
+        std::lock_guard lock(job->mtx);
+        result = std::move(job->result);
+    }
+    job.reset();
+    return result;
+}
+
+auto ScriptLoader::busy() const -> bool {
+    const auto s = stage();
+    return s != Stage::Idle && s != Stage::Done && s != Stage::Cancelled;
+}
+
+auto ScriptLoader::stage() const -> Stage {
+    if (!job) {
+        return Stage::Idle;
+    }
+    return job->stage.load();
+}
+
+auto ScriptLoader::pending_path() const -> std::optional<std::filesystem::path> {
+    if (!job) {
+        return std::nullopt;
+    }
+    return job->path;
+}
+
+auto ScriptLoader::stage_str(const Stage stage) -> std::string_view {
+    switch (stage) {
+        using enum Stage;
+        case Idle:
+            return "idle";
+        case Parsing:
+            return "parsing";
+        case Layout:
+            return "laying out";
+        case Displayables:
+            return "building nodes";
+        case Done:
+            return "done";
+        case Cancelled:
+            return "cancelled";
+        default:
+            std::unreachable();
+    }
+}
@@ -0,0 +1,125 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_SCRIPTLOADER_HPP
+#define RPY_PROJ_ANALYZER_SCRIPTLOADER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Graph.hpp"
+#include "GraphLayout.hpp"
+
+/**
+ * @brief identifies one version of a script on disk.
+ */
+struct FileStamp {
+    std::filesystem::file_time_type mtime{};
+    std::uintmax_t size = 0;
+    std::uint64_t hash = 0;
+
+    /**
+     * @brief stats the file and hashes its contents.
+     */
+    static auto of(const std::filesystem::path &path) -> FileStamp;
+
+    /**
+     * @brief FNV-1a over the file's bytes.
+     */
+    static auto hash_file(const std::filesystem::path &path) -> std::uint64_t;
+};
+
+struct RenpyFile {
+    Graph graph;
+    GraphLayout layout;
+
+    explicit RenpyFile(const std::filesystem::path &path)
+        : graph(path), layout(graph) {
+    }
+
+    explicit RenpyFile(Graph &&parsed)
+        : graph(std::move(parsed)), layout(graph) {
+    }
+
+    RenpyFile(Graph &&parsed, const std::span<const LayoutSnapshot> snapshot, const bool fresh_nodes = false)
+        : graph(std::move(parsed)), layout(graph, snapshot, fresh_nodes) {
+    }
+};
+
+/**
+ * @brief Parses and lays out scripts on a worker thread.
+ *
+ * Only the most recent request is ever delivered. Requesting a new script
+ * asks the previous worker to stop; it bails out at the next phase boundary
+ * and its result is thrown away.
+ */
+class ScriptLoader {
+public:
+    enum class Stage : std::uint8_t {
+        Idle,
+        Parsing,
+        Layout,
+        Displayables,
+        Done,
+        Cancelled,
+    };
+
+    struct Result {
+        std::filesystem::path path;
+        FileStamp stamp;
+        std::unique_ptr<RenpyFile> file;
+        LayoutData data;
+    };
+
+private:
+    struct Job {
+        std::filesystem::path path;
+        std::atomic<Stage> stage{Stage::Parsing};
+        std::mutex mtx;
+        std::optional<Result> result;
+    };
+
+    std::shared_ptr<Job> job;
+    std::jthread worker;
+    std::vector<std::pair<std::shared_ptr<Job>, std::jthread>> retired;
+
+    static void run(std::stop_token stop, const std::shared_ptr<Job> &job);
+    void reap_retired();
+
+public:
+    ScriptLoader() = default;
+    ScriptLoader(const ScriptLoader&) = delete;
+    auto operator=(const ScriptLoader&) -> ScriptLoader& = delete;
+    ~ScriptLoader();
+
+    void request(const std::filesystem::path &path);
+
+    /**
+     * @brief drops the pending request, if any. Its result will never be delivered.
+     */
+    void cancel();
+
+    /**
+     * @brief hands over the finished script, if there is one.
+     *
+     * Meant to be called once per frame, so the swap always happens between frames.
+     */
+    auto poll() -> std::optional<Result>;
+
+    [[nodiscard]] auto busy() const -> bool;
+    [[nodiscard]] auto stage() const -> Stage;
+    [[nodiscard]] auto pending_path() const -> std::optional<std::filesystem::path>;
+
+    static auto stage_str(Stage stage) -> std::string_view;
+};
+
+#endif //RPY_PROJ_ANALYZER_SCRIPTLOADER_HPP
@@ -11,7 +11,12 @@
 #include <iostream>
 #include <print>
 #include <ranges>
+#include <span>
 #include <string>
+#include <vector>
+
+#include "AllocCounter.hpp"
+#include "Profiler.hpp"
 
 auto TextHelper::color_from_hex(const std::string_view hex_str, const std::uint8_t alpha_mod) -> std::optional<raylib::Color> {
     switch (hex_str.length()) {
@@ -71,20 +76,8 @@ auto TextHelper::color_from_hex(const std::string_view hex_str, const std::uint8
     return ret_col;
 }
 
-auto TextHelper::adv_glyph(DispGlyph& glyph) -> void {
-    const auto *font = font_ptr(glyph.style.font);
-
-    const float scale = font_size / static_cast<float>(font->baseSize);
-    const auto glyph_idx = GetGlyphIndex(*font, glyph.codepoint);
-
-    float adv = 0.0f;
-    if (font->glyphs[glyph_idx].advanceX == 0) {
-        adv = font->recs[glyph_idx].width * scale;
-    } else {
-        adv = static_cast<float>(font->glyphs[glyph_idx].advanceX) * scale;
-    }
-
-    glyph.advance = adv;
+auto TextHelper::glyph_advance(const int codepoint, const std::uint8_t font_idx) -> float {
+    return atlas->advance(codepoint, font_idx) * (font_size / static_cast<float>(GlyphAtlas::base_size));
 }
 
 auto TextHelper::consume_tag(const std::string_view str, const std::size_t idx, Style& style) -> int {
@@ -138,261 +131,266 @@ auto TextHelper::codepoint(const std::string_view str, const std::size_t idx) ->
     return {codepoint, bytes};
 }
 
-auto TextHelper::apply_formatting(const std::string_view input) -> std::vector<DispGlyph> {
+auto TextHelper::into_disp_text(const std::string_view input) -> DispText {
+    const Profiler::Scope scope("text_shaping");
+    DispText out{.glyphs={}, .items={}, .styles={}, .width=0.0f};
+    // enough for plain ASCII, so a node's text takes a handful of allocations
+    out.glyphs.reserve(input.size());
+    out.items.reserve((input.size() / 4) + 1);
+    out.styles.reserve(1);
+
     Style style{};
-    std::vector<DispGlyph> styled_chars;
-    int idx = 0;
+
+    auto add_whitespace = [&](const ItemKind kind, const float advance) {
+        const auto at = static_cast<std::uint32_t>(out.glyphs.size());
+        out.items.push_back({.begin=at, .end=at, .kind=kind});
+        out.width += advance;
+    };
+
+    auto add_glyph = [&](const int point) {
+        const auto at = static_cast<std::uint32_t>(out.glyphs.size());
+        if (out.styles.empty() || !(out.styles.back().style == style)) {
+            out.styles.push_back({.first=at, .style=style});
+        }
+        if (out.items.empty() || out.items.back().kind != ItemKind::Word) {
+            out.items.push_back({.begin=at, .end=at, .kind=ItemKind::Word});
+        }
+        const auto advance = glyph_advance(point, style.font);
+        out.glyphs.push_back({.codepoint=point, .advance=advance});
+        ++out.items.back().end;
+        out.width += advance;
+    };
+
+    std::size_t idx = 0;
     while (idx < input.length()) {
         if (input.at(idx) == '{') {
             if (const int consumed = consume_tag(input, idx, style); consumed > 0) {
                 idx += consumed;
             } else {
-                styled_chars.emplace_back('{', style);
+                add_glyph('{');
                 idx += 1;
             }
-        } else {
-            auto [point, bytes] = codepoint(input, idx);
-            styled_chars.emplace_back(point, style);
-            idx += bytes;
+            continue;
         }
-    }
-    style.reset();
-    return styled_chars;
-}
 
-auto TextHelper::into_disp_text(const std::string_view input) -> DispText {
-    auto formatted = apply_formatting(input);
-    std::vector<Displayable> disp_buff;
-    float width = 0.0f;
-
-    int idx = 0;
-    while (idx < formatted.size()) {
-        if (const auto& [codepoint, style, adv] = formatted.at(idx); is_space(codepoint)) {
-            switch (codepoint) {
-                case ' ':
-                    disp_buff.emplace_back(WSpaceType::Space);
-                    width += space_glyph->advance;
-                    break;
-                case '\t':
-                    disp_buff.emplace_back(WSpaceType::Tab);
-                    width += space_glyph->advance * 4;
-                    break;
-                case '\n':
-                    disp_buff.emplace_back(WSpaceType::Newline);
-                    break;
-                default:
-                    std::unreachable();
-            }
-            idx++;
-        } else {
-            std::vector<DispGlyph> dc_word;
-            float word_width = 0.0f;
-            while (idx < formatted.size() && !is_space(formatted.at(idx).codepoint)) {
-                adv_glyph(formatted.at(idx));
-                dc_word.push_back(formatted.at(idx));
-                word_width += dc_word.back().advance;
-                idx++;
-            }
-            width += word_width;
-            disp_buff.emplace_back(std::move(dc_word));
+        const auto [point, bytes] = codepoint(input, idx);
+        idx += bytes;
+        switch (point) {
+            case ' ':
+                add_whitespace(ItemKind::Space, space_glyph->advance);
+                break;
+            case '\t':
+                add_whitespace(ItemKind::Tab, space_glyph->advance * 4);
+                break;
+            case '\n':
+                add_whitespace(ItemKind::Newline, 0.0f);
+                break;
+            default:
+                add_glyph(point);
         }
     }
 
-    return {.text=disp_buff, .width=width};
+    return out;
 }
 
-auto TextHelper::dgs_to_wstring(const std::vector<DispGlyph> &dgs) -> std::wstring {
-    std::wstring as_chars;
-
-    int idx = 0;
-    while (idx < dgs.size()) {
-        if (const auto& [codepoint, style, adv] = dgs.at(idx); is_space(codepoint)) {
-            switch (codepoint) {
-                case ' ':
-                case '\t':
-                case '\n':
-                    as_chars.push_back(static_cast<wchar_t>(codepoint));
-                    break;
-                default:
-                    std::unreachable();
-            }
-            idx++;
-        } else {
-            while (idx < dgs.size() && !is_space(codepoint)) {
-                as_chars.push_back(static_cast<wchar_t>(codepoint));
-                idx++;
-            }
-        }
+auto TextHelper::resident_bytes(const DispText &text) -> std::size_t {
+    std::size_t bytes = (text.glyphs.capacity() * sizeof(DispGlyph))
+        + (text.items.capacity() * sizeof(Item))
+        + (text.styles.capacity() * sizeof(StyleRun));
+    bytes += text.layouts.capacity() * sizeof(Layout);
+    for (const auto &lay : text.layouts) {
+        bytes += (lay.breaks.capacity() * sizeof(Layout::Break)) + (lay.line_widths.capacity() * sizeof(float));
     }
-
-    return as_chars;
+    return bytes;
 }
 
-auto TextHelper::split_displayable(const std::vector<DispGlyph> &disp, const float max_width) -> std::vector<std::span<const DispGlyph>> {
-    float curr_width = 0.0f;
-    int left = 0;
-    const std::span all(disp);
-    std::vector<std::span<const DispGlyph>> dgs;
-
-    for (int i = 0; i < disp.size(); ++i) {
-        const auto &dg = disp.at(i);
-        if (curr_width + dg.advance >= max_width) {
-            dgs.emplace_back(all.subspan(left, i - left));
-            curr_width = 0.0f;
-            left = i;
-        }
-
-        curr_width += dg.advance;
-    }
-
-    if (left < disp.size()) {
-        dgs.emplace_back(all.subspan(left));
+void TextHelper::load_fonts() {
+    ++font_gen;
+    atlas = std::make_unique<GlyphAtlas>(std::array<std::filesystem::path, 4>{
+        "./fonts/LiberationMono-Regular.ttf",
+        "./fonts/LiberationMono-Bold.ttf",
+        "./fonts/LiberationMono-Italic.ttf",
+        "./fonts/LiberationMono-BoldItalic.ttf",
+    }, "./fonts/fallback");
+    if (!atlas->loaded()) {
+        std::println(std::cerr, "Could not load every font in ./fonts, missing styles fall back to the regular font or raylib's default.");
     }
 
-    return dgs;
+    space_glyph = std::make_unique<DispGlyph>(DispGlyph{.codepoint=' ', .advance=glyph_advance(' ', 0)});
+    cont_text = std::make_unique<DispText>(into_disp_text("(...)"));
 }
 
-auto TextHelper::chop_displayable(const std::vector<DispGlyph>& disp, float max_width, float cursor_x = 0.0f) -> std::span<const DispGlyph> {
-    float curr_width = 0.0f;
-    int count = 0;
-    const std::span all(disp);
+void TextHelper::unload_fonts() {
+    atlas.reset();
+    ++font_gen;
+}
 
-    for (int i = 0; i < disp.size(); ++i) {
-        const auto &dg = disp.at(i);
-        curr_width += dg.advance;
-        if (curr_width + cursor_x >= max_width) {
-            count = i;
-            break;
+template<typename Glyph, typename Break>
+void TextHelper::walk_layout(const DispText &text, const Layout &lay, const std::size_t first_line,
+                             Glyph &&glyph, Break &&line_break) {
+    const auto start = first_line == 0 ? Layout::Break{.item=0, .glyph=0} : lay.breaks.at(first_line - 1);
+    std::size_t next = first_line;
+    bool skip_spaces = first_line > 0; // right after a break, until the line has a word
+    bool stop = false;
+
+    const Style plain{};
+    std::size_t run = 0;
+    // glyphs are visited in order, so the current style run only ever moves forward
+    auto style_of = [&](const std::uint32_t g) -> const Style& {
+        while (run + 1 < text.styles.size() && text.styles[run + 1].first <= g) {
+            ++run;
         }
+        return text.styles[run].style;
+    };
 
-    }
-
-    return all.subspan(0, count);
-}
-
-void TextHelper::load_fonts() {
-    try {
-        constexpr int FONT_SIZE = 64;
-        constexpr int CHAR_COUNT = 250;
-        fonts.at(0) =
-            std::make_unique<raylib::Font>("./fonts/LiberationMono-Regular.ttf", FONT_SIZE, nullptr, CHAR_COUNT);
-        fonts.at(BOLD) =
-            std::make_unique<raylib::Font>("./fonts/LiberationMono-Bold.ttf", FONT_SIZE, nullptr, CHAR_COUNT);
-        fonts.at(ITALIC) =
-            std::make_unique<raylib::Font>("./fonts/LiberationMono-Italic.ttf", FONT_SIZE, nullptr, CHAR_COUNT);
-        fonts.at(BOLD | ITALIC) =
-            std::make_unique<raylib::Font>("./fonts/LiberationMono-BoldItalic.ttf", FONT_SIZE, nullptr, CHAR_COUNT);
-
-        for (const auto& font : fonts) {
-            SetTextureFilter(font->texture, TEXTURE_FILTER_BILINEAR);
+    auto check_break = [&](const std::uint32_t item, const std::uint32_t g) {
+        if (next < lay.breaks.size() && lay.breaks[next].item == item && lay.breaks[next].glyph == g) {
+            line_break();
+            skip_spaces = true;
+            ++next;
         }
+    };
 
-    } catch (raylib::RaylibException &e) {
-        std::println(std::cerr, "Could not load fonts. {}", e.what());
-        fonts.at(0) = std::make_unique<raylib::Font>(GetFontDefault());
-        fonts.at(BOLD) = std::make_unique<raylib::Font>(GetFontDefault());
-        fonts.at(ITALIC) = std::make_unique<raylib::Font>(GetFontDefault());
-        fonts.at(BOLD | ITALIC) = std::make_unique<raylib::Font>(GetFontDefault());
-        font_spacing = 6.0f;
+    for (auto i = start.item; i < text.items.size() && !stop; ++i) {
+        const auto &item = text.items[i];
+        switch (item.kind) {
+            case ItemKind::Word:
+                for (auto g = i == start.item ? start.glyph : item.begin; g < item.end && !stop; ++g) {
+                    check_break(i, g);
+                    stop = !glyph(text.glyphs[g], style_of(g));
+                }
+                skip_spaces = false;
+                break;
+            case ItemKind::Space:
+                check_break(i, item.begin);
+                if (!skip_spaces) {
+                    stop = !glyph(*space_glyph, plain);
+                }
+                break;
+            case ItemKind::Tab:
+                check_break(i, item.begin);
+                for (int k = 0; k < 4 && !stop; ++k) {
+                    stop = !glyph(*space_glyph, plain);
+                }
+                break;
+            case ItemKind::Newline:
+                check_break(i, item.begin);
+                break; // the next line starts at the break after it
+        }
     }
 
-    DispGlyph glyph(codepoint(" ", 0).first, Style{});
-    adv_glyph(glyph);
-    space_glyph = std::make_unique<DispGlyph>(glyph);
-    cont_text = std::make_unique<DispText>(into_disp_text("(...)"));
-}
-
-void TextHelper::unload_fonts() {
-    for (auto& font : fonts) {
-        font.reset();
+    // trailing newlines
+    for (; next < lay.breaks.size() && !stop; ++next) {
+        line_break();
     }
 }
 
-auto TextHelper::draw_text(const std::string_view text, raylib::Vector2 pos, int width, int rel_line) -> int {
-    return draw_text(into_disp_text(text), pos, width, rel_line);
-}
+auto TextHelper::compute_layout(const DispText &text, const float max_width) -> Layout {
+    Layout lay{.max_width=max_width, .font_gen=font_gen};
+    const bool wrap = max_width > 0.0f;
 
-auto TextHelper::draw_text(const DispText &text, const raylib::Vector2 pos, const int width, const int rel_line) -> int {
-    const auto &[ds, _] = text;
-
-    constexpr float line_height = font_size;
-    float cursor_x = pos.x;
-    float cursor_y = pos.y + (rel_line * line_height);
-    bool just_wrapped = false;
-    int newlines = 0;
-
-    auto draw_glyph = [&](const DispGlyph& glyph) {
-        DrawTextCodepoint(
-            *font_ptr(glyph.style.font),
-            glyph.codepoint,
-            {cursor_x, cursor_y},
-            font_size,
-            glyph.style.fg
-        );
-        cursor_x += glyph.advance;
-    };
+    float cursor_x = 0.0f;
+    bool skip_spaces = false;
 
-    auto reset_cursor = [&] {
-        cursor_x = pos.x;
-        cursor_y += line_height;
-        just_wrapped = true;
-        newlines += 1;
+    auto line_break = [&](const std::uint32_t item, const std::uint32_t glyph) {
+        lay.breaks.push_back({.item=item, .glyph=glyph});
+        lay.line_widths.push_back(cursor_x);
+        cursor_x = 0.0f;
+        skip_spaces = true;
     };
 
-    for (const auto& word : ds) {
-        std::visit(Overload {
-            [&](const std::vector<DispGlyph>& dgs) {
+    for (std::uint32_t i = 0; i < text.items.size(); ++i) {
+        const auto &item = text.items[i];
+        switch (item.kind) {
+            case ItemKind::Word: {
+                const std::span word(text.glyphs.begin() + item.begin, text.glyphs.begin() + item.end);
                 const auto word_width = std::ranges::fold_left(
-                    dgs, 0.0f,
+                    word, 0.0f,
                     [](const float w, const DispGlyph& dg) {
                         return w + dg.advance;
                     });
-                if (word_width > pos.x + width && width > 0) {
-                    // if whole word is longer than box, wrap it
-                    auto split = split_displayable(dgs, width);
-                    for (const auto &split_dgs : split) {
-                        for (const auto &dg : split_dgs) {
-                            draw_glyph(dg);
+                if (wrap && word_width > max_width) {
+                    // whole word is longer than a line, break it wherever the next glyph doesn't fit
+                    for (auto g = item.begin; g < item.end; ++g) {
+                        if (cursor_x > 0.0f && cursor_x + text.glyphs[g].advance > max_width) {
+                            line_break(i, g);
                         }
-                        reset_cursor();
-                        just_wrapped = true;
-                    }
-                } else if (word_width + cursor_x > pos.x + width && width > 0) {
-                    // if word goes beyond box, push to next line
-                    reset_cursor();
-                    for (const auto &dg : dgs) {
-                        draw_glyph(dg);
+                        cursor_x += text.glyphs[g].advance;
                     }
                 } else {
-                    // otherwise, draw normally
-                    for (const auto &dg : dgs) {
-                        draw_glyph(dg);
+                    if (wrap && cursor_x > 0.0f && cursor_x + word_width > max_width) {
+                        // word goes beyond the line, push it to the next one
+                        line_break(i, item.begin);
                     }
+                    cursor_x += word_width;
                 }
-
-                just_wrapped = false;
-            },
-            [&](const WSpaceType& ws) {
-                switch (ws) {
-                    case WSpaceType::Space:
-                        if (!just_wrapped) {
-                            draw_glyph(*space_glyph);
-                        }
-                        break;
-                    case WSpaceType::Tab:
-                        for (int i = 0; i < 4; ++i) {
-                            draw_glyph(*space_glyph);
-                        }
-                        break;
-                    case WSpaceType::Newline:
-                        reset_cursor();
-                        break;
-                }
+                skip_spaces = false;
+                break;
             }
-        }, word);
+            case ItemKind::Space:
+                if (!skip_spaces) {
+                    cursor_x += space_glyph->advance;
+                }
+                break;
+            case ItemKind::Tab:
+                cursor_x += space_glyph->advance * 4;
+                break;
+            case ItemKind::Newline:
+                // the next item starts where the newline is, words and whitespace alike
+                line_break(i + 1, item.begin);
+                break;
+        }
     }
 
-    return newlines + 1;
+    lay.line_widths.push_back(cursor_x);
+    lay.width = std::ranges::max(lay.line_widths);
+    return lay;
+}
+
+auto TextHelper::layout(const DispText &text, const float max_width) -> const Layout& {
+    auto &cache = text.layouts;
+    for (const auto &lay : cache) {
+        if (lay.max_width == max_width && lay.font_gen == font_gen) {
+            return lay;
+        }
+    }
+
+    const NoAllocGuard::Allow allow; // once per text and width
+    std::erase_if(cache, [](const Layout &lay) { return lay.font_gen != font_gen; });
+    if (cache.size() >= max_cached_layouts) {
+        cache.erase(cache.begin());
+    }
+    cache.push_back(compute_layout(text, max_width));
+    return cache.back();
+}
+
+void TextHelper::flush_text() {
+    if (atlas) {
+        atlas->flush();
+    }
+}
+
+auto TextHelper::draw_text(const std::string_view text, raylib::Vector2 pos, int width, int rel_line) -> int {
+    return draw_text(into_disp_text(text), pos, width, rel_line);
+}
+
+auto TextHelper::draw_text(const DispText &text, const raylib::Vector2 pos, const int width, const int rel_line) -> int {
+    constexpr float line_height = font_size;
+    const auto &lay = layout(text, static_cast<float>(width));
+    raylib::Vector2 cursor{pos.x, pos.y + (rel_line * line_height)};
+
+    walk_layout(text, lay, 0,
+        [&](const DispGlyph& glyph, const Style& style) {
+            atlas->queue(glyph.codepoint, style.font, cursor, font_size, style.fg);
+            cursor.x += glyph.advance;
+            return true;
+        },
+        [&] {
+            cursor.x = pos.x;
+            cursor.y += line_height;
+        });
+
+    return lay.n_lines();
 }
 
 auto TextHelper::draw_text_constrained(const std::string_view text, const raylib::Rectangle bounds, const int rel_line) -> std::pair<int, bool> {
@@ -401,155 +399,73 @@ auto TextHelper::draw_text_constrained(const std::string_view text, const raylib
 
 auto TextHelper::draw_text_constrained(const DispText &text, const raylib::Rectangle bounds, const int rel_line)
     -> std::pair<int, bool> {
-    const auto &[ds, _] = text;
-    const auto &[cont_d, cont_width] = *cont_text;
-
-    bool last_line = false;
-
     constexpr float line_height = font_size;
-    float cursor_x = bounds.x;
-    float cursor_y = bounds.y + (rel_line * line_height);
-    bool just_wrapped = false;
-    float newlines = 0;
+    const float top = bounds.y + (rel_line * line_height);
+    const float bottom = bounds.y + bounds.height;
 
-    if (line_height + cursor_y > bounds.y + bounds.height) {
+    if (line_height + top > bottom) {
         return {0, false};
     }
 
-    auto draw_glyph = [&](const DispGlyph& glyph) {
-        DrawTextCodepoint(
-            *font_ptr(glyph.style.font),
-            glyph.codepoint,
-            {cursor_x, cursor_y},
-            font_size,
-            glyph.style.fg
-        );
-        cursor_x += glyph.advance;
-    };
+    const auto &lay = layout(text, bounds.width);
+    const auto n_fit = static_cast<int>((bottom - top) / line_height);
+    raylib::Vector2 cursor{bounds.x, top};
 
-    auto can_advance = [&] {
-        return cursor_y + line_height * 2 <= bounds.y + bounds.height;
+    auto draw_glyph = [&](const DispGlyph& glyph, const Style& style) {
+        atlas->queue(glyph.codepoint, style.font, cursor, font_size, style.fg);
+        cursor.x += glyph.advance;
     };
-
     auto reset_cursor = [&] {
-        cursor_x = bounds.x;
-        cursor_y += line_height;
-        just_wrapped = true;
-        newlines += 1;
-        if (!can_advance()) {
-            last_line = true;
-        }
+        cursor.x = bounds.x;
+        cursor.y += line_height;
     };
 
-    bool chop = false;
-    const auto max = bounds.x + bounds.width - cont_width;
-
-    std::optional<int> continue_idx = std::nullopt;
-
-    for (int i = 0; i < ds.size(); ++i) {
-        if (!last_line) {
-            std::visit(Overload {
-                [&](const std::vector<DispGlyph>& dgs) {
-                    const auto word_width = std::ranges::fold_left(
-                        dgs, 0.0f,
-                        [](const float w, const DispGlyph& dg) {
-                            return w + dg.advance;
-                        });
-                    if (word_width > bounds.width) {
-                        // if whole word is longer than box, wrap it
-                        auto split = split_displayable(dgs, bounds.width);
-                        for (const auto &split_dgs : split) {
-                            for (const auto &dg : split_dgs) {
-                                draw_glyph(dg);
-                            }
-                            reset_cursor();
-                            just_wrapped = true;
-                        }
-                    } else if (word_width + cursor_x >= bounds.x + bounds.width) {
-                        // if word goes beyond box, push to next line
-                        reset_cursor();
-                        if (!last_line) {
-                            for (const auto &dg : dgs) {
-                                draw_glyph(dg);
-                            }
-                        }
-                    } else {
-                        // otherwise, draw normally
-                        for (const auto &dg : dgs) {
-                            draw_glyph(dg);
-                        }
-                    }
-
-                    just_wrapped = false;
-                },
-                [&](const WSpaceType& ws) {
-                    switch (ws) {
-                        case WSpaceType::Space:
-                            if (!just_wrapped) {
-                                draw_glyph(*space_glyph);
-                            }
-                            break;
-                        case WSpaceType::Tab:
-                            for (int i = 0; i < 4; ++i) {
-                                draw_glyph(*space_glyph);
-                            }
-                            break;
-                        case WSpaceType::Newline:
-                            reset_cursor();
-                            break;
-                    }
-                }
-            }, ds.at(i));
-        }
-        if (last_line) {
-            continue_idx = i;
-            break;
-        }
+    if (lay.n_lines() <= n_fit) {
+        walk_layout(text, lay, 0, [&](const DispGlyph& glyph, const Style& style) { draw_glyph(glyph, style); return true; }, reset_cursor);
+        return {lay.n_lines(), false};
     }
 
-    if (continue_idx) {
-        std::vector<DispGlyph> dgs;
-        for (int j = *continue_idx; j < ds.size(); ++j) {
-            std::visit(Overload {
-                [&](const std::vector<DispGlyph>& new_dgs) {
-                    dgs.insert(dgs.end(), new_dgs.begin(), new_dgs.end());
-                },
-                [&](const WSpaceType& ws) {
-                    switch (ws) {
-                        case WSpaceType::Space:
-                            dgs.push_back(*space_glyph);
-                            break;
-                        case WSpaceType::Tab:
-                            for (int k = 0; k < 4; ++k) {
-                                dgs.push_back(*space_glyph);
-                            }
-                            break;
-                        case WSpaceType::Newline:
-                            break;
-                    }
-                },
-            }, ds.at(j));
-        }
-        int last_codepoint = 0;
-        for (const auto &dg : dgs) {
-            if (cursor_x + dg.advance <= max) {
-                draw_glyph(dg);
-                last_codepoint = dg.codepoint;
-            } else {
+    // every line but the last one that fits as laid out...
+    const int last_line = n_fit - 1;
+    int line = 0;
+    walk_layout(text, lay, 0,
+        [&](const DispGlyph& glyph, const Style& style) {
+            if (line >= last_line) {
+                return false;
+            }
+            draw_glyph(glyph, style);
+            return true;
+        },
+        [&] {
+            ++line;
+            reset_cursor();
+        });
+
+    // ...then the rest on that last line, newlines dropped, until it runs into the "(...)"
+    cursor = {bounds.x, top + (static_cast<float>(last_line) * line_height)};
+    const auto max = bounds.x + bounds.width - cont_text->width;
+    bool chop = false;
+    int last_codepoint = 0;
+    walk_layout(text, lay, static_cast<std::size_t>(last_line),
+        [&](const DispGlyph& glyph, const Style& style) {
+            if (cursor.x + glyph.advance > max) {
                 if (is_space(last_codepoint)) {
-                    cursor_x -= space_glyph->advance;
+                    cursor.x -= space_glyph->advance;
                 }
                 chop = true;
-                break;
+                return false;
             }
-        }
-
-        if (chop) {
-            draw_text(*cont_text, {cursor_x, cursor_y}, bounds.width);
-        }
+            draw_glyph(glyph, style);
+            last_codepoint = glyph.codepoint;
+            return true;
+        },
+        [] {});
+
+    if (chop) {
+        draw_text(*cont_text, cursor, static_cast<int>(bounds.width));
     }
 
-    return {newlines + 1, chop};
+    return {n_fit, chop};
 }
 
 auto TextHelper::text_width(const std::string_view text) -> float {
@@ -557,122 +473,13 @@ auto TextHelper::text_width(const std::string_view text) -> float {
 }
 
 auto TextHelper::text_width(const DispText &text) -> float {
-    const auto &[ds, _] = text;
-    float cursor_x = 0.0f;
-    float cursor_y = 0.0f;
-    const float line_height = font_size;
-    bool just_wrapped = false;
-
-    float width = 0.0f;
-    float highest_width = 0.0f;
-
-    auto dummy_draw = [&](const DispGlyph& glyph) {
-        cursor_x += glyph.advance;
-        width += glyph.advance;
-    };
-
-    auto reset_cursor = [&] {
-        cursor_x = 0.0f;
-        cursor_y += line_height;
-        just_wrapped = true;
-        highest_width = std::max(width, highest_width);
-        width = 0.0f;
-    };
-
-    for (const auto& word : ds) {
-        std::visit(Overload {
-            [&](const std::vector<DispGlyph>& dgs) {
-                for (const auto &dg : dgs) {
-                    dummy_draw(dg);
-                }
-                just_wrapped = false;
-            },
-            [&](const WSpaceType& ws) {
-                switch (ws) {
-                    case WSpaceType::Space:
-                        if (!just_wrapped) {
-                            dummy_draw(*space_glyph);
-                        }
-                        break;
-                    case WSpaceType::Tab:
-                        for (int i = 0; i < 4; ++i) {
-                            dummy_draw(*space_glyph);
-                        }
-                        break;
-                    case WSpaceType::Newline:
-                        reset_cursor();
-                        break;
-                }
-            },
-        }, word);
-    }
-
-    return width;
+    return layout(text, 0.0f).width;
 }
 
-auto TextHelper::text_height(const std::string_view text, const int width, const float offset) -> float {
-    return text_height(into_disp_text(text), width, offset);
+auto TextHelper::text_height(const std::string_view text, const int width) -> float {
+    return text_height(into_disp_text(text), width);
 }
 
-auto TextHelper::text_height(const DispText &text, const int width, const float offset) -> float {
-    const auto &[ds, _] = text;
-
-    const auto f_width = static_cast<float>(width);
-    constexpr float line_height = font_size;
-    float cursor_x = 0.0f;
-    float cursor_y = offset;
-    float newlines = 0;
-    bool just_wrapped = false;
-
-    auto dummy_draw = [&](const DispGlyph& glyph) {
-        cursor_x += glyph.advance;
-    };
-
-    auto reset_cursor = [&] {
-        cursor_x = 0.0f;
-        cursor_y += line_height;
-        just_wrapped = true;
-        newlines += 1.0f;
-    };
-
-    for (const auto& word : ds) {
-        std::visit(Overload {
-            [&](const std::vector<DispGlyph>& dgs) {
-                const auto word_width = std::ranges::fold_left(
-                    dgs, 0.0,
-                    [](const float w, const DispGlyph& dg) {
-                        return w + dg.advance;
-                    });
-                if (word_width + cursor_x > f_width) {
-                    reset_cursor();
-                }
-                for (const auto &dg : dgs) {
-                    dummy_draw(dg);
-                }
-                just_wrapped = false;
-            },
-            [&](const WSpaceType& ws) {
-                switch (ws) {
-                    case WSpaceType::Space:
-                        if (!just_wrapped) {
-                            dummy_draw(*space_glyph);
-                        }
-                        break;
-                    case WSpaceType::Tab:
-                        for (int i = 0; i < 4; ++i) {
-                            dummy_draw(*space_glyph);
-                        }
-                        break;
-                    case WSpaceType::Newline:
-                        reset_cursor();
-                        break;
-                }
-            },
-        }, word);
-    }
-
-    if (newlines == 0) {
-        newlines = 1;
-    }
-    return (newlines) * line_height;
+auto TextHelper::text_height(const DispText &text, const int width) -> float {
+    return layout(text, static_cast<float>(width)).height();
 }
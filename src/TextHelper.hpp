@@ -7,15 +7,15 @@
 
 #include "raylib-cpp.hpp"
 
-#include <array>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <print>
-#include <span>
 #include <string_view>
 #include <utility>
-#include <variant>
+#include <vector>
+
+#include "GlyphAtlas.hpp"
 
 class TextHelper {
 public:
@@ -29,71 +29,95 @@ public:
             fg = *default_color;
             font = 0;
         }
+
+        [[nodiscard]] auto operator==(const Style &other) const -> bool {
+            return ColorToInt(fg) == ColorToInt(other.fg) && font == other.font;
+        }
     };
 
     struct DispGlyph {
         int codepoint = 0;
-        Style style{};
         float advance = 0.0f;
-
-        DispGlyph(const int codepoint, const Style style) {
-            this->codepoint = codepoint;
-            this->style = style;
-            advance = 0.0f;
-        }
-        DispGlyph(const int codepoint, const Style style, const float advance) {
-            this->codepoint = codepoint;
-            this->style = style;
-            this->advance = advance;
-        }
     };
 
-    enum class WSpaceType : std::uint8_t {
+    enum class ItemKind : std::uint8_t {
+        Word,
         Space,
         Tab,
         Newline,
     };
 
-    using Displayable = std::variant<WSpaceType, std::vector<DispGlyph>>;
+    /**
+     * @brief A word, as a range of glyphs, or one whitespace character.
+     */
+    struct Item {
+        std::uint32_t begin; // first glyph of a word, or the glyph that follows the whitespace
+        std::uint32_t end;
+        ItemKind kind;
+    };
 
+    /**
+     * @brief `style` applies from glyph `first` up to the next run.
+     */
+    struct StyleRun {
+        std::uint32_t first;
+        Style style;
+    };
+
+    /**
+     * @brief Where a DispText breaks into lines for one max width.
+     */
+    struct Layout {
+        struct Break {
+            std::uint32_t item;  // index into DispText::items
+            std::uint32_t glyph; // index into DispText::glyphs the line starts at
+        };
+
+        float max_width = 0.0f; // 0 if lines only break at newlines
+        std::uint32_t font_gen = 0;
+        std::vector<Break> breaks; // where each line after the first starts
+        std::vector<float> line_widths;
+        float width = 0.0f; // of the widest line
+
+        [[nodiscard]] auto n_lines() const -> int {
+            return static_cast<int>(breaks.size()) + 1;
+        }
+
+        [[nodiscard]] auto height() const -> float {
+            return static_cast<float>(n_lines()) * font_size;
+        }
+    };
+
+    /**
+     * @brief Shaped text: the glyphs of every word back to back, the words and
+     * whitespace between them, and the styles as runs over the glyphs.
+     */
     struct DispText {
-        std::vector<Displayable> text;
+        std::vector<DispGlyph> glyphs;
+        std::vector<Item> items;
+        std::vector<StyleRun> styles;
         float width;
+        mutable std::vector<Layout> layouts{}; // filled in by TextHelper::layout
     };
 
 private:
     static constexpr std::uint8_t BOLD      = 0b1;
     static constexpr std::uint8_t ITALIC    = 0b10;
 
-    template<class... Ts>
-    struct Overload : Ts... {
-        using Ts::operator()...;
-    };
-
-    template<class... Ts>
-    Overload(Ts...) -> Overload<Ts...>;
-
-    static inline std::array<std::unique_ptr<raylib::Font>, ((BOLD | ITALIC) + 1)> fonts{};
+    static inline std::unique_ptr<GlyphAtlas> atlas;
     static inline std::unique_ptr<DispGlyph> space_glyph;
     static inline std::unique_ptr<DispText> cont_text;
-    static inline bool loaded_fonts = false;
-    static inline float font_spacing = 2.0f;
+    static inline std::uint32_t font_gen = 0; // bumped whenever the fonts change, so old layouts get dropped
+    // a text is only ever laid out at one or two widths
+    static constexpr std::size_t max_cached_layouts = 4;
 
     static auto is_space(const int &i) -> bool {
         return (i == ' ' || i == '\t' || i == '\n');
     };
 
-    static auto font_ptr(const std::uint8_t &font) -> raylib::Font* {
-        raylib::Font* ptr = fonts.at(font).get();
-        if (ptr->texture.id == 0) {
-            *ptr = GetFontDefault();
-        }
-        return ptr;
-    };
-
     static auto color_from_hex(std::string_view hex_str, std::uint8_t alpha_mod = 0xFF) -> std::optional<raylib::Color>;
 
-    static auto adv_glyph(DispGlyph& glyph) -> void;
+    static auto glyph_advance(int codepoint, std::uint8_t font) -> float;
 
     static auto consume_tag(std::string_view str, std::size_t idx, Style& style) -> int;
 
@@ -103,13 +127,15 @@ private:
      */
     static auto codepoint(std::string_view str, std::size_t idx) -> std::pair<int, int>;
 
-    static auto apply_formatting(std::string_view input) -> std::vector<DispGlyph>;
-
-    static auto dgs_to_wstring(const std::vector<DispGlyph> &disp) -> std::wstring;
+    static auto compute_layout(const DispText &text, float max_width) -> Layout;
 
-    static auto split_displayable(const std::vector<DispGlyph> &disp, float max_width) -> std::vector<std::span<const DispGlyph>>;
-
-    static auto chop_displayable(const std::vector<DispGlyph> &disp, float max_width, float cursor_x) -> std::span<const DispGlyph>;
+    /**
+     * @brief calls `glyph(glyph, style)` for every glyph to draw from line `first_line` on, and `line_break` where a new line starts.
+     *
+     * Stops as soon as `glyph` returns false. Defined in TextHelper.cpp, the only place it's used.
+     */
+    template<typename Glyph, typename Break>
+    static void walk_layout(const DispText &text, const Layout &lay, std::size_t first_line, Glyph &&glyph, Break &&line_break);
 
 public:
     static constexpr float font_size = 18.0f;
@@ -117,6 +143,8 @@ public:
     /**
      * @brief Loads fonts needed to render text with custom formatting.
      *
+     * Only the font files are read here, glyphs are rasterized as they are first used.
+     *
      * @warning Must be called after raylib has been initialized, otherwise fonts will not be loaded.
      */
     static void load_fonts();
@@ -124,11 +152,24 @@ public:
 
     static auto into_disp_text(std::string_view input) -> DispText;
 
+    [[nodiscard]] static auto resident_bytes(const DispText &text) -> std::size_t;
+
+    /**
+     * @brief line breaks and line widths of `text` wrapped at `max_width` (0 to only break at newlines).
+     *
+     * Made the first time it is asked for and kept on the text, so drawing and
+     * measuring the same text again doesn't walk its glyphs. The reference is
+     * only good until the next call for the same text.
+     */
+    static auto layout(const DispText &text, float max_width) -> const Layout&;
+
     /*
      * All text drawing functions and the style
      * parsing are adapted from the following:
      * https://www.raylib.com/examples/text/loader.html?name=text_inline_styling
      * https://www.raylib.com/examples/text/loader.html?name=text_rectangle_bounds
+     *
+     * They only queue the glyphs, which show up on the next flush_text.
      */
     static auto draw_text(std::string_view text, raylib::Vector2 pos, int width = 0, int rel_line = 0) -> int;
     static auto draw_text(const DispText &text, raylib::Vector2 pos, int width = 0, int rel_line = 0) -> int;
@@ -138,11 +179,23 @@ public:
     static auto draw_text_constrained(const DispText &text, raylib::Rectangle bounds, int rel_line = 0)
         -> std::pair<int, bool>;
 
+    /**
+     * @return the width of the widest line
+     */
     static auto text_width(std::string_view text) -> float;
     static auto text_width(const DispText &text) -> float;
 
-    static auto text_height(std::string_view text, int width, float offset = 0.0f) -> float;
-    static auto text_height(const DispText &text, int width, float offset = 0.0f) -> float;
+    static auto text_height(std::string_view text, int width) -> float;
+    static auto text_height(const DispText &text, int width) -> float;
+
+    /**
+     * @brief draws all queued text in as few draw calls as the atlas allows.
+     *
+     * Text is drawn with the camera, scissor rectangle and render target active
+     * at the flush, so call this before ending any of them, and before drawing
+     * anything that has to go on top of the text.
+     */
+    static void flush_text();
 };
 
 
@@ -0,0 +1,60 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+#include "ArgVParser.hpp"
+
+void ThreadPool::work(const std::stop_token stop) {
+    while (true) {
+        std::move_only_function<void()> task;
+        {
+            std::unique_lock lock(mtx);
+            // the wait returns true after a stop too, if tasks are still queued
+            cv.wait(lock, stop, [&] -> bool { return !tasks.empty(); });
+            if (stop.stop_requested() || tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+auto ThreadPool::default_threads() -> unsigned {
+    if (ArgVParser::threads && *ArgVParser::threads > 0) {
+        return static_cast<unsigned>(*ArgVParser::threads);
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(const unsigned n_threads) {
+    workers.reserve(n_threads);
+    for (unsigned i = 0; i < std::max(1u, n_threads); ++i) {
+        workers.emplace_back([this](const std::stop_token &stop) {
+            work(stop);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    for (auto &w : workers) {
+        w.request_stop();
+    }
+    // dropped outside the lock, their futures get broken_promise
+    decltype(tasks) dropped;
+    {
+        std::lock_guard lock(mtx);
+        std::swap(tasks, dropped);
+    }
+    cv.notify_all();
+    workers.clear(); // joins, after the tasks that already started
+}
+
+auto ThreadPool::size() const -> std::size_t {
+    return workers.size();
+}
@@ -0,0 +1,57 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+#ifndef RPY_PROJ_ANALYZER_THREADPOOL_HPP
+#define RPY_PROJ_ANALYZER_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads pulling tasks off a shared queue.
+ *
+ * Tasks still queued when the pool is destroyed are dropped, so their
+ * futures report a broken promise.
+ */
+class ThreadPool {
+    std::vector<std::jthread> workers;
+    std::queue<std::move_only_function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable_any cv;
+
+    void work(std::stop_token stop);
+
+public:
+    /**
+     * @brief `--threads` if it was given, otherwise one per hardware thread.
+     */
+    static auto default_threads() -> unsigned;
+
+    explicit ThreadPool(unsigned n_threads = default_threads());
+    ThreadPool(const ThreadPool&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+    ~ThreadPool();
+
+    template<typename F>
+    auto submit(F &&fn) -> std::future<std::invoke_result_t<F>> {
+        std::packaged_task<std::invoke_result_t<F>()> task(std::forward<F>(fn));
+        auto future = task.get_future();
+        {
+            std::lock_guard lock(mtx);
+            tasks.emplace(std::move(task));
+        }
+        cv.notify_one();
+        return future;
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t;
+};
+
+#endif //RPY_PROJ_ANALYZER_THREADPOOL_HPP
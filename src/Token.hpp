@@ -11,6 +11,8 @@
 #include <utility>
 #include <variant>
 
+#include "Log.hpp"
+
 enum class OpType : std::uint8_t {
     Not,
     Plus,
@@ -439,7 +441,7 @@ inline auto op_str(const OpType &type) -> std::string {
         case RParen:
             return ")";
         default:
-            std::println(std::cerr, "Invalid operator in token");
+            Log::error("Invalid operator in token");
             std::unreachable();
     }
 }
@@ -508,8 +510,7 @@ struct std::formatter<Token> {
         }
         if (w_colors) {
             // this will return the color formatted for raylib text drawing
-            const auto color = tok_color(token);
-            out_str = std::format("{{color=#{:06X}}}{}{{/color}}", color, out_str);
+            return std::format_to(ctx.out(), "{{color=#{:06X}}}{}{{/color}}", tok_color(token), out_str);
         }
         return std::format_to(ctx.out(), "{}", out_str);
     }
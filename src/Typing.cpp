@@ -61,7 +61,7 @@ auto Typing::deduce_type(const std::unique_ptr<Expr>& expr) -> std::optional<Typ
         }
     }
     if (const auto *call = dynamic_cast<ExprCall*>(expr.get())) {
-        std::println("fn call");
+        Log::info("fn call");
         std::vector<Type> types;
         types.reserve(call->args.size() + call->kwargs.size());
         for (const auto &arg : call->args) {
@@ -76,7 +76,7 @@ auto Typing::deduce_type(const std::unique_ptr<Expr>& expr) -> std::optional<Typ
         }
     }
     if (const auto *tuple = dynamic_cast<ExprTuple*>(expr.get())) {
-        std::println("tuple");
+        Log::info("tuple");
         std::vector<Type> types;
         types.reserve(tuple->elems.size());
         for (const auto &elem : tuple->elems) {
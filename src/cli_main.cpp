@@ -0,0 +1,23 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+// rpy_analyze: --no-gui, --graph and --lsp without raylib, for CI, editors and containers with no display
+
+#include <print>
+
+#include "ArgVParser.hpp"
+#include "Cli.hpp"
+
+auto main(const int argc, char** argv) -> int {
+    if (!ArgVParser::parse(argc, argv)) {
+        return 1;
+    }
+
+    if (ArgVParser::help()) {
+        std::println("{}", ArgVParser::get_help_msg());
+        return 0;
+    }
+
+    return Cli::run();
+}
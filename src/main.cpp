@@ -2,6 +2,7 @@
 
 #include "App.hpp"
 #include "ArgVParser.hpp"
+#include "Cli.hpp"
 
 auto main(const int argc, char** argv) -> int {
     if (!ArgVParser::parse(argc, argv)) {
@@ -13,8 +14,20 @@ auto main(const int argc, char** argv) -> int {
         return 0;
     }
 
+    if (ArgVParser::lsp()) {
+        return Cli::run_lsp();
+    }
+
+    if (ArgVParser::export_out) {
+        return App::run_export();
+    }
+
+    if (ArgVParser::graph_out) {
+        return App::run_graph_export();
+    }
+
     if (ArgVParser::no_gui()) {
-        return App::run_no_gui();
+        return Cli::run_batch();
     }
 
     return App::run();
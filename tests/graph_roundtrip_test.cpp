@@ -0,0 +1,168 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+/*
+ * Checks that a script written to a graph file comes back as the same graph.
+ *
+ * The script is parsed, stored in a parse cache of its own and rebuilt with
+ * ParseCache::load. The rebuilt graph has to print the same nodes as the fresh
+ * one (so every token survived the string pool and payloads), and have the
+ * same links and layout, which load only gets from the node and layout tables.
+ * The entry is then read with GraphFile alone, the way other programs would,
+ * and every jump edge has to lead from a jump or call to the line of the label
+ * the script names.
+ *
+ * usage: ./rpy_graph_roundtrip_test <script.rpy> <work dir>
+ */
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GraphFile.hpp"
+#include "Log.hpp"
+#include "ParseCache.hpp"
+
+namespace {
+    int failures = 0;
+
+    void check(const bool ok, const std::string_view what) {
+        if (!ok) {
+            std::println(std::cerr, "FAILED: {}", what);
+            ++failures;
+        }
+    }
+
+    /**
+     * @brief what Graph::print_all_nodes prints for `graph`.
+     */
+    auto printed(const Graph &graph) -> std::vector<std::string> {
+        std::vector<std::string> lines;
+        for (const auto &node : graph.get_nodes()) {
+            lines.push_back(std::format("{}", *node));
+        }
+        return lines;
+    }
+
+    void check_links(const Graph &parsed, const Graph &loaded) {
+        const auto &a = parsed.get_nodes();
+        const auto &b = loaded.get_nodes();
+        for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) {
+            const auto what = [&](const std::string_view field) -> std::string {
+                return std::format("node {} has the same {} after loading", i, field);
+            };
+            check(a[i]->parent == b[i]->parent, what("parent"));
+            check(a[i]->next == b[i]->next, what("next"));
+            check(a[i]->prev == b[i]->prev, what("prev"));
+            check(a[i]->path_flags == b[i]->path_flags, what("path flags"));
+
+            const auto *pa = dynamic_cast<const NodeParent*>(a[i].get());
+            const auto *pb = dynamic_cast<const NodeParent*>(b[i].get());
+            check((pa == nullptr) == (pb == nullptr), what("kind"));
+            if (pa != nullptr && pb != nullptr) {
+                check(pa->first_child == pb->first_child, what("first child"));
+                check(pa->after_block == pb->after_block, what("block end"));
+            }
+        }
+    }
+
+    void check_layout(const RenpyFile &parsed, const RenpyFile &loaded) {
+        const auto a = parsed.layout.snapshot();
+        const auto b = loaded.layout.snapshot();
+        check(a.size() == b.size(), "the layout has as many groups after loading");
+        for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) {
+            check(a[i].width == b[i].width && a[i].height == b[i].height && a[i].shape == b[i].shape
+                && a[i].n_elems == b[i].n_elems, std::format("layout group {} is the same after loading", i));
+        }
+    }
+
+    /**
+     * @brief reads the cache entry without the parser and follows its jump edges back into the script.
+     */
+    void check_jumps(const std::filesystem::path &entry_path, const std::vector<std::string> &script_lines) {
+        const auto entry = GraphFile::open(entry_path);
+        check(entry.has_value(), "the cache entry opens with GraphFile");
+        if (!entry) {
+            return;
+        }
+
+        const auto nodes = entry->nodes();
+        unsigned jumps = 0;
+        for (const auto &edge : entry->edges()) {
+            if (edge.type != static_cast<std::uint32_t>(GraphFile::EdgeType::Jump)) {
+                continue;
+            }
+            ++jumps;
+            if (edge.from >= nodes.size() || edge.to >= nodes.size()) {
+                check(false, "jump edges point at nodes in the table");
+                continue;
+            }
+
+            const auto &from = nodes[edge.from];
+            const auto &to = nodes[edge.to];
+            const auto from_kind = GraphFile::kind_name(from.kind);
+            check(from_kind == "jump" || from_kind == "call", std::format("jump edge {} starts at a jump or call", jumps));
+            check(GraphFile::kind_name(to.kind) == "label", std::format("jump edge {} ends at a label", jumps));
+
+            const auto target = entry->str(from.target).value_or("");
+            const bool on_label_line = to.line >= 1 && to.line <= script_lines.size()
+                && script_lines[to.line - 1].starts_with(std::format("label {}:", target));
+            check(on_label_line, std::format("jump edge to \"{}\" ends on that label's line", target));
+        }
+        // `call ending` and `jump start`
+        check(jumps == 2, std::format("both jumps in the script have an edge, found {}", jumps));
+    }
+}
+
+auto main(const int argc, char **argv) -> int {
+    if (argc != 3 || !std::filesystem::is_regular_file(argv[1])) {
+        std::println(std::cerr, "usage: {} <script.rpy> <work dir>", argv[0]);
+        return 1;
+    }
+    const std::filesystem::path script = argv[1];
+    const std::filesystem::path work_dir = argv[2];
+
+    Log::set_quiet(true);
+
+    // a cache of its own, so an entry left over from an older build can't stand in for the parse
+    std::filesystem::remove_all(work_dir);
+    ParseCache::set_cache_dir(work_dir / "cache");
+
+    const auto stamp = FileStamp::of(script);
+    const RenpyFile parsed(Graph{script});
+    check(parsed.graph.get_errors().empty(), "the script parses without errors");
+
+    const auto stored = ParseCache::store(script, stamp, parsed);
+    check(stored.has_value(), stored ? "" : stored.error());
+
+    const auto loaded = ParseCache::load(script);
+    check(loaded.has_value(), loaded ? "" : std::format("the stored entry loads: {}", loaded.error()));
+    if (!loaded) {
+        return 1;
+    }
+
+    const auto &graph = loaded->file->graph;
+    check(printed(parsed.graph) == printed(graph), "the loaded graph prints the same nodes as a fresh parse");
+    check_links(parsed.graph, graph);
+    check_layout(parsed, *loaded->file);
+
+    std::vector<std::string> script_lines;
+    std::ifstream in(script);
+    for (std::string line; std::getline(in, line);) {
+        script_lines.push_back(std::move(line));
+    }
+    check_jumps(ParseCache::entry_path(script), script_lines);
+
+    std::filesystem::remove_all(work_dir);
+    if (failures > 0) {
+        std::println(std::cerr, "{} checks failed", failures);
+        return 1;
+    }
+    return 0;
+}
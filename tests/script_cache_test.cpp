@@ -0,0 +1,76 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+/*
+ * Checks that ScriptCache::insert hands back a live entry for the script it
+ * was given, even when that script alone is over the memory budget, and when
+ * it replaces the pinned script on screen.
+ *
+ * usage: ./rpy_script_cache_test
+ */
+
+#include <iostream>
+#include <memory>
+#include <print>
+#include <string>
+#include <string_view>
+
+#include "Lexer.hpp"
+#include "Log.hpp"
+#include "ScriptCache.hpp"
+
+namespace {
+    constexpr std::string_view script = R"(label start:
+    "Hello."
+    menu:
+        "Stay.":
+            jump start
+        "Leave.":
+            return
+)";
+
+    int failures = 0;
+
+    void check(const bool ok, const std::string_view what) {
+        if (!ok) {
+            std::println(std::cerr, "FAILED: {}", what);
+            ++failures;
+        }
+    }
+
+    auto result_for(const std::filesystem::path &path) -> ScriptLoader::Result {
+        auto lexer = Lexer::from_source(std::string(script));
+        return {
+            .path=path,
+            .stamp={},
+            .file=std::make_unique<RenpyFile>(Graph(std::move(lexer.get_tokens()))),
+            .data={},
+        };
+    }
+}
+
+auto main() -> int {
+    Log::set_quiet(true);
+
+    // a budget every entry is over on its own
+    ScriptCache cache(1);
+
+    const auto *a = cache.insert(result_for("a.rpy"));
+    check(a != nullptr && a->path == "a.rpy", "an oversized entry is returned by insert");
+    check(cache.peek("a.rpy") == a, "an oversized entry stays cached until something else is added");
+    cache.pin(a);
+
+    const auto *b = cache.insert(result_for("b.rpy"));
+    check(b != nullptr && b->path == "b.rpy", "insert returns the entry it added, not whatever is at the front");
+    check(cache.peek("a.rpy") == a, "the pinned entry isn't evicted");
+
+    // refreshing the script on screen unpins it before replacing it
+    const auto *a2 = cache.insert(result_for("a.rpy"));
+    check(a2 != nullptr && a2->path == "a.rpy", "replacing the pinned entry returns the new one");
+    check(cache.peek("a.rpy") == a2, "the replacement is the cached entry");
+    check(!cache.contains("b.rpy"), "the older entry is evicted instead");
+    check(cache.get_stats().entries == 1, "only the replacement is left");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+//
+// Created by Noah Schonhorn on 10/19/26.
+//
+
+/*
+ * Prints a graph file (a parse cache entry, or `--graph file.rpyg`) using only
+ * the reader library, the way another program would read one.
+ *
+ * By default every node is printed as Graph::print_all_nodes prints it, so the
+ * output can be diffed against a fresh parse of the script. That needs the node
+ * text, which only `--graph file.rpyg` writes. `--records` prints the node and
+ * edge tables instead, which every graph file has.
+ *
+ * usage: ./rpy_graph_dump <file.rpyg> [--records]
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <print>
+#include <string>
+#include <string_view>
+
+#include "GraphFile.hpp"
+
+namespace {
+    auto idx_str(const std::uint32_t idx) -> std::string {
+        return idx == GraphFile::NO_IDX ? "-" : std::to_string(idx);
+    }
+
+    auto print_nodes(const GraphFile &file) -> bool {
+        if ((file.header().flags & GraphFile::NODE_TEXT) == 0) {
+            std::println(std::cerr, "this file has no node text (parse cache entries leave it out), try --records");
+            return false;
+        }
+        for (const auto &node : file.nodes()) {
+            std::println("{}", file.str(node.text).value_or("<bad string>"));
+        }
+        return true;
+    }
+
+    void print_records(const GraphFile &file) {
+        const auto &hdr = file.header();
+        std::println("version {}, {} tokens, {} nodes, {} edges, {} bytes of strings, script is {} bytes with hash {:016x}",
+            hdr.version, hdr.n_tokens, hdr.n_nodes, hdr.n_edges, hdr.strings_size, hdr.size, hdr.hash);
+
+        std::println("\nidx\tline:col\tkind\tlabel\tparent\tnext\tchild\twords\ttarget");
+        const auto nodes = file.nodes();
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            const auto &node = nodes[i];
+            std::println("{}\t{}:{}\t{}\t{}\t{}\t{}\t{}\t{}\t{}", i, node.line, node.col, GraphFile::kind_name(node.kind),
+                idx_str(node.label), idx_str(node.parent), idx_str(node.next), idx_str(node.first_child),
+                node.words, file.str(node.target).value_or("<bad string>"));
+        }
+
+        std::println("\nfrom\tto\ttype");
+        for (const auto &edge : file.edges()) {
+            std::println("{}\t{}\t{}", edge.from, edge.to, GraphFile::edge_name(edge.type));
+        }
+    }
+}
+
+auto main(const int argc, char** argv) -> int {
+    if (argc < 2) {
+        std::println(std::cerr, "usage: {} <file.rpyg> [--records]", argv[0]);
+        return 1;
+    }
+
+    const auto file = GraphFile::open(argv[1]);
+    if (!file) {
+        std::println(std::cerr, "{}: {}", argv[1], file.error());
+        return 1;
+    }
+
+    if (argc > 2 && std::string_view(argv[2]) == "--records") {
+        print_records(*file);
+        return 0;
+    }
+    return print_nodes(*file) ? 0 : 1;
+}